@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-alloc.c: eba_alloc compared with a linear scan for a free bit */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* the simple way: test each bit until a clear one is found */
+static size_t linear_alloc(struct eba *eba, size_t slots)
+{
+	size_t i;
+
+	for (i = 0; i < slots; ++i) {
+		if (!eba_get(eba, i)) {
+			eba_set(eba, i, 1);
+			return i;
+		}
+	}
+	return slots;
+}
+
+/* a nearly full pool, where each allocation follows a random release */
+int main(int argc, char **argv)
+{
+	size_t slots, ops, i, slot, sum;
+	struct eba *eba;
+	struct eba_alloc *alloc;
+	struct eba_alloc_cache cache;
+	clock_t start;
+	double secs;
+
+	slots = argc > 1 ? strtoul(argv[1], NULL, 10) : (1UL << 16);
+	ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+	if (!slots) {
+		fprintf(stderr, "slots must be greater than zero\n");
+		return 1;
+	}
+
+	eba = eba_new(slots);
+	alloc = eba_alloc_new(slots);
+	if (!eba || !alloc) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	printf("%lu slots, %lu release and allocate pairs\n",
+	       (unsigned long)slots, (unsigned long)ops);
+
+	eba_set_all(eba, 1);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		eba_set(eba, (size_t)(bench_rand() % slots), 0);
+		sum += linear_alloc(eba, slots);
+	}
+	secs = bench_seconds(start);
+	printf("linear eba_get scan: %8.3f seconds (%lu)\n", secs,
+	       (unsigned long)sum);
+
+	for (i = 0; i < slots; ++i) {
+		eba_alloc_slot(alloc, &slot);
+	}
+	bench_rand_seed(1);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		eba_alloc_release(alloc, (size_t)(bench_rand() % slots));
+		eba_alloc_slot(alloc, &slot);
+		sum += slot;
+	}
+	secs = bench_seconds(start);
+	printf("eba_alloc_slot:      %8.3f seconds (%lu)\n", secs,
+	       (unsigned long)sum);
+
+	/* a thread's cache, reusing its own recent releases */
+	eba_alloc_release_slots(alloc, 0, slots);
+	eba_alloc_cache_init(&cache, alloc, NULL, NULL, NULL);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		if (eba_alloc_cache_slot(&cache, &slot)) {
+			break;
+		}
+		if (bench_rand() % 2) {
+			eba_alloc_cache_release(&cache, slot);
+		}
+		sum += slot;
+	}
+	secs = bench_seconds(start);
+	printf("eba_alloc_cache:     %8.3f seconds (%lu)\n", secs,
+	       (unsigned long)sum);
+	eba_alloc_cache_flush(&cache);
+
+	eba_alloc_free(alloc);
+	eba_free(eba);
+	return 0;
+}
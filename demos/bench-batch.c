@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-batch.c: eba_test_batch compared with a loop of eba_get */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* random probes of an array much larger than the last level cache */
+int main(int argc, char **argv)
+{
+	unsigned long mib, num_bits, *idx, sum;
+	unsigned char *out;
+	struct eba *eba;
+	size_t n, i;
+	clock_t start;
+	double secs, batch_secs;
+
+	mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+	n = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000000;
+	num_bits = mib * 1024UL * 1024UL * 8UL;
+	printf("%lu random probes of a %lu MiB array\n", (unsigned long)n,
+	       mib);
+
+	eba = eba_new_endian(num_bits, eba_endian_little);
+	idx = (unsigned long *)malloc(n * sizeof(unsigned long));
+	out = (unsigned char *)malloc(n);
+	if (!eba || !idx || !out) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < num_bits; i += 7) {
+		eba_set(eba, i, 1);
+	}
+	for (i = 0; i < n; ++i) {
+		idx[i] = bench_rand_wide() % num_bits;
+	}
+
+	sum = 0;
+	start = clock();
+	for (i = 0; i < n; ++i) {
+		out[i] = eba_get(eba, idx[i]);
+		sum += out[i];
+	}
+	secs = bench_seconds(start);
+	printf("eba_get loop:       %8.3f seconds (%lu)\n", secs, sum);
+
+	start = clock();
+	sum = eba_test_batch(eba, idx, n, out);
+	batch_secs = bench_seconds(start);
+	printf("eba_test_batch:     %8.3f seconds (%lu), %.1fx\n",
+	       batch_secs, sum, (batch_secs > 0) ? (secs / batch_secs) : 0.0);
+
+	start = clock();
+	sum = eba_filter_indices(eba, idx, n, idx);
+	batch_secs = bench_seconds(start);
+	printf("eba_filter_indices: %8.3f seconds (%lu), %.1fx\n",
+	       batch_secs, sum, (batch_secs > 0) ? (secs / batch_secs) : 0.0);
+
+	free(out);
+	free(idx);
+	eba_free(eba);
+	return 0;
+}
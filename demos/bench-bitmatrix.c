@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-bitmatrix.c: transposing a bit matrix, bit by bit and by blocks */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* the naive transpose: one eba_bitmatrix_get and set per bit */
+static void bench_transpose_bits(struct eba_bitmatrix *t,
+				 struct eba_bitmatrix *m)
+{
+	size_t r, c;
+
+	for (r = 0; r < m->rows; ++r) {
+		for (c = 0; c < m->cols; ++c) {
+			eba_bitmatrix_set(t, c, r, eba_bitmatrix_get(m, r, c));
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *names[] = { "portable", "sse2", "avx2", "avx512" };
+	struct eba_bitmatrix *m, *t;
+	size_t n, reps, i, level;
+	enum eba_isa isa;
+	clock_t start;
+	double secs;
+
+	n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+	reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+	printf("%lu transposes of a %lu by %lu bit matrix\n",
+	       (unsigned long)reps, (unsigned long)n, (unsigned long)n);
+
+	m = eba_bitmatrix_new(n, n);
+	t = eba_bitmatrix_new(n, n);
+	if (!m || !t) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < m->eba.size_bytes; ++i) {
+		m->eba.bits[i] = (unsigned char)bench_rand();
+	}
+
+	start = clock();
+	for (i = 0; i < reps; ++i) {
+		bench_transpose_bits(t, m);
+	}
+	secs = bench_seconds(start);
+	printf("%-10s %8.3f seconds (%lu)\n", "bit by bit", secs,
+	       eba_bitmatrix_row_popcount(t, 0));
+
+	for (level = 0; level < 4; ++level) {
+		isa = eba_isa_force((enum eba_isa)level);
+		if ((size_t)isa != level) {
+			printf("%-10s not supported\n", names[level]);
+			continue;
+		}
+		start = clock();
+		for (i = 0; i < reps; ++i) {
+			eba_bitmatrix_transpose(t, m);
+		}
+		secs = bench_seconds(start);
+		printf("%-10s %8.3f seconds (%lu)\n", names[level], secs,
+		       eba_bitmatrix_row_popcount(t, 0));
+	}
+
+	eba_bitmatrix_free(m);
+	eba_bitmatrix_free(t);
+	return 0;
+}
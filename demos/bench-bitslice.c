@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-bitslice.c: range predicates, per value and on bit planes */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* selects the 12-bit values from 1000 to 2000, into a bitmap */
+int main(int argc, char **argv)
+{
+	struct eba_bitmatrix *planes, *results;
+	unsigned long *values, found;
+	size_t n, reps, i, r;
+	struct eba out;
+	clock_t start;
+	double secs;
+
+	n = argc > 1 ? strtoul(argv[1], NULL, 10) : (1024 * 1024);
+	reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 50;
+	printf("%lu range selections of %lu 12-bit values\n",
+	       (unsigned long)reps, (unsigned long)n);
+
+	planes = eba_bitmatrix_new(12, n);
+	results = eba_bitmatrix_new(1, n);
+	values = (unsigned long *)malloc(n * sizeof(unsigned long));
+	if (!planes || !results || !values) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < n; ++i) {
+		values[i] = bench_rand() & 0xFFF;
+	}
+	eba_bitmatrix_row(results, 0, &out);
+
+	start = clock();
+	for (r = 0; r < reps; ++r) {
+		for (i = 0; i < n; ++i) {
+			eba_set(&out, i,
+				(values[i] >= 1000) && (values[i] <= 2000));
+		}
+	}
+	secs = bench_seconds(start);
+	found = eba_bitmatrix_row_popcount(results, 0);
+	printf("%-10s %8.3f seconds (%lu)\n", "per value", secs, found);
+
+	start = clock();
+	eba_bitslice_pack(planes, values, n);
+	secs = bench_seconds(start);
+	printf("%-10s %8.3f seconds, once\n", "pack", secs);
+
+	start = clock();
+	for (r = 0; r < reps; ++r) {
+		eba_bitslice_between(&out, planes, 1000, 2000);
+	}
+	secs = bench_seconds(start);
+	found = eba_bitmatrix_row_popcount(results, 0);
+	printf("%-10s %8.3f seconds (%lu)\n", "bitslice", secs, found);
+
+	eba_bitmatrix_free(planes);
+	eba_bitmatrix_free(results);
+	free(values);
+	return 0;
+}
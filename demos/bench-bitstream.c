@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-bitstream.c: Elias gamma codes, per bit eba_set versus bitwriter */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+static void report(const char *name, double secs, unsigned long bits,
+		   unsigned long sum)
+{
+	double mbytes = ((double)bits) / (8.0 * 1024.0 * 1024.0);
+
+	printf("%-24s %8.3f seconds %10.1f MiB/s (%lu)\n", name, secs,
+	       secs > 0.0 ? mbytes / secs : 0.0, sum);
+}
+
+/* the simple way, a bit at a time */
+static unsigned long slow_put_gamma(struct eba *eba, unsigned long pos,
+				    unsigned long x)
+{
+	unsigned n = 0, i;
+
+	while ((x >> n) > 1) {
+		++n;
+	}
+	for (i = 0; i < n; ++i) {
+		eba_set(eba, pos++, 0);
+	}
+	eba_set(eba, pos++, 1);
+	for (i = 0; i < n; ++i) {
+		eba_set(eba, pos++, (x >> i) & 1);
+	}
+	return pos;
+}
+
+static unsigned long slow_get_gamma(struct eba *eba, unsigned long *pos)
+{
+	unsigned n = 0, i;
+	unsigned long x;
+
+	while (!eba_get(eba, (*pos)++)) {
+		++n;
+	}
+	x = 1UL << n;
+	for (i = 0; i < n; ++i) {
+		x |= ((unsigned long)eba_get(eba, (*pos)++)) << i;
+	}
+	return x;
+}
+
+int main(int argc, char **argv)
+{
+	size_t codes, i;
+	unsigned long *vals, pos, bits, sum, x;
+	struct eba *eba;
+	struct eba_bitwriter writer;
+	struct eba_bitreader reader;
+	clock_t start;
+
+	codes = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+
+	vals = (unsigned long *)malloc(codes * sizeof(unsigned long));
+	/* gamma codes of 24 bit values are at most 47 bits */
+	eba = eba_new(codes * 48);
+	if (!vals || !eba) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < codes; ++i) {
+		/* mostly small values, as gamma codes are meant for */
+		vals[i] = 1 + (bench_rand() >> (bench_rand() % 24));
+	}
+	printf("%lu Elias gamma codes\n", (unsigned long)codes);
+
+	start = clock();
+	pos = 0;
+	for (i = 0; i < codes; ++i) {
+		pos = slow_put_gamma(eba, pos, vals[i]);
+	}
+	bits = pos;
+	report("eba_set per bit write", bench_seconds(start), bits, pos);
+
+	start = clock();
+	pos = 0;
+	sum = 0;
+	for (i = 0; i < codes; ++i) {
+		sum += slow_get_gamma(eba, &pos);
+	}
+	report("eba_get per bit read", bench_seconds(start), bits, sum);
+
+	start = clock();
+	eba_bitwriter_init(&writer, eba, 0);
+	for (i = 0; i < codes; ++i) {
+		eba_bitwriter_put_gamma(&writer, vals[i]);
+	}
+	eba_bitwriter_flush(&writer);
+	report("eba_bitwriter", bench_seconds(start), bits,
+	       eba_bitwriter_position(&writer));
+
+	start = clock();
+	eba_bitreader_init(&reader, eba, 0);
+	sum = 0;
+	for (i = 0; i < codes; ++i) {
+		eba_bitreader_get_gamma(&reader, &x);
+		sum += x;
+	}
+	report("eba_bitreader", bench_seconds(start), bits, sum);
+
+	eba_free(eba);
+	free(vals);
+	return 0;
+}
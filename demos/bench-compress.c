@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-compress.c: gathering the values selected by a bitmap */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* eba_compress_ui against testing each bit, at several densities */
+int main(int argc, char **argv)
+{
+	unsigned densities[] = { 1, 10, 50, 90 };
+	unsigned int *src, *dst;
+	struct eba *mask;
+	size_t n, reps, i, r, d, count;
+	enum eba_isa isa;
+	clock_t start;
+	double secs;
+
+	n = argc > 1 ? strtoul(argv[1], NULL, 10) : (1024 * 1024);
+	reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 100;
+	printf("%lu compresses of %lu values\n", (unsigned long)reps,
+	       (unsigned long)n);
+
+	mask = eba_new_endian(n, eba_endian_little);
+	src = (unsigned int *)malloc(n * sizeof(unsigned int));
+	dst = (unsigned int *)malloc(n * sizeof(unsigned int));
+	if (!mask || !src || !dst) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < n; ++i) {
+		src[i] = (unsigned int)i;
+	}
+
+	for (d = 0; d < 4; ++d) {
+		for (i = 0; i < n; ++i) {
+			eba_set(mask, i, (bench_rand() % 100) < densities[d]);
+		}
+		printf("%u%% selected\n", densities[d]);
+		count = 0;
+
+		start = clock();
+		for (r = 0; r < reps; ++r) {
+			count = 0;
+			for (i = 0; i < n; ++i) {
+				if (eba_get(mask, i)) {
+					dst[count++] = src[i];
+				}
+			}
+		}
+		secs = bench_seconds(start);
+		printf("  %-10s %8.3f seconds (%lu)\n", "per bit", secs,
+		       (unsigned long)count);
+
+		isa = eba_isa_force(eba_isa_portable);
+		start = clock();
+		for (r = 0; r < reps; ++r) {
+			count = eba_compress_ui(mask, n, src, dst);
+		}
+		secs = bench_seconds(start);
+		printf("  %-10s %8.3f seconds (%lu)\n", "portable", secs,
+		       (unsigned long)count);
+
+		isa = eba_isa_force(eba_isa_avx512);
+		if (isa != eba_isa_avx512) {
+			printf("  %-10s not supported\n", "avx512");
+			continue;
+		}
+		start = clock();
+		for (r = 0; r < reps; ++r) {
+			count = eba_compress_ui(mask, n, src, dst);
+		}
+		secs = bench_seconds(start);
+		printf("  %-10s %8.3f seconds (%lu)\n", "avx512", secs,
+		       (unsigned long)count);
+	}
+
+	eba_free(mask);
+	free(src);
+	free(dst);
+	return 0;
+}
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-hugepages.c: random access with and without huge pages */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "../src/eba-posix.h"
+#include "bench-utils.h"
+
+static int bench(unsigned long num_bits, size_t ops, unsigned flags,
+		 const char *name)
+{
+	struct eba *eba;
+	unsigned long sum, index;
+	clock_t start;
+	double secs;
+	size_t i;
+
+	eba = eba_new_mapped(num_bits, eba_endian_little, flags);
+	if (!eba) {
+		fprintf(stderr, "could not map %lu bits\n", num_bits);
+		return 1;
+	}
+	/* fault in every page before timing */
+	eba_set_all(eba, 0);
+
+	bench_rand_seed(1);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		index = bench_rand_wide() % num_bits;
+		sum += eba_get(eba, index);
+		eba_set(eba, index ^ 1, 1);
+	}
+	secs = bench_seconds(start);
+	printf("%-24s %8.3f seconds, %6.1f M ops/s (%lu)%s\n", name, secs,
+	       (secs > 0) ? (ops / secs / 1e6) : 0.0, sum,
+	       (eba_mapped_flags(eba) == flags) ? "" : " (not granted)");
+	eba_free_mapped(eba);
+	return 0;
+}
+
+/* random eba_get and eba_set on one large array */
+int main(int argc, char **argv)
+{
+	unsigned long mib, num_bits;
+	size_t ops;
+
+	mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+	ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000000;
+	num_bits = mib * 1024UL * 1024UL * 8UL;
+	printf("%lu random get and set pairs on a %lu MiB array\n",
+	       (unsigned long)ops, mib);
+
+	if (bench(num_bits, ops, 0, "4k pages:")) {
+		return 1;
+	}
+	if (bench(num_bits, ops, EBA_MAP_THP, "transparent huge pages:")) {
+		return 1;
+	}
+	if (bench(num_bits, ops, EBA_MAP_HUGETLB, "MAP_HUGETLB:")) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-indices.c: converting between bitmaps and lists of indexes */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* eba_to_indices and eba_from_indices against eba_get and eba_set,
+ * at several densities, in both endians */
+int main(int argc, char **argv)
+{
+	unsigned permille[] = { 1, 10, 100, 500, 900 };
+	enum eba_endian endians[] = { eba_endian_little, eba_big_endian };
+	const char *names[] = { "little", "big" };
+	unsigned long *idx;
+	struct eba *eba;
+	size_t num_bits, reps, i, r, d, e, count;
+	clock_t start;
+	double secs;
+
+	num_bits = argc > 1 ? strtoul(argv[1], NULL, 10) : (1024 * 1024);
+	reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 50;
+	printf("%lu conversions of %lu bits\n", (unsigned long)reps,
+	       (unsigned long)num_bits);
+
+	idx = (unsigned long *)malloc(num_bits * sizeof(unsigned long));
+	if (!idx) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (e = 0; e < 2; ++e) {
+		eba = eba_new_endian(num_bits, endians[e]);
+		if (!eba) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+		for (d = 0; d < 5; ++d) {
+			for (i = 0; i < num_bits; ++i) {
+				eba_set(eba, i,
+					(bench_rand() % 1000) < permille[d]);
+			}
+			printf("%s endian, %.1f%% set\n", names[e],
+			       permille[d] / 10.0);
+
+			count = 0;
+			start = clock();
+			for (r = 0; r < reps; ++r) {
+				count = 0;
+				for (i = 0; i < num_bits; ++i) {
+					if (eba_get(eba, i)) {
+						idx[count++] = i;
+					}
+				}
+			}
+			secs = bench_seconds(start);
+			printf("  %-16s %8.3f seconds (%lu)\n", "eba_get loop",
+			       secs, (unsigned long)count);
+
+			start = clock();
+			for (r = 0; r < reps; ++r) {
+				count = eba_to_indices(eba, idx, num_bits);
+			}
+			secs = bench_seconds(start);
+			printf("  %-16s %8.3f seconds (%lu)\n",
+			       "eba_to_indices", secs, (unsigned long)count);
+
+			start = clock();
+			for (r = 0; r < reps; ++r) {
+				eba_set_all(eba, 0);
+				for (i = 0; i < count; ++i) {
+					eba_set(eba, idx[i], 1);
+				}
+			}
+			secs = bench_seconds(start);
+			printf("  %-16s %8.3f seconds\n", "eba_set loop", secs);
+
+			start = clock();
+			for (r = 0; r < reps; ++r) {
+				eba_from_indices(eba, idx, count);
+			}
+			secs = bench_seconds(start);
+			printf("  %-16s %8.3f seconds\n", "eba_from_indices",
+			       secs);
+		}
+		eba_free(eba);
+	}
+
+	free(idx);
+	return 0;
+}
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-isa.c: the bulk count kernels at each instruction set level */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+/* eba_hamming_distance and eba_count_and_or of two cache sized arrays */
+int main(int argc, char **argv)
+{
+	const char *names[] = { "portable", "sse2", "avx2", "avx512" };
+	unsigned long num_bits, sum, c_and, c_or;
+	size_t reps, i, level;
+	struct eba *a, *b;
+	enum eba_isa isa;
+	clock_t start;
+	double secs;
+
+	num_bits = 8UL * (argc > 1 ? strtoul(argv[1], NULL, 10) : 65536);
+	reps = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+	printf("%lu hamming distances and and/or counts of %lu bytes\n",
+	       (unsigned long)reps, num_bits / 8);
+
+	a = eba_new_endian(num_bits, eba_endian_little);
+	b = eba_new_endian(num_bits, eba_endian_little);
+	if (!a || !b) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for (i = 0; i < a->size_bytes; ++i) {
+		a->bits[i] = (unsigned char)bench_rand();
+		b->bits[i] = (unsigned char)bench_rand();
+	}
+
+	for (level = 0; level < 4; ++level) {
+		isa = eba_isa_force((enum eba_isa)level);
+		if ((size_t)isa != level) {
+			printf("%-10s not supported\n", names[level]);
+			continue;
+		}
+		sum = 0;
+		start = clock();
+		for (i = 0; i < reps; ++i) {
+			sum += eba_hamming_distance(a, b);
+			eba_count_and_or(a, b, &c_and, &c_or);
+			sum += c_and + c_or;
+		}
+		secs = bench_seconds(start);
+		printf("%-10s %8.3f seconds (%lu)\n", names[level], secs, sum);
+	}
+
+	eba_free(a);
+	eba_free(b);
+	return 0;
+}
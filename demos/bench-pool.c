@@ -0,0 +1,91 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-pool.c: eba_pool compared with eba_new and eba_free */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/eba.h"
+#include "bench-utils.h"
+
+#define LIVE 256
+
+static unsigned long bench_bits(void)
+{
+	/* 64 to 1024 bits */
+	return 64 + (bench_rand() % 961);
+}
+
+/* a rolling window of live arrays, replacing one at each step */
+int main(int argc, char **argv)
+{
+	size_t ops, i, slot;
+	struct eba *live[LIVE];
+	struct eba_pool pool;
+	struct eba_pool_cache cache;
+	unsigned long sum;
+	clock_t start;
+	double secs;
+
+	ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000000;
+	printf("%lu new and free pairs of 64 to 1024 bits, %d live\n",
+	       (unsigned long)ops, LIVE);
+
+	for (i = 0; i < LIVE; ++i) {
+		live[i] = NULL;
+	}
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		slot = i % LIVE;
+		eba_free(live[slot]);
+		live[slot] = eba_new_endian(bench_bits(), eba_endian_little);
+		eba_set(live[slot], 3, 1);
+		sum += live[slot]->size_bytes;
+	}
+	secs = bench_seconds(start);
+	printf("eba_new/eba_free:     %8.3f seconds (%lu)\n", secs, sum);
+	for (i = 0; i < LIVE; ++i) {
+		eba_free(live[i]);
+		live[i] = NULL;
+	}
+
+	bench_rand_seed(1);
+	eba_pool_init(&pool);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		slot = i % LIVE;
+		eba_pool_free(&pool, live[slot]);
+		live[slot] = eba_pool_new(&pool, bench_bits(),
+					  eba_endian_little);
+		eba_set(live[slot], 3, 1);
+		sum += live[slot]->size_bytes;
+	}
+	secs = bench_seconds(start);
+	printf("eba_pool:             %8.3f seconds (%lu)\n", secs, sum);
+	for (i = 0; i < LIVE; ++i) {
+		live[i] = NULL;
+	}
+	eba_pool_reset(&pool);
+
+	bench_rand_seed(1);
+	eba_pool_cache_init(&cache, &pool, NULL, NULL, NULL);
+	sum = 0;
+	start = clock();
+	for (i = 0; i < ops; ++i) {
+		slot = i % LIVE;
+		eba_pool_cache_free(&cache, live[slot]);
+		live[slot] = eba_pool_cache_new(&cache, bench_bits(),
+						eba_endian_little);
+		eba_set(live[slot], 3, 1);
+		sum += live[slot]->size_bytes;
+	}
+	secs = bench_seconds(start);
+	printf("eba_pool_cache:       %8.3f seconds (%lu)\n", secs, sum);
+	eba_pool_cache_flush(&cache);
+
+	eba_pool_destroy(&pool);
+	return 0;
+}
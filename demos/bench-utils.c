@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-utils.c: helpers shared by the demos/bench-*.c programs */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "bench-utils.h"
+
+static unsigned long bench_rand_state = 1;
+
+void bench_rand_seed(unsigned long seed)
+{
+	bench_rand_state = seed;
+}
+
+unsigned long bench_rand(void)
+{
+	bench_rand_state = (bench_rand_state * 1103515245UL) + 12345UL;
+	return (bench_rand_state >> 8) & 0xFFFFFFUL;
+}
+
+unsigned long bench_rand_wide(void)
+{
+	unsigned long high;
+
+	high = bench_rand();
+	return (high << 24) ^ bench_rand();
+}
+
+double bench_seconds(clock_t start)
+{
+	return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
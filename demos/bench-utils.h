@@ -0,0 +1,22 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* bench-utils.h: helpers shared by the demos/bench-*.c programs */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <time.h>
+
+/* a small deterministic pseudo-random sequence, so that runs compare */
+void bench_rand_seed(unsigned long seed);
+
+/* 24 bits */
+unsigned long bench_rand(void);
+
+/* 48 bits, where unsigned long is wide enough */
+unsigned long bench_rand_wide(void);
+
+/* seconds of CPU time since start */
+double bench_seconds(clock_t start);
+
+#endif /* BENCH_UTILS_H */
@@ -19,6 +19,28 @@ unsigned eba_test_shift_right(int verbose);
 unsigned eba_test_swap(int verbose);
 unsigned eba_test_to_string(int verbose);
 unsigned eba_test_toggle(int verbose);
+unsigned eba_test_from_string(int verbose);
+unsigned eba_test_similarity(int verbose);
+unsigned eba_test_matrix(int verbose);
+unsigned eba_test_bloom(int verbose);
+unsigned eba_test_get_set_bits(int verbose);
+unsigned eba_test_counters(int verbose);
+unsigned eba_test_alloc(int verbose);
+unsigned eba_test_sparse(int verbose);
+unsigned eba_test_copy_bits(int verbose);
+unsigned eba_test_bitstream(int verbose);
+unsigned eba_test_aligned(int verbose);
+unsigned eba_test_pool(int verbose);
+unsigned eba_test_cow(int verbose);
+unsigned eba_test_diff(int verbose);
+unsigned eba_test_dirty(int verbose);
+unsigned eba_test_test_batch(int verbose);
+unsigned eba_test_isa(int verbose);
+unsigned eba_test_bitmatrix(int verbose);
+unsigned eba_test_gf2(int verbose);
+unsigned eba_test_bitslice(int verbose);
+unsigned eba_test_compress(int verbose);
+unsigned eba_test_indices(int verbose);
 
 /* globals */
 uint32_t loop_count;
@@ -67,6 +89,28 @@ void loop(void)
 	failures += eba_test_swap(verbose);
 	failures += eba_test_to_string(verbose);
 	failures += eba_test_toggle(verbose);
+	failures += eba_test_from_string(verbose);
+	failures += eba_test_similarity(verbose);
+	failures += eba_test_matrix(verbose);
+	failures += eba_test_bloom(verbose);
+	failures += eba_test_get_set_bits(verbose);
+	failures += eba_test_counters(verbose);
+	failures += eba_test_alloc(verbose);
+	failures += eba_test_sparse(verbose);
+	failures += eba_test_copy_bits(verbose);
+	failures += eba_test_bitstream(verbose);
+	failures += eba_test_aligned(verbose);
+	failures += eba_test_pool(verbose);
+	failures += eba_test_cow(verbose);
+	failures += eba_test_diff(verbose);
+	failures += eba_test_dirty(verbose);
+	failures += eba_test_test_batch(verbose);
+	failures += eba_test_isa(verbose);
+	failures += eba_test_bitmatrix(verbose);
+	failures += eba_test_gf2(verbose);
+	failures += eba_test_bitslice(verbose);
+	failures += eba_test_compress(verbose);
+	failures += eba_test_indices(verbose);
 
 	Serial.println("=================================================");
 	if (failures) {
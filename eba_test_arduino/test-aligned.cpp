@@ -0,0 +1 @@
+../tests/test-aligned.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-alloc.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-bitmatrix.c
\ No newline at end of file
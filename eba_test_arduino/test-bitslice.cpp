@@ -0,0 +1 @@
+../tests/test-bitslice.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-bitstream.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-bloom.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-compress.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-copy-bits.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-counters.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-cow.c
\ No newline at end of file
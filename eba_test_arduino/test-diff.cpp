@@ -0,0 +1 @@
+../tests/test-diff.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-dirty.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-from-string.c
\ No newline at end of file
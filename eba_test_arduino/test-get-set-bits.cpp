@@ -0,0 +1 @@
+../tests/test-get-set-bits.c
\ No newline at end of file
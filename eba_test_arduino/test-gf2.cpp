@@ -0,0 +1 @@
+../tests/test-gf2.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-indices.c
\ No newline at end of file
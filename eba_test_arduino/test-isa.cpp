@@ -0,0 +1 @@
+../tests/test-isa.c
\ No newline at end of file
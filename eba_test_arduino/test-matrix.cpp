@@ -0,0 +1 @@
+../tests/test-matrix.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-pool.c
\ No newline at end of file
@@ -0,0 +1 @@
+../tests/test-similarity.c
\ No newline at end of file
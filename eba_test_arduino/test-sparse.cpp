@@ -0,0 +1 @@
+../tests/test-sparse.c
\ No newline at end of file
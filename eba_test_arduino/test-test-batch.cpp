@@ -0,0 +1 @@
+../tests/test-test-batch.c
\ No newline at end of file
@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* eba-posix.c: bit arrays in POSIX shared memory and mmap */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+/* MAP_ANONYMOUS, madvise */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif
+
+#include "eba-posix.h"
+#include "eembed.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if ((!(defined(MAP_ANONYMOUS))) && (defined(MAP_ANON)))
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define Eba_shm_bits_offset \
+	((sizeof(struct eba_shm_header) + (EBA_ALIGN_BYTES - 1)) \
+	 / EBA_ALIGN_BYTES * EBA_ALIGN_BYTES)
+
+/* The magic is published with a release store, and read with an acquire
+ * load, so that an attach which sees the magic also sees the rest of
+ * the header. Without the atomic builtins, there is no such ordering,
+ * and callers must synchronize create and attach themselves. */
+static void eba_shm_store_magic_(struct eba_shm_header *header)
+{
+#if defined(__ATOMIC_RELEASE)
+	__atomic_store_n(&header->magic, EBA_SHM_MAGIC, __ATOMIC_RELEASE);
+#else
+	header->magic = EBA_SHM_MAGIC;
+#endif
+}
+
+static unsigned long eba_shm_load_magic_(struct eba_shm_header *header)
+{
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+#else
+	return header->magic;
+#endif
+}
+
+static void eba_shm_view_(struct eba_shm *shm, void *map, size_t map_len)
+{
+	shm->header = (struct eba_shm_header *)map;
+	shm->map_len = map_len;
+	shm->eba.bits = ((unsigned char *)map) + shm->header->bits_offset;
+	shm->eba.size_bytes = shm->header->size_bytes;
+	shm->eba.endian = (enum eba_endian)shm->header->endian;
+}
+
+int eba_shm_create(struct eba_shm *shm, const char *name,
+		   unsigned long num_bits, enum eba_endian endian)
+{
+	struct eba_shm_header *header = NULL;
+	size_t size_bytes = 0;
+	size_t map_len = 0;
+	void *map = NULL;
+	int err = 0;
+	int fd = -1;
+
+	eembed_assert(shm);
+	eembed_assert(name);
+
+	size_bytes = (num_bits / CHAR_BIT) + ((num_bits % CHAR_BIT) ? 1 : 0);
+	map_len = Eba_shm_bits_offset + size_bytes;
+
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		return 1;
+	}
+	/* the new length reads as zeros */
+	if (ftruncate(fd, (off_t)map_len)) {
+		err = errno;
+		close(fd);
+		shm_unlink(name);
+		errno = err;
+		return 1;
+	}
+	map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+	if (map == MAP_FAILED) {
+		shm_unlink(name);
+		errno = err;
+		return 1;
+	}
+
+	header = (struct eba_shm_header *)map;
+	header->endian = (unsigned long)endian;
+	header->size_bytes = size_bytes;
+	header->bits_offset = Eba_shm_bits_offset;
+	/* last, so that attach does not see a partial header */
+	eba_shm_store_magic_(header);
+
+	eba_shm_view_(shm, map, map_len);
+	return 0;
+}
+
+int eba_shm_attach(struct eba_shm *shm, const char *name)
+{
+	struct eba_shm_header *header = NULL;
+	struct stat st;
+	size_t map_len = 0;
+	void *map = NULL;
+	int err = 0;
+	int fd = -1;
+
+	eembed_assert(shm);
+	eembed_assert(name);
+
+	fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		return 1;
+	}
+	if (fstat(fd, &st)) {
+		err = errno;
+		close(fd);
+		errno = err;
+		return 1;
+	}
+	map_len = (size_t)st.st_size;
+	if (map_len < sizeof(struct eba_shm_header)) {
+		close(fd);
+		errno = EINVAL;
+		return 1;
+	}
+	map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+	if (map == MAP_FAILED) {
+		errno = err;
+		return 1;
+	}
+
+	header = (struct eba_shm_header *)map;
+	if ((eba_shm_load_magic_(header) != EBA_SHM_MAGIC)
+	    || (header->endian > (unsigned long)eba_big_endian)
+	    || (header->bits_offset > map_len)
+	    || (header->size_bytes > (map_len - header->bits_offset))) {
+		munmap(map, map_len);
+		errno = EINVAL;
+		return 1;
+	}
+
+	eba_shm_view_(shm, map, map_len);
+	return 0;
+}
+
+int eba_shm_detach(struct eba_shm *shm)
+{
+	void *map = NULL;
+
+	eembed_assert(shm);
+
+	map = shm->header;
+	if (!map) {
+		return 0;
+	}
+	shm->header = NULL;
+	shm->eba.bits = NULL;
+	shm->eba.size_bytes = 0;
+	return munmap(map, shm->map_len) ? 1 : 0;
+}
+
+int eba_shm_unlink(const char *name)
+{
+	eembed_assert(name);
+
+	return shm_unlink(name) ? 1 : 0;
+}
+
+/* kept at the start of the mapping, before the struct eba */
+struct eba_mapped_ {
+	size_t map_len;
+	unsigned flags;
+	struct eba eba;
+};
+
+static size_t eba_round_up_(size_t x, size_t multiple)
+{
+	return ((x + (multiple - 1)) / multiple) * multiple;
+}
+
+#if (defined(MAP_HUGETLB))
+static void *eba_map_hugetlb_(size_t map_len)
+{
+	void *map = NULL;
+
+	map = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	return (map == MAP_FAILED) ? NULL : map;
+}
+#endif
+
+/* maps an extra huge page, and trims the ends to align the start */
+static void *eba_map_aligned_(size_t map_len, size_t align)
+{
+	unsigned char *map = NULL;
+	size_t head = 0;
+	size_t tail = 0;
+	void *raw = NULL;
+
+	raw = mmap(NULL, map_len + align, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (raw == MAP_FAILED) {
+		return NULL;
+	}
+	map = (unsigned char *)raw;
+	head = (align - (((size_t)map) % align)) % align;
+	tail = align - head;
+	if (head) {
+		munmap(map, head);
+	}
+	if (tail) {
+		munmap(map + head + map_len, tail);
+	}
+	return map + head;
+}
+
+struct eba *eba_new_mapped(unsigned long num_bits, enum eba_endian endian,
+			   unsigned flags)
+{
+	struct eba_mapped_ *mapped = NULL;
+	size_t bits_offset = 0;
+	size_t size_bytes = 0;
+	size_t map_len = 0;
+	unsigned got = 0;
+	void *map = NULL;
+
+	size_bytes = (num_bits / CHAR_BIT) + ((num_bits % CHAR_BIT) ? 1 : 0);
+	bits_offset = eba_round_up_(sizeof(struct eba_mapped_),
+				    EBA_ALIGN_BYTES);
+	map_len = bits_offset + size_bytes;
+
+#if (defined(MAP_HUGETLB))
+	if (flags & EBA_MAP_HUGETLB) {
+		map_len = eba_round_up_(map_len, EBA_HUGE_PAGE_BYTES);
+		map = eba_map_hugetlb_(map_len);
+		if (map) {
+			got |= EBA_MAP_HUGETLB;
+		}
+	}
+#endif
+	if (!map && (flags & EBA_MAP_THP)) {
+		map_len = eba_round_up_(map_len, EBA_HUGE_PAGE_BYTES);
+		map = eba_map_aligned_(map_len, EBA_HUGE_PAGE_BYTES);
+#if (defined(MADV_HUGEPAGE))
+		if (map && !madvise(map, map_len, MADV_HUGEPAGE)) {
+			got |= EBA_MAP_THP;
+		}
+#endif
+	}
+	if (!map) {
+		map = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map == MAP_FAILED) {
+			return NULL;
+		}
+	}
+
+	/* anonymous mappings read as zeros, the bits need no clearing */
+	mapped = (struct eba_mapped_ *)map;
+	mapped->map_len = map_len;
+	mapped->flags = got;
+	mapped->eba.bits = ((unsigned char *)map) + bits_offset;
+	mapped->eba.size_bytes = size_bytes;
+	mapped->eba.endian = endian;
+	return &mapped->eba;
+}
+
+static struct eba_mapped_ *eba_mapped_(struct eba *eba)
+{
+	unsigned char *bytes = (unsigned char *)eba;
+
+	return (struct eba_mapped_ *)(bytes
+				      - offsetof(struct eba_mapped_, eba));
+}
+
+unsigned eba_mapped_flags(struct eba *eba)
+{
+	eembed_assert(eba);
+
+	return eba_mapped_(eba)->flags;
+}
+
+void eba_free_mapped(struct eba *eba)
+{
+	struct eba_mapped_ *mapped = NULL;
+
+	if (!eba) {
+		return;
+	}
+	mapped = eba_mapped_(eba);
+	munmap(mapped, mapped->map_len);
+}
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* eba-posix.h: bit arrays in POSIX shared memory and mmap */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#ifndef EBA_POSIX_H
+#define EBA_POSIX_H 1
+
+#ifdef __cplusplus
+#define Eba_posix_begin_C_functions extern "C" {
+#define Eba_posix_end_C_functions }
+#else
+#define Eba_posix_begin_C_functions
+#define Eba_posix_end_C_functions
+#endif
+
+/**********************************************************************/
+Eba_posix_begin_C_functions
+#undef Eba_posix_begin_C_functions
+/**********************************************************************/
+#include "eba.h"
+/**********************************************************************/
+/* shared memory */
+/**********************************************************************/
+/* The start of a shared memory object: the fields of a struct eba, but
+ * with the offset of the bits from the start of the object rather than
+ * a pointer, as each process maps the object at a different address. */
+#define EBA_SHM_MAGIC 0x45424131UL	/* "EBA1" */
+
+struct eba_shm_header {
+	unsigned long magic;
+	unsigned long endian;
+	size_t size_bytes;
+	size_t bits_offset;
+};
+
+/* the mapping of a shared array in this process; eba.bits points into
+ * the mapping, and eba may be used with all of the eba functions */
+struct eba_shm {
+	struct eba eba;
+	struct eba_shm_header *header;
+	size_t map_len;
+};
+
+/* Creates a new shared memory object of the name, which must not exist,
+ * and maps it read-write; the bits start cleared. Returns 0 on success,
+ * or non-zero with errno set. */
+int eba_shm_create(struct eba_shm *shm, const char *name,
+		   unsigned long num_bits, enum eba_endian endian);
+
+/* Maps an object made by eba_shm_create, from any process. Returns 0 on
+ * success, or non-zero with errno set; EINVAL if the object is not an
+ * eba (or the creator has not yet finished writing the header).
+ * Where the compiler lacks the GCC __atomic builtins, a header which is
+ * still being written may be seen as complete, thus the caller must
+ * ensure eba_shm_create has returned, e.g.: via a semaphore or pipe. */
+int eba_shm_attach(struct eba_shm *shm, const char *name);
+
+/* unmaps the array in this process, the object remains */
+int eba_shm_detach(struct eba_shm *shm);
+
+/* removes the name; processes which have it mapped keep their mapping */
+int eba_shm_unlink(const char *name);
+
+/* Note: eba_set and the like read and write whole bytes, so processes
+ * writing bits of the same byte at the same time must coordinate. */
+
+/**********************************************************************/
+/* huge pages */
+/**********************************************************************/
+/* For very large arrays, random access is dominated by TLB misses, which
+ * huge pages reduce. These flags request them from eba_new_mapped:
+ *
+ * EBA_MAP_HUGETLB: explicit huge pages (MAP_HUGETLB), which must have
+ * been reserved, e.g.: via /proc/sys/vm/nr_hugepages
+ *
+ * EBA_MAP_THP: transparent huge pages (madvise MADV_HUGEPAGE), with the
+ * mapping aligned to EBA_HUGE_PAGE_BYTES so that all of it qualifies
+ *
+ * Whatever is not available falls back to ordinary pages. */
+#define EBA_MAP_HUGETLB 0x01U
+#define EBA_MAP_THP 0x02U
+
+#ifndef EBA_HUGE_PAGE_BYTES
+#define EBA_HUGE_PAGE_BYTES (2UL * 1024UL * 1024UL)
+#endif
+
+/* An array whose struct and bits are in an anonymous mapping, with the
+ * bits cleared; returns NULL if out of memory. Free with
+ * eba_free_mapped, not eba_free. */
+struct eba *eba_new_mapped(unsigned long num_bits, enum eba_endian endian,
+			   unsigned flags);
+
+/* the flags which eba_new_mapped was able to honor */
+unsigned eba_mapped_flags(struct eba *eba);
+
+void eba_free_mapped(struct eba *eba);
+
+/**********************************************************************/
+Eba_posix_end_C_functions
+#undef Eba_posix_end_C_functions
+#endif /* EBA_POSIX_H */
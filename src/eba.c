@@ -35,6 +35,90 @@
 #define EBA_SKIP_TO_STRING 0
 #endif
 
+#ifndef EBA_SKIP_FROM_STRING
+#define EBA_SKIP_FROM_STRING 0
+#endif
+
+#ifndef EBA_SKIP_SIMILARITY
+#define EBA_SKIP_SIMILARITY 0
+#endif
+
+#ifndef EBA_SKIP_MATRIX
+#define EBA_SKIP_MATRIX 0
+#endif
+
+#ifndef EBA_SKIP_BLOOM
+#define EBA_SKIP_BLOOM 0
+#endif
+
+#ifndef EBA_SKIP_COUNTERS
+#define EBA_SKIP_COUNTERS 0
+#endif
+
+#ifndef EBA_SKIP_ALLOC
+#define EBA_SKIP_ALLOC 0
+#endif
+
+#ifndef EBA_SKIP_SPARSE
+#define EBA_SKIP_SPARSE 0
+#endif
+
+#ifndef EBA_SKIP_COPY_BITS
+#define EBA_SKIP_COPY_BITS 0
+#endif
+
+#ifndef EBA_SKIP_BITSTREAM
+#define EBA_SKIP_BITSTREAM 0
+#endif
+
+#ifndef EBA_SKIP_ALIGNED
+#define EBA_SKIP_ALIGNED 0
+#endif
+
+#ifndef EBA_SKIP_POOL
+#define EBA_SKIP_POOL 0
+#endif
+
+#ifndef EBA_SKIP_COW
+#define EBA_SKIP_COW 0
+#endif
+
+#ifndef EBA_SKIP_DIFF
+#define EBA_SKIP_DIFF 0
+#endif
+
+#ifndef EBA_SKIP_DIRTY
+#define EBA_SKIP_DIRTY 0
+#endif
+
+#ifndef EBA_SKIP_BATCH
+#define EBA_SKIP_BATCH 0
+#endif
+
+#ifndef EBA_SKIP_ISA_DISPATCH
+#define EBA_SKIP_ISA_DISPATCH 0
+#endif
+
+#ifndef EBA_SKIP_BITMATRIX
+#define EBA_SKIP_BITMATRIX 0
+#endif
+
+#ifndef EBA_SKIP_GF2
+#define EBA_SKIP_GF2 0
+#endif
+
+#ifndef EBA_SKIP_BITSLICE
+#define EBA_SKIP_BITSLICE 0
+#endif
+
+#ifndef EBA_SKIP_COMPRESS
+#define EBA_SKIP_COMPRESS 0
+#endif
+
+#ifndef EBA_SKIP_INDICES
+#define EBA_SKIP_INDICES 0
+#endif
+
 #if (EBA_DEBUG)
 static void eba_assert_not_null_(struct eba *eba)
 {
@@ -49,588 +133,6141 @@ static void eba_assert_not_null_(struct eba *eba)
 static void eba_get_byte_and_offset_(struct eba *eba, unsigned long index,
 				     size_t *byte, unsigned char *offset);
 
-unsigned char eba_set_byte_bit(unsigned char byte, unsigned i, unsigned val)
+#if ((!(EBA_SKIP_SHIFTS)) || (!(EBA_SKIP_SIMILARITY)) \
+	|| (!(EBA_SKIP_MATRIX)) || (!(EBA_SKIP_SPARSE)))
+static size_t eba_min_(size_t a, size_t b)
 {
-	eembed_assert(i < CHAR_BIT);
+	return a > b ? b : a;
+}
+#endif
 
-	/* This should work, but seems too tricky: */
-	/* val = val ? 1 : 0; */
-	/* byte ^= (-val ^ byte) & (1U << i); */
-	/* instead, be a bit more verbose and trust the optimizer */
-	if (val) {
-		byte |= (1U << i);
-	} else {
-		byte &= ~(1U << i);
-	}
+/* hint that memory will soon be read, to overlap cache misses */
+#if (defined(__GNUC__))
+#define Eba_prefetch_(addr) __builtin_prefetch(addr)
+#else
+#define Eba_prefetch_(addr) EEMBED_NOP()
+#endif
 
-	return byte;
+#if ((!(EBA_SKIP_BATCH)) || (!(EBA_SKIP_INDICES)))
+/* the byte holding bit index, without the call and checks of eba_get */
+static unsigned char *eba_bit_byte_(struct eba *eba, unsigned long index)
+{
+	size_t byte = index / CHAR_BIT;
 
+	if (eba->endian == eba_big_endian) {
+		byte = (eba->size_bytes - 1) - byte;
+	}
+	return eba->bits + byte;
 }
+#endif
 
-unsigned char eba_get_byte_bit(unsigned char byte, unsigned i)
+/* word at a time helpers, shared by the bulk functions */
+#define Eba_need_counts_ ((!(EBA_SKIP_SIMILARITY)) || (!(EBA_SKIP_MATRIX)) \
+	|| (!(EBA_SKIP_BITMATRIX)))
+#define Eba_need_scans_ ((!(EBA_SKIP_ALLOC)) || (!(EBA_SKIP_SPARSE)))
+#define Eba_need_streams_ ((!(EBA_SKIP_COPY_BITS)) || (!(EBA_SKIP_BITSTREAM)))
+#define Eba_need_gf2_ ((!(EBA_SKIP_GF2)) && (!(EBA_SKIP_BITMATRIX)))
+#define Eba_need_bitslice_ ((!(EBA_SKIP_BITSLICE)) && (!(EBA_SKIP_BITMATRIX)))
+#define Eba_need_bit_words_ ((!(EBA_SKIP_COMPRESS)) || (!(EBA_SKIP_INDICES)))
+#define Eba_need_stores_ ((Eba_need_scans_) || (Eba_need_streams_) \
+	|| (Eba_need_gf2_) || (Eba_need_bitslice_) || (!(EBA_SKIP_INDICES)))
+#define Eba_need_words_ ((Eba_need_counts_) || (Eba_need_stores_) \
+	|| (Eba_need_bit_words_))
+
+/* x86-64 kernels for the bulk counts (and the bit matrix transpose and
+ * the compress and expand), chosen when the library loads */
+#if ((Eba_need_counts_) && (!(EBA_SKIP_ISA_DISPATCH)) && (EEMBED_HOSTED) \
+	&& (defined(__GNUC__)) && (defined(__x86_64__)) \
+	&& (ULONG_MAX > 0xFFFFFFFFUL))
+#define Eba_isa_dispatch_ 1
+#include <immintrin.h>
+#include <stdlib.h>
+#include <string.h>
+#else
+#define Eba_isa_dispatch_ 0
+#endif
+
+#if (Eba_need_words_)
+#if (defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define EBA_LOAD_UL_MEMCPY 1
+#else
+#define EBA_LOAD_UL_MEMCPY 0
+#endif
+
+/* an unaligned load, bytes[0] becomes the lowest byte of the word */
+static unsigned long eba_load_ul_(const unsigned char *bytes)
 {
-	eembed_assert(i < CHAR_BIT);
-	return (byte >> i) & 0x01;
+	unsigned long word = 0;
+#if (EBA_LOAD_UL_MEMCPY)
+	/* inlined as a single load, even when freestanding */
+	__builtin_memcpy(&word, bytes, sizeof(unsigned long));
+#else
+	size_t i = 0;
+
+	for (i = 0; i < sizeof(unsigned long); ++i) {
+		word |= ((unsigned long)bytes[i]) << (CHAR_BIT * i);
+	}
+#endif
+	return word;
 }
 
-void eba_set(struct eba *eba, unsigned long index, unsigned char val)
-{
-	size_t byte = 0;
-	unsigned char offset = 0;
+#define Eba_ul_bytes (sizeof(unsigned long))
+#define Eba_ul_bits (Eba_ul_bytes * CHAR_BIT)
+#endif /* Eba_need_words_ */
 
-	eba_assert_not_null_(eba);
-	eba_get_byte_and_offset_(eba, index, &byte, &offset);
+#if (Eba_need_stores_)
+/* the inverse of eba_load_ul_ */
+static void eba_store_ul_(unsigned char *bytes, unsigned long word)
+{
+#if (EBA_LOAD_UL_MEMCPY)
+	__builtin_memcpy(bytes, &word, sizeof(unsigned long));
+#else
+	size_t i = 0;
 
-	eba->bits[byte] = eba_set_byte_bit(eba->bits[byte], offset, val);
+	for (i = 0; i < sizeof(unsigned long); ++i) {
+		bytes[i] = (unsigned char)(word >> (CHAR_BIT * i));
+	}
+#endif
 }
+#endif /* Eba_need_stores_ */
 
-unsigned char eba_get(struct eba *eba, unsigned long index)
+#if ((Eba_need_streams_) || (Eba_need_bit_words_))
+/* big endian arrays keep the bytes in reverse order */
+static unsigned long eba_reverse_bytes_ul_(unsigned long word)
 {
-	size_t byte = 0;
-	unsigned char offset = 0;
-
-	eba_assert_not_null_(eba);
+#if (defined(__GNUC__) && (ULONG_MAX > 0xFFFFFFFFUL))
+	return (unsigned long)__builtin_bswap64(word);
+#elif (defined(__GNUC__) && (ULONG_MAX == 0xFFFFFFFFUL))
+	return (unsigned long)__builtin_bswap32(word);
+#else
+	unsigned long reversed = 0;
+	size_t i = 0;
 
-	eba_get_byte_and_offset_(eba, index, &byte, &offset);
-	return eba_get_byte_bit(eba->bits[byte], offset);
+	for (i = 0; i < Eba_ul_bytes; ++i) {
+		reversed = (reversed << CHAR_BIT) | (word & UCHAR_MAX);
+		word >>= CHAR_BIT;
+	}
+	return reversed;
+#endif
 }
+#endif
 
-#if (!(EBA_SKIP_SET_ALL))
-void eba_set_all(struct eba *eba, unsigned char val)
+#if (Eba_need_streams_)
+/* the memory holding byte k of the bits, counting from index zero */
+static unsigned char *eba_index_byte_(struct eba *eba, size_t k)
 {
-	int all_vals = val ? -1 : 0;
+	if (eba->endian == eba_big_endian) {
+		return eba->bits + ((eba->size_bytes - 1) - k);
+	}
+	return eba->bits + k;
+}
 
-	eba_assert_not_null_(eba);
+/* a word of bytes k, k+1, ... with byte k as the low byte */
+static unsigned long eba_load_index_ul_(struct eba *eba, size_t k)
+{
+	unsigned long word = 0;
 
-	eembed_memset(eba->bits, all_vals, eba->size_bytes);
+	if (eba->endian == eba_big_endian) {
+		word = eba_load_ul_(eba_index_byte_(eba, k + Eba_ul_bytes - 1));
+		return eba_reverse_bytes_ul_(word);
+	}
+	return eba_load_ul_(eba->bits + k);
 }
-#endif /* (!(EBA_SKIP_SET_ALL)) */
 
-#if (!(EBA_SKIP_TOGGLE))
-void eba_toggle(struct eba *eba, unsigned long index)
+static void eba_store_index_ul_(struct eba *eba, size_t k, unsigned long word)
 {
-	size_t byte = 0;
-	unsigned char offset = 0;
+	if (eba->endian == eba_big_endian) {
+		word = eba_reverse_bytes_ul_(word);
+		eba_store_ul_(eba_index_byte_(eba, k + Eba_ul_bytes - 1), word);
+	} else {
+		eba_store_ul_(eba->bits + k, word);
+	}
+}
+#endif /* Eba_need_streams_ */
 
-	eba_assert_not_null_(eba);
+#if ((Eba_need_scans_) || (!(EBA_SKIP_BITSTREAM)) || (Eba_need_gf2_) \
+	|| (Eba_need_bitslice_) || (Eba_need_bit_words_))
+/* index of the lowest set bit, word must not be zero */
+static unsigned eba_ctz_ul_(unsigned long word)
+{
+#if (defined(__GNUC__))
+	return (unsigned)__builtin_ctzl(word);
+#else
+	unsigned n = 0;
 
-	eba_get_byte_and_offset_(eba, index, &byte, &offset);
-	eba->bits[byte] ^= (1U << offset);
+	eembed_assert(word);
+	while (!(word & 1UL)) {
+		word >>= 1;
+		++n;
+	}
+	return n;
+#endif
 }
-#endif /* (!(EBA_SKIP_TOGGLE)) */
+#endif
 
-#if (!(EBA_SKIP_SWAP))
-void eba_swap(struct eba *eba, unsigned long index1, unsigned long index2)
+#if (Eba_need_bit_words_)
+/* bits base up to base + Eba_ul_bits of the eba, with those from n on
+ * clear, and bit base as the low bit */
+static unsigned long eba_bits_word_(struct eba *eba, size_t base, size_t n)
 {
-	unsigned char tmp1 = 0;
-	unsigned char tmp2 = 0;
+	unsigned long word = 0;
+	unsigned char byte = 0;
+	size_t k = base / CHAR_BIT;
+	size_t i = 0;
 
-	tmp1 = eba_get(eba, index1);
-	tmp2 = eba_get(eba, index2);
-	eba_set(eba, index1, tmp2);
-	eba_set(eba, index2, tmp1);
+	if ((k + Eba_ul_bytes) <= eba->size_bytes) {
+		if (eba->endian == eba_big_endian) {
+			word = eba_load_ul_(eba->bits + eba->size_bytes
+					    - (k + Eba_ul_bytes));
+			word = eba_reverse_bytes_ul_(word);
+		} else {
+			word = eba_load_ul_(eba->bits + k);
+		}
+	} else {
+		for (i = 0; i < Eba_ul_bytes && (k + i) < eba->size_bytes;
+		     ++i) {
+			byte = (eba->endian == eba_big_endian)
+			    ? eba->bits[(eba->size_bytes - 1) - (k + i)]
+			    : eba->bits[k + i];
+			word |= ((unsigned long)byte) << (CHAR_BIT * i);
+		}
+	}
+	if ((n - base) < Eba_ul_bits) {
+		word &= (1UL << (n - base)) - 1;
+	}
+	return word;
 }
-#endif /* (!(EBA_SKIP_SWAP)) */
+#endif /* Eba_need_bit_words_ */
 
-struct eba *eba_from_bytes(unsigned char *bytes, size_t len,
-			   enum eba_endian endian)
+#if ((!(EBA_SKIP_BITSTREAM)) || (!(EBA_SKIP_POOL)))
+/* index of the highest set bit, x must not be zero */
+static unsigned eba_high_bit_ul_(unsigned long x)
 {
-	struct eba *eba = NULL;
-	unsigned char *space = NULL;
-	size_t space_len = 0;
+#if (defined(__GNUC__))
+	size_t ul_bits = sizeof(unsigned long) * CHAR_BIT;
 
-	if (!bytes) {
-		return NULL;
-	}
+	return (unsigned)((ul_bits - 1) - __builtin_clzl(x));
+#else
+	unsigned n = 0;
 
-	if (len < sizeof(struct eba)) {
-		return NULL;
+	eembed_assert(x);
+	while (x >>= 1) {
+		++n;
 	}
+	return n;
+#endif
+}
+#endif
 
-	eba = (struct eba *)bytes;
-	space = bytes + (sizeof(struct eba));
-	space_len = len - (sizeof(struct eba));
-
-	eba->endian = endian;
-	eba->size_bytes = space_len;
-	eba->bits = space;
+#if (Eba_need_scans_)
+/* for bitmaps with levels of summary above them, one bit per word below:
+ * fills words with the size of each level, returns the number of levels;
+ * the top level is a single word */
+static unsigned eba_levels_layout_(size_t bits, size_t *words, unsigned max)
+{
+	unsigned levels = 0;
 
-	return eba;
+	if (!bits) {
+		return 0;
+	}
+	do {
+		if (levels == max) {
+			return 0;
+		}
+		words[levels] = (bits / Eba_ul_bits)
+		    + ((bits % Eba_ul_bits) ? 1 : 0);
+		bits = words[levels];
+		++levels;
+	} while (bits > 1);
+	return levels;
 }
+#endif /* Eba_need_scans_ */
 
-#if (!(EBA_SKIP_SHIFTS))
+#if (Eba_need_counts_)
+static unsigned long eba_popcount_ul_(unsigned long word)
+{
+#if (defined(__GNUC__) && defined(__POPCNT__))
+	return (unsigned long)__builtin_popcountl(word);
+#else
+	/* sum adjacent bits, then pairs, then nibbles, then all the bytes */
+	const unsigned long m1 = (~0UL) / 3;
+	const unsigned long m2 = (~0UL) / 5;
+	const unsigned long m4 = (~0UL) / 17;
+	const unsigned long h01 = (~0UL) / 255;
 
-enum eba_shift_fill_val {
-	eba_fill_zero = 0,
-	eba_fill_one = 1,
-	eba_fill_ring
-};
+	eembed_assert(CHAR_BIT == 8);
 
-#ifndef Eba_stack_buf_size
-#define Eba_stack_buf_size ((sizeof(void *)) * (sizeof(void *)))
+	word = word - ((word >> 1) & m1);
+	word = (word & m2) + ((word >> 2) & m2);
+	word = (word + (word >> 4)) & m4;
+	return (word * h01) >> ((sizeof(unsigned long) - 1) * CHAR_BIT);
 #endif
-
-static size_t eba_min_(size_t a, size_t b)
-{
-	return a > b ? b : a;
 }
 
-static void eba_shift_right_be_(struct eba *eba, unsigned long positions,
-				enum eba_shift_fill_val fill)
+enum eba_count_op_ {
+	eba_count_xor_,
+	eba_count_and_,
+	eba_count_or_,
+	eba_count_and_or_
+};
+
+static unsigned long eba_popcount_bytes_c89_(const unsigned char *bytes,
+					     size_t len)
 {
-	unsigned char *buf = NULL;
+	unsigned long count = 0;
 	size_t i = 0;
-	size_t buf_size = 0;
-	size_t shift_bytes = 0;
-	size_t shift_bits = 0;
-	size_t size_bits = 0;
-	unsigned char lowest = 0;
-	size_t tmp_size = Eba_stack_buf_size;
-	unsigned char tmp[Eba_stack_buf_size];
+	size_t w = sizeof(unsigned long);
 
-	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+	for (i = 0; (i + w) <= len; i += w) {
+		count += eba_popcount_ul_(eba_load_ul_(bytes + i));
+	}
+	for (; i < len; ++i) {
+		count += eba_popcount_ul_(bytes[i]);
+	}
+	return count;
+}
 
-	eba_assert_not_null_(eba);
-	eembed_assert(CHAR_BIT == 8);
-	eembed_assert(eba->size_bytes);
-	eembed_assert(eba->size_bytes < (ULONG_MAX * 8));
+/* counts for two byte ranges of the same layout; for eba_count_and_or_
+ * the "and" count is in *count and the "or" count is in *count2;
+ * if b is NULL, the count is of the bits of a */
+static void eba_count_bytes_c89_(const unsigned char *a,
+				 const unsigned char *b, size_t len,
+				 enum eba_count_op_ op, unsigned long *count,
+				 unsigned long *count2)
+{
+	size_t i = 0;
+	size_t w = sizeof(unsigned long);
+	size_t whole = len - (len % w);
+	unsigned long c = 0;
+	unsigned long c2 = 0;
 
-	size_bits = eba->size_bytes * CHAR_BIT;
-	if (positions >= size_bits) {
-		if (fill == eba_fill_ring) {
-			positions = positions % size_bits;
-		} else {
-			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
-			eembed_memset(eba->bits, all_vals, eba->size_bytes);
-			return;
+	if (!b) {
+		*count += eba_popcount_bytes_c89_(a, len);
+		return;
+	}
+	switch (op) {
+	case eba_count_xor_:
+		for (i = 0; i < whole; i += w) {
+			c += eba_popcount_ul_(eba_load_ul_(a + i)
+					      ^ eba_load_ul_(b + i));
+		}
+		for (; i < len; ++i) {
+			c += eba_popcount_ul_(a[i] ^ b[i]);
+		}
+		break;
+	case eba_count_and_:
+		for (i = 0; i < whole; i += w) {
+			c += eba_popcount_ul_(eba_load_ul_(a + i)
+					      & eba_load_ul_(b + i));
+		}
+		for (; i < len; ++i) {
+			c += eba_popcount_ul_(a[i] & b[i]);
 		}
+		break;
+	case eba_count_or_:
+		for (i = 0; i < whole; i += w) {
+			c += eba_popcount_ul_(eba_load_ul_(a + i)
+					      | eba_load_ul_(b + i));
+		}
+		for (; i < len; ++i) {
+			c += eba_popcount_ul_(a[i] | b[i]);
+		}
+		break;
+	case eba_count_and_or_:
+		for (i = 0; i < whole; i += w) {
+			unsigned long wa = eba_load_ul_(a + i);
+			unsigned long wb = eba_load_ul_(b + i);
+			c += eba_popcount_ul_(wa & wb);
+			c2 += eba_popcount_ul_(wa | wb);
+		}
+		for (; i < len; ++i) {
+			c += eba_popcount_ul_(a[i] & b[i]);
+			c2 += eba_popcount_ul_(a[i] | b[i]);
+		}
+		break;
 	}
+	*count += c;
+	*count2 += c2;
+}
 
-	if (positions == 0) {
-		return;
-	}
+typedef void (*eba_count_kernel_)(const unsigned char *a,
+				  const unsigned char *b, size_t len,
+				  enum eba_count_op_ op, unsigned long *count,
+				  unsigned long *count2);
 
-	buf = eba->bits;
-	buf_size = eba->size_bytes;
+#if (Eba_isa_dispatch_)
+/* the vector kernels handle whole vectors, leaving the rest to the c89 */
 
-	shift_bytes = positions / 8;
-	while (shift_bytes) {
-		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+/* the count of the bits of each 64 bit lane */
+__attribute__((target("sse2")))
+static __m128i eba_popcount_epi64_sse2_(__m128i v)
+{
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0F);
 
-		if (fill == eba_fill_ring) {
-			unsigned char *orig = buf + (buf_size - mv_bytes);
-			eembed_memcpy(tmp, orig, mv_bytes);
-		};
+	v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+	v = _mm_add_epi8(_mm_and_si128(v, m2),
+			 _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+	v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+	return _mm_sad_epu8(v, _mm_setzero_si128());
+}
 
-		eembed_memmove(buf + mv_bytes, buf, buf_size - mv_bytes);
-		eembed_memcpy(buf, tmp, mv_bytes);
+__attribute__((target("sse2")))
+static void eba_count_bytes_sse2_(const unsigned char *a,
+				  const unsigned char *b, size_t len,
+				  enum eba_count_op_ op, unsigned long *count,
+				  unsigned long *count2)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	__m128i acc2 = zero;
+	__m128i va, vb, x;
+	unsigned long lanes[2];
+	size_t i = 0;
 
-		shift_bytes -= mv_bytes;
+	for (i = 0; (i + 16) <= len; i += 16) {
+		va = _mm_loadu_si128((const __m128i *)(const void *)(a + i));
+		x = va;
+		if (b) {
+			vb = _mm_loadu_si128((const __m128i *)(const void *)
+					     (b + i));
+			switch (op) {
+			case eba_count_xor_:
+				x = _mm_xor_si128(va, vb);
+				break;
+			case eba_count_and_:
+				x = _mm_and_si128(va, vb);
+				break;
+			case eba_count_or_:
+				x = _mm_or_si128(va, vb);
+				break;
+			case eba_count_and_or_:
+				x = _mm_and_si128(va, vb);
+				vb = _mm_or_si128(va, vb);
+				acc2 = _mm_add_epi64(acc2,
+						     eba_popcount_epi64_sse2_
+						     (vb));
+				break;
+			}
+		}
+		acc = _mm_add_epi64(acc, eba_popcount_epi64_sse2_(x));
 	}
+	_mm_storeu_si128((__m128i *)(void *)lanes, acc);
+	*count += lanes[0] + lanes[1];
+	_mm_storeu_si128((__m128i *)(void *)lanes, acc2);
+	*count2 += lanes[0] + lanes[1];
+	eba_count_bytes_c89_(a + i, b ? (b + i) : NULL, len - i, op, count,
+			     count2);
+}
 
-	shift_bits = positions % CHAR_BIT;
-	if (shift_bits == 0) {
-		return;
+/* the count of each nibble value, looked up with a byte shuffle */
+#define Eba_nibble_counts_ \
+	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+
+__attribute__((target("avx2")))
+static __m256i eba_popcount_epi64_avx2_(__m256i v)
+{
+	const __m256i table = _mm256_setr_epi8(Eba_nibble_counts_,
+					       Eba_nibble_counts_);
+	const __m256i low = _mm256_set1_epi8(0x0F);
+	__m256i lo = _mm256_and_si256(v, low);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+
+	v = _mm256_add_epi8(_mm256_shuffle_epi8(table, lo),
+			    _mm256_shuffle_epi8(table, hi));
+	return _mm256_sad_epu8(v, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static void eba_count_bytes_avx2_(const unsigned char *a,
+				  const unsigned char *b, size_t len,
+				  enum eba_count_op_ op, unsigned long *count,
+				  unsigned long *count2)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	__m256i acc2 = zero;
+	__m256i va, vb, x;
+	unsigned long lanes[4];
+	size_t i = 0;
+
+	for (i = 0; (i + 32) <= len; i += 32) {
+		va = _mm256_loadu_si256((const __m256i *)(const void *)(a + i));
+		x = va;
+		if (b) {
+			vb = _mm256_loadu_si256((const __m256i *)(const void *)
+						(b + i));
+			switch (op) {
+			case eba_count_xor_:
+				x = _mm256_xor_si256(va, vb);
+				break;
+			case eba_count_and_:
+				x = _mm256_and_si256(va, vb);
+				break;
+			case eba_count_or_:
+				x = _mm256_or_si256(va, vb);
+				break;
+			case eba_count_and_or_:
+				x = _mm256_and_si256(va, vb);
+				vb = _mm256_or_si256(va, vb);
+				acc2 = _mm256_add_epi64(acc2,
+							eba_popcount_epi64_avx2_
+							(vb));
+				break;
+			}
+		}
+		acc = _mm256_add_epi64(acc, eba_popcount_epi64_avx2_(x));
 	}
+	_mm256_storeu_si256((__m256i *)(void *)lanes, acc);
+	*count += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	_mm256_storeu_si256((__m256i *)(void *)lanes, acc2);
+	*count2 += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	eba_count_bytes_c89_(a + i, b ? (b + i) : NULL, len - i, op, count,
+			     count2);
+}
 
-	switch (fill) {
-	case eba_fill_zero:
-		lowest = 0x00;
+__attribute__((target("avx512f,avx512bw")))
+static __m512i eba_popcount_epi64_avx512_(__m512i v)
+{
+	const __m512i table = _mm512_broadcast_i32x4(_mm_setr_epi8
+						     (Eba_nibble_counts_));
+	const __m512i low = _mm512_set1_epi8(0x0F);
+	__m512i lo = _mm512_and_si512(v, low);
+	__m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low);
+
+	v = _mm512_add_epi8(_mm512_shuffle_epi8(table, lo),
+			    _mm512_shuffle_epi8(table, hi));
+	return _mm512_sad_epu8(v, _mm512_setzero_si512());
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void eba_count_bytes_avx512_(const unsigned char *a,
+				    const unsigned char *b, size_t len,
+				    enum eba_count_op_ op,
+				    unsigned long *count,
+				    unsigned long *count2)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc = zero;
+	__m512i acc2 = zero;
+	__m512i va, vb, x;
+	unsigned long lanes[8];
+	size_t i = 0;
+	size_t j = 0;
+
+	for (i = 0; (i + 64) <= len; i += 64) {
+		va = _mm512_loadu_si512((const void *)(a + i));
+		x = va;
+		if (b) {
+			vb = _mm512_loadu_si512((const void *)(b + i));
+			switch (op) {
+			case eba_count_xor_:
+				x = _mm512_xor_si512(va, vb);
+				break;
+			case eba_count_and_:
+				x = _mm512_and_si512(va, vb);
+				break;
+			case eba_count_or_:
+				x = _mm512_or_si512(va, vb);
+				break;
+			case eba_count_and_or_:
+				x = _mm512_and_si512(va, vb);
+				vb = _mm512_or_si512(va, vb);
+				acc2 = _mm512_add_epi64(acc2,
+						eba_popcount_epi64_avx512_(vb));
+				break;
+			}
+		}
+		acc = _mm512_add_epi64(acc, eba_popcount_epi64_avx512_(x));
+	}
+	_mm512_storeu_si512((void *)lanes, acc);
+	for (j = 0; j < 8; ++j) {
+		*count += lanes[j];
+	}
+	_mm512_storeu_si512((void *)lanes, acc2);
+	for (j = 0; j < 8; ++j) {
+		*count2 += lanes[j];
+	}
+	eba_count_bytes_c89_(a + i, b ? (b + i) : NULL, len - i, op, count,
+			     count2);
+}
+
+/* where the cpu has VPOPCNTDQ, a popcount of each 64 bit lane */
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void eba_count_bytes_vpopcnt_(const unsigned char *a,
+				     const unsigned char *b, size_t len,
+				     enum eba_count_op_ op,
+				     unsigned long *count,
+				     unsigned long *count2)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc = zero;
+	__m512i acc2 = zero;
+	__m512i va, vb, x;
+	unsigned long lanes[8];
+	size_t i = 0;
+	size_t j = 0;
+
+	for (i = 0; (i + 64) <= len; i += 64) {
+		va = _mm512_loadu_si512((const void *)(a + i));
+		x = va;
+		if (b) {
+			vb = _mm512_loadu_si512((const void *)(b + i));
+			switch (op) {
+			case eba_count_xor_:
+				x = _mm512_xor_si512(va, vb);
+				break;
+			case eba_count_and_:
+				x = _mm512_and_si512(va, vb);
+				break;
+			case eba_count_or_:
+				x = _mm512_or_si512(va, vb);
+				break;
+			case eba_count_and_or_:
+				x = _mm512_and_si512(va, vb);
+				vb = _mm512_or_si512(va, vb);
+				acc2 = _mm512_add_epi64(acc2,
+						_mm512_popcnt_epi64(vb));
+				break;
+			}
+		}
+		acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+	}
+	_mm512_storeu_si512((void *)lanes, acc);
+	for (j = 0; j < 8; ++j) {
+		*count += lanes[j];
+	}
+	_mm512_storeu_si512((void *)lanes, acc2);
+	for (j = 0; j < 8; ++j) {
+		*count2 += lanes[j];
+	}
+	eba_count_bytes_c89_(a + i, b ? (b + i) : NULL, len - i, op, count,
+			     count2);
+}
+
+#undef Eba_nibble_counts_
+
+static eba_count_kernel_ eba_count_kernel_isa_ = eba_count_bytes_c89_;
+#endif /* Eba_isa_dispatch_ */
+
+static void eba_count_bytes_(const unsigned char *a, const unsigned char *b,
+			     size_t len, enum eba_count_op_ op,
+			     unsigned long *count, unsigned long *count2)
+{
+#if (Eba_isa_dispatch_)
+	eba_count_kernel_isa_(a, b, len, op, count, count2);
+#else
+	eba_count_bytes_c89_(a, b, len, op, count, count2);
+#endif
+}
+
+static unsigned long eba_popcount_bytes_(const unsigned char *bytes,
+					 size_t len)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+
+	eba_count_bytes_(bytes, NULL, len, eba_count_xor_, &count, &unused);
+	return count;
+}
+
+#if ((!(EBA_SKIP_SIMILARITY)) || (!(EBA_SKIP_MATRIX)))
+/* Compares bit index by bit index; where one array is longer than the
+ * other, the missing bits of the shorter are treated as zero. */
+static void eba_count_pair_(struct eba *a, struct eba *b,
+			    enum eba_count_op_ op, unsigned long *count,
+			    unsigned long *count2)
+{
+	struct eba *longer = NULL;
+	size_t min_bytes = 0;
+	size_t extra = 0;
+	size_t i = 0;
+	unsigned long extra_count = 0;
+	const unsigned char *pa = NULL;
+	const unsigned char *pb = NULL;
+
+	eba_assert_not_null_(a);
+	eba_assert_not_null_(b);
+
+	*count = 0;
+	*count2 = 0;
+
+	longer = (a->size_bytes >= b->size_bytes) ? a : b;
+	min_bytes = eba_min_(a->size_bytes, b->size_bytes);
+	extra = longer->size_bytes - min_bytes;
+
+	/* in a big endian eba, the low bits are at the end of the buffer */
+	pa = a->bits + ((a->endian == eba_big_endian)
+			? (a->size_bytes - min_bytes) : 0);
+	pb = b->bits + ((b->endian == eba_big_endian)
+			? (b->size_bytes - min_bytes) : 0);
+
+	if (a->endian == b->endian) {
+		eba_count_bytes_(pa, pb, min_bytes, op, count, count2);
+	} else {
+		/* the bytes of one run in the opposite direction */
+		for (i = 0; i < min_bytes; ++i) {
+			unsigned char x = 0;
+			unsigned char y = 0;
+			if (a->endian == eba_big_endian) {
+				x = pa[(min_bytes - 1) - i];
+				y = pb[i];
+			} else {
+				x = pa[i];
+				y = pb[(min_bytes - 1) - i];
+			}
+			switch (op) {
+			case eba_count_xor_:
+				*count += eba_popcount_ul_(x ^ y);
+				break;
+			case eba_count_and_:
+				*count += eba_popcount_ul_(x & y);
+				break;
+			case eba_count_or_:
+				*count += eba_popcount_ul_(x | y);
+				break;
+			case eba_count_and_or_:
+				*count += eba_popcount_ul_(x & y);
+				*count2 += eba_popcount_ul_(x | y);
+				break;
+			}
+		}
+	}
+
+	if (extra && op != eba_count_and_) {
+		pa = longer->bits;
+		if (longer->endian != eba_big_endian) {
+			pa += min_bytes;
+		}
+		extra_count = eba_popcount_bytes_(pa, extra);
+		if (op == eba_count_and_or_) {
+			*count2 += extra_count;
+		} else {
+			*count += extra_count;
+		}
+	}
+}
+#endif /* ((!(EBA_SKIP_SIMILARITY)) || (!(EBA_SKIP_MATRIX))) */
+#endif /* Eba_need_counts_ */
+
+#if (Eba_isa_dispatch_)
+static enum eba_isa eba_isa_ = eba_isa_portable;
+
+static enum eba_isa eba_isa_supported_(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512bw")) {
+		return eba_isa_avx512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return eba_isa_avx2;
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		return eba_isa_sse2;
+	}
+	return eba_isa_portable;
+}
+
+static enum eba_isa eba_isa_use_(enum eba_isa isa)
+{
+	enum eba_isa supported = eba_isa_supported_();
+
+	if (isa > supported) {
+		isa = supported;
+	}
+	switch (isa) {
+	case eba_isa_avx512:
+		if (__builtin_cpu_supports("avx512vpopcntdq")) {
+			eba_count_kernel_isa_ = eba_count_bytes_vpopcnt_;
+		} else {
+			eba_count_kernel_isa_ = eba_count_bytes_avx512_;
+		}
 		break;
-	case eba_fill_one:
-		lowest = 0xFF;
+	case eba_isa_avx2:
+		eba_count_kernel_isa_ = eba_count_bytes_avx2_;
 		break;
-	case eba_fill_ring:
-		lowest = buf[buf_size - 1];
+	case eba_isa_sse2:
+		eba_count_kernel_isa_ = eba_count_bytes_sse2_;
 		break;
-	};
-	for (i = 0; i < buf_size; ++i) {
-		size_t byte_pos = buf_size - (1 + i);
-		unsigned char lo_val = buf[byte_pos];
-		unsigned char hi_val = byte_pos ? buf[byte_pos - 1] : lowest;
-		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
-		unsigned u16_b = (u16_a >> shift_bits);
-		unsigned char val = 0xFF & ((unsigned char)u16_b);
-		buf[byte_pos] = val;
+	case eba_isa_portable:
+	default:
+		isa = eba_isa_portable;
+		eba_count_kernel_isa_ = eba_count_bytes_c89_;
+		break;
+	}
+	eba_isa_ = isa;
+	return isa;
+}
+
+/* when the library is loaded: the best the cpu has, unless the EBA_ISA
+ * environment variable asks for less */
+__attribute__((constructor))
+static void eba_isa_init_(void)
+{
+	const char *names[] = { "portable", "sse2", "avx2", "avx512" };
+	enum eba_isa isa = eba_isa_avx512;
+	const char *env = getenv("EBA_ISA");
+	unsigned i = 0;
+
+	for (i = 0; env && i < 4; ++i) {
+		if (strcmp(env, names[i]) == 0) {
+			isa = (enum eba_isa)i;
+		}
+	}
+	eba_isa_use_(isa);
+}
+#endif /* Eba_isa_dispatch_ */
+
+enum eba_isa eba_isa_current(void)
+{
+#if (Eba_isa_dispatch_)
+	return eba_isa_;
+#else
+	return eba_isa_portable;
+#endif
+}
+
+enum eba_isa eba_isa_force(enum eba_isa isa)
+{
+#if (Eba_isa_dispatch_)
+	return eba_isa_use_(isa);
+#else
+	(void)isa;
+	return eba_isa_portable;
+#endif
+}
+
+unsigned char eba_set_byte_bit(unsigned char byte, unsigned i, unsigned val)
+{
+	eembed_assert(i < CHAR_BIT);
+
+	/* This should work, but seems too tricky: */
+	/* val = val ? 1 : 0; */
+	/* byte ^= (-val ^ byte) & (1U << i); */
+	/* instead, be a bit more verbose and trust the optimizer */
+	if (val) {
+		byte |= (1U << i);
+	} else {
+		byte &= ~(1U << i);
+	}
+
+	return byte;
+
+}
+
+unsigned char eba_get_byte_bit(unsigned char byte, unsigned i)
+{
+	eembed_assert(i < CHAR_BIT);
+	return (byte >> i) & 0x01;
+}
+
+void eba_set(struct eba *eba, unsigned long index, unsigned char val)
+{
+	size_t byte = 0;
+	unsigned char offset = 0;
+
+	eba_assert_not_null_(eba);
+	eba_get_byte_and_offset_(eba, index, &byte, &offset);
+
+	eba->bits[byte] = eba_set_byte_bit(eba->bits[byte], offset, val);
+}
+
+unsigned char eba_get(struct eba *eba, unsigned long index)
+{
+	size_t byte = 0;
+	unsigned char offset = 0;
+
+	eba_assert_not_null_(eba);
+
+	eba_get_byte_and_offset_(eba, index, &byte, &offset);
+	return eba_get_byte_bit(eba->bits[byte], offset);
+}
+
+unsigned long eba_get_bits(struct eba *eba, unsigned long index,
+			   unsigned nbits)
+{
+	size_t byte = 0;
+	unsigned char offset = 0;
+	unsigned take = 0;
+	unsigned got = 0;
+	unsigned long chunk = 0;
+	unsigned long val = 0;
+
+	eba_assert_not_null_(eba);
+	eembed_assert(nbits <= (sizeof(unsigned long) * CHAR_BIT));
+
+	/* a field may span bytes, take what each byte has of it */
+	while (got < nbits) {
+		eba_get_byte_and_offset_(eba, index + got, &byte, &offset);
+		take = CHAR_BIT - offset;
+		if (take > (nbits - got)) {
+			take = nbits - got;
+		}
+		chunk = ((unsigned long)eba->bits[byte]) >> offset;
+		chunk &= (~0UL) >> ((sizeof(unsigned long) * CHAR_BIT) - take);
+		val |= chunk << got;
+		got += take;
+	}
+	return val;
+}
+
+void eba_set_bits(struct eba *eba, unsigned long index, unsigned nbits,
+		  unsigned long val)
+{
+	size_t byte = 0;
+	unsigned char offset = 0;
+	unsigned take = 0;
+	unsigned done = 0;
+	unsigned mask = 0;
+
+	eba_assert_not_null_(eba);
+	eembed_assert(nbits <= (sizeof(unsigned long) * CHAR_BIT));
+
+	while (done < nbits) {
+		eba_get_byte_and_offset_(eba, index + done, &byte, &offset);
+		take = CHAR_BIT - offset;
+		if (take > (nbits - done)) {
+			take = nbits - done;
+		}
+		mask = ((1U << take) - 1) << offset;
+		eba->bits[byte] = (unsigned char)((eba->bits[byte] & ~mask)
+						  | (((val >> done) << offset)
+						     & mask));
+		done += take;
+	}
+}
+
+#if (!(EBA_SKIP_SET_ALL))
+void eba_set_all(struct eba *eba, unsigned char val)
+{
+	int all_vals = val ? -1 : 0;
+
+	eba_assert_not_null_(eba);
+
+	eembed_memset(eba->bits, all_vals, eba->size_bytes);
+}
+#endif /* (!(EBA_SKIP_SET_ALL)) */
+
+#if (!(EBA_SKIP_TOGGLE))
+void eba_toggle(struct eba *eba, unsigned long index)
+{
+	size_t byte = 0;
+	unsigned char offset = 0;
+
+	eba_assert_not_null_(eba);
+
+	eba_get_byte_and_offset_(eba, index, &byte, &offset);
+	eba->bits[byte] ^= (1U << offset);
+}
+#endif /* (!(EBA_SKIP_TOGGLE)) */
+
+#if (!(EBA_SKIP_SWAP))
+void eba_swap(struct eba *eba, unsigned long index1, unsigned long index2)
+{
+	unsigned char tmp1 = 0;
+	unsigned char tmp2 = 0;
+
+	tmp1 = eba_get(eba, index1);
+	tmp2 = eba_get(eba, index2);
+	eba_set(eba, index1, tmp2);
+	eba_set(eba, index2, tmp1);
+}
+#endif /* (!(EBA_SKIP_SWAP)) */
+
+struct eba *eba_from_bytes(unsigned char *bytes, size_t len,
+			   enum eba_endian endian)
+{
+	struct eba *eba = NULL;
+	unsigned char *space = NULL;
+	size_t space_len = 0;
+
+	if (!bytes) {
+		return NULL;
+	}
+
+	if (len < sizeof(struct eba)) {
+		return NULL;
+	}
+
+	eba = (struct eba *)bytes;
+	space = bytes + (sizeof(struct eba));
+	space_len = len - (sizeof(struct eba));
+
+	eba->endian = endian;
+	eba->size_bytes = space_len;
+	eba->bits = space;
+
+	return eba;
+}
+
+#if (!(EBA_SKIP_SHIFTS))
+
+enum eba_shift_fill_val {
+	eba_fill_zero = 0,
+	eba_fill_one = 1,
+	eba_fill_ring
+};
+
+#ifndef Eba_stack_buf_size
+#define Eba_stack_buf_size ((sizeof(void *)) * (sizeof(void *)))
+#endif
+
+static void eba_shift_right_be_(struct eba *eba, unsigned long positions,
+				enum eba_shift_fill_val fill)
+{
+	unsigned char *buf = NULL;
+	size_t i = 0;
+	size_t buf_size = 0;
+	size_t shift_bytes = 0;
+	size_t shift_bits = 0;
+	size_t size_bits = 0;
+	unsigned char lowest = 0;
+	size_t tmp_size = Eba_stack_buf_size;
+	unsigned char tmp[Eba_stack_buf_size];
+
+	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+
+	eba_assert_not_null_(eba);
+	eembed_assert(CHAR_BIT == 8);
+	eembed_assert(eba->size_bytes);
+	eembed_assert(eba->size_bytes < (ULONG_MAX * 8));
+
+	size_bits = eba->size_bytes * CHAR_BIT;
+	if (positions >= size_bits) {
+		if (fill == eba_fill_ring) {
+			positions = positions % size_bits;
+		} else {
+			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
+			eembed_memset(eba->bits, all_vals, eba->size_bytes);
+			return;
+		}
+	}
+
+	if (positions == 0) {
+		return;
+	}
+
+	buf = eba->bits;
+	buf_size = eba->size_bytes;
+
+	shift_bytes = positions / 8;
+	while (shift_bytes) {
+		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+
+		if (fill == eba_fill_ring) {
+			unsigned char *orig = buf + (buf_size - mv_bytes);
+			eembed_memcpy(tmp, orig, mv_bytes);
+		};
+
+		eembed_memmove(buf + mv_bytes, buf, buf_size - mv_bytes);
+		eembed_memcpy(buf, tmp, mv_bytes);
+
+		shift_bytes -= mv_bytes;
+	}
+
+	shift_bits = positions % CHAR_BIT;
+	if (shift_bits == 0) {
+		return;
+	}
+
+	switch (fill) {
+	case eba_fill_zero:
+		lowest = 0x00;
+		break;
+	case eba_fill_one:
+		lowest = 0xFF;
+		break;
+	case eba_fill_ring:
+		lowest = buf[buf_size - 1];
+		break;
+	};
+	for (i = 0; i < buf_size; ++i) {
+		size_t byte_pos = buf_size - (1 + i);
+		unsigned char lo_val = buf[byte_pos];
+		unsigned char hi_val = byte_pos ? buf[byte_pos - 1] : lowest;
+		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
+		unsigned u16_b = (u16_a >> shift_bits);
+		unsigned char val = 0xFF & ((unsigned char)u16_b);
+		buf[byte_pos] = val;
+	}
+}
+
+static void eba_shift_right_el_(struct eba *eba, unsigned long positions,
+				enum eba_shift_fill_val fill)
+{
+	unsigned long i = 0;
+	size_t shift_bytes = 0;
+	unsigned char lowest = 0x00;
+	size_t size_bits = 0;
+	size_t shift_bits = 0;
+	unsigned char *buf = NULL;
+	size_t buf_size = 0;
+	size_t tmp_size = Eba_stack_buf_size;
+	unsigned char tmp[Eba_stack_buf_size];
+
+	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+
+	buf = eba->bits;
+	buf_size = eba->size_bytes;
+	size_bits = eba->size_bytes * CHAR_BIT;
+
+	if (positions >= size_bits) {
+		if (fill == eba_fill_ring) {
+			positions = positions % size_bits;
+		} else {
+			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
+			eembed_memset(eba->bits, all_vals, eba->size_bytes);
+			return;
+		}
+	}
+
+	if (positions == 0) {
+		return;
+	}
+
+	shift_bytes = positions / CHAR_BIT;
+	while (shift_bytes) {
+		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+		if (fill == eba_fill_ring) {
+			eembed_memcpy(tmp, buf, mv_bytes);
+		}
+		eembed_memmove(buf, buf + mv_bytes, buf_size - mv_bytes);
+		eembed_memcpy(buf + buf_size - mv_bytes, tmp, mv_bytes);
+
+		shift_bytes -= mv_bytes;
+	}
+
+	shift_bits = positions % CHAR_BIT;
+	if (shift_bits == 0) {
+		return;
+	}
+
+	switch (fill) {
+	case eba_fill_zero:
+		lowest = 0x00;
+		break;
+	case eba_fill_one:
+		lowest = 0xFF;
+		break;
+	case eba_fill_ring:
+		lowest = buf[0];
+		break;
+	}
+	for (i = 0; i < buf_size; ++i) {
+		unsigned char hi_val = i < (buf_size - 1) ? buf[i + 1] : lowest;
+		unsigned char lo_val = buf[i];
+		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
+		unsigned u16_b = (u16_a >> shift_bits);
+		unsigned char val = 0xFF & ((unsigned char)u16_b);
+		buf[i] = val;
+	}
+	return;
+}
+
+static void eba_shift_right_(struct eba *eba, unsigned long positions,
+			     enum eba_shift_fill_val fill)
+{
+	if (eba->endian == eba_big_endian) {
+		eba_shift_right_be_(eba, positions, fill);
+	} else {
+		eba_shift_right_el_(eba, positions, fill);
+	}
+}
+
+static void eba_shift_left_be_(struct eba *eba, unsigned long positions,
+			       enum eba_shift_fill_val fill)
+{
+	unsigned long i = 0;
+	size_t shift_bytes = 0;
+	unsigned char highest = 0x00;
+	size_t shift_bits = 0;
+	size_t size_bits = 0;
+	unsigned char *buf = NULL;
+	size_t buf_size = 0;
+	size_t tmp_size = Eba_stack_buf_size;
+	unsigned char tmp[Eba_stack_buf_size];
+
+	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+
+	size_bits = eba->size_bytes * CHAR_BIT;
+	if (positions >= size_bits) {
+		if (fill == eba_fill_ring) {
+			positions = positions % size_bits;
+		} else {
+			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
+			eembed_memset(eba->bits, all_vals, eba->size_bytes);
+			return;
+		}
+	}
+
+	if (positions == 0) {
+		return;
+	}
+
+	buf = eba->bits;
+	buf_size = eba->size_bytes;
+
+	shift_bytes = positions / CHAR_BIT;
+	while (shift_bytes) {
+		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+		if (fill == eba_fill_ring) {
+			eembed_memcpy(tmp, buf, mv_bytes);
+		}
+		eembed_memmove(buf, buf + mv_bytes, buf_size - mv_bytes);
+		eembed_memcpy(buf + buf_size - mv_bytes, tmp, mv_bytes);
+
+		shift_bytes -= mv_bytes;
+	}
+
+	shift_bits = positions % CHAR_BIT;
+
+	switch (fill) {
+	case eba_fill_zero:
+		highest = 0x00;
+		break;
+	case eba_fill_one:
+		highest = 0xFF;
+		break;
+	case eba_fill_ring:
+		highest = buf[0];
+		break;
+	}
+	for (i = 0; i < buf_size; ++i) {
+		unsigned char hi_val = buf[i];
+		unsigned char lo_val =
+		    i < (buf_size - 1) ? buf[i + 1] : highest;
+		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
+		unsigned u16_b = ((u16_a << shift_bits) >> 8);
+		unsigned char val = 0xFF & ((unsigned char)u16_b);
+		buf[i] = val;
+	}
+}
+
+static void eba_shift_left_el_(struct eba *eba, unsigned long positions,
+			       enum eba_shift_fill_val fill)
+{
+	unsigned char *buf = NULL;
+	size_t i = 0;
+	size_t buf_size = 0;
+	size_t shift_bytes = 0;
+	size_t shift_bits = 0;
+	size_t size_bits = 0;
+	unsigned char highest = 0;
+	size_t tmp_size = Eba_stack_buf_size;
+	unsigned char tmp[Eba_stack_buf_size];
+
+	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+
+	eba_assert_not_null_(eba);
+	eembed_assert(CHAR_BIT == 8);
+	eembed_assert(eba->size_bytes);
+	eembed_assert(eba->size_bytes < (ULONG_MAX * 8));
+
+	size_bits = eba->size_bytes * CHAR_BIT;
+	if (positions >= size_bits) {
+		if (fill == eba_fill_ring) {
+			positions = positions % size_bits;
+		} else {
+			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
+			eembed_memset(eba->bits, all_vals, eba->size_bytes);
+			return;
+		}
+	}
+
+	if (positions == 0) {
+		return;
+	}
+
+	buf = eba->bits;
+	buf_size = eba->size_bytes;
+
+	shift_bytes = positions / 8;
+	while (shift_bytes) {
+		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+
+		if (fill == eba_fill_ring) {
+			unsigned char *orig = buf + (buf_size - mv_bytes);
+			eembed_memcpy(tmp, orig, mv_bytes);
+		};
+
+		eembed_memmove(buf + mv_bytes, buf, buf_size - mv_bytes);
+		eembed_memcpy(buf, tmp, mv_bytes);
+
+		shift_bytes -= mv_bytes;
+	}
+
+	shift_bits = positions % CHAR_BIT;
+
+	switch (fill) {
+	case eba_fill_zero:
+		highest = 0x00;
+		break;
+	case eba_fill_one:
+		highest = 0xFF;
+		break;
+	case eba_fill_ring:
+		highest = buf[buf_size - 1];
+		break;
+	};
+	for (i = 0; i < buf_size; ++i) {
+		size_t byte_pos = buf_size - (1 + i);
+		unsigned char hi_val = buf[byte_pos];
+		unsigned char lo_val = byte_pos ? buf[byte_pos - 1] : highest;
+		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
+		unsigned u16_b = ((u16_a << shift_bits) >> 8);
+		unsigned char val = 0xFF & ((unsigned char)u16_b);
+		buf[byte_pos] = val;
+	}
+
+	return;
+}
+
+static void eba_shift_left_(struct eba *eba, unsigned long positions,
+			    enum eba_shift_fill_val fill)
+{
+	if (eba->endian == eba_big_endian) {
+		eba_shift_left_be_(eba, positions, fill);
+	} else {
+		eba_shift_left_el_(eba, positions, fill);
+	}
+}
+
+void eba_rotate_right(struct eba *eba, unsigned long positions)
+{
+	eba_shift_right_(eba, positions, eba_fill_ring);
+}
+
+void eba_rotate_left(struct eba *eba, unsigned long positions)
+{
+	eba_shift_left_(eba, positions, eba_fill_ring);
+}
+
+void eba_shift_left(struct eba *eba, unsigned long positions)
+{
+	eba_shift_left_(eba, positions, eba_fill_zero);
+}
+
+void eba_shift_left_fill(struct eba *eba, unsigned long positions,
+			 unsigned char fillval)
+{
+	eba_shift_left_(eba, positions, fillval ? eba_fill_one : eba_fill_zero);
+}
+
+void eba_shift_right(struct eba *eba, unsigned long positions)
+{
+	eba_shift_right_(eba, positions, eba_fill_zero);
+}
+
+void eba_shift_right_fill(struct eba *eba, unsigned long positions,
+			  unsigned char fillval)
+{
+	eba_shift_right_(eba, positions,
+			 fillval ? eba_fill_one : eba_fill_zero);
+}
+
+#endif /* (!(EBA_SKIP_SHIFTS)) */
+
+#if (!(EBA_SKIP_NEW))
+
+struct eba *eba_new_endian(unsigned long num_bits, enum eba_endian endian)
+{
+	struct eba *eba = NULL;
+	unsigned char *bytes = NULL;
+	size_t len = 0;
+	size_t eba_s_size = 0;
+	size_t array_size = 0;
+
+	array_size = num_bits / CHAR_BIT;
+	if ((array_size * CHAR_BIT) < num_bits) {
+		array_size += 1;
+	}
+
+	eba_s_size = sizeof(struct eba);
+	len = eembed_align(eba_s_size) + array_size;
+	bytes = (unsigned char *)eembed_malloc(len);
+	if (!bytes) {
+		return NULL;
+	}
+
+	eba = eba_from_bytes(bytes, len, endian);
+	eba_set_all(eba, 0x00);
+	return eba;
+}
+
+struct eba *eba_new(unsigned long num_bits)
+{
+	return eba_new_endian(num_bits, eba_big_endian);
+}
+
+void eba_free(struct eba *eba)
+{
+	eembed_free(eba);
+}
+#endif /* #if (!(EBA_SKIP_NEW)) */
+
+static void eba_get_byte_and_offset_(struct eba *eba, unsigned long index,
+				     size_t *byte, unsigned char *offset)
+{
+	/* compiler does the right thing; no "div"s in the .s files */
+	*byte = index / CHAR_BIT;
+	*offset = index % CHAR_BIT;
+	eembed_assert((*byte) < eba->size_bytes);
+
+	if (eba->endian == eba_big_endian) {
+		*byte = (eba->size_bytes - 1) - (*byte);
+	}
+}
+
+#if (!(EBA_SKIP_TO_STRING))
+
+/* a 2k table of the characters for each byte value, most significant first */
+#ifndef EBA_TO_STRING_TABLE
+#if ((EEMBED_HOSTED) && (CHAR_BIT == 8))
+#define EBA_TO_STRING_TABLE 1
+#else
+#define EBA_TO_STRING_TABLE 0
+#endif
+#endif
+
+#ifndef Eba_string_chunk_size
+#define Eba_string_chunk_size 256
+#endif
+
+#if (EBA_TO_STRING_TABLE)
+#define Eba_bc_(n) { \
+	(char)('0' + (((n) >> 7) & 1)), (char)('0' + (((n) >> 6) & 1)), \
+	(char)('0' + (((n) >> 5) & 1)), (char)('0' + (((n) >> 4) & 1)), \
+	(char)('0' + (((n) >> 3) & 1)), (char)('0' + (((n) >> 2) & 1)), \
+	(char)('0' + (((n) >> 1) & 1)), (char)('0' + ((n) & 1)) }
+#define Eba_bc4_(n) \
+	Eba_bc_(n), Eba_bc_((n) + 1), Eba_bc_((n) + 2), Eba_bc_((n) + 3)
+#define Eba_bc16_(n) \
+	Eba_bc4_(n), Eba_bc4_((n) + 4), Eba_bc4_((n) + 8), Eba_bc4_((n) + 12)
+#define Eba_bc64_(n) \
+	Eba_bc16_(n), Eba_bc16_((n) + 16), Eba_bc16_((n) + 32), \
+	Eba_bc16_((n) + 48)
+
+static const char eba_byte_chars_[256][8] = {
+	Eba_bc64_(0), Eba_bc64_(64), Eba_bc64_(128), Eba_bc64_(192)
+};
+
+#undef Eba_bc64_
+#undef Eba_bc16_
+#undef Eba_bc4_
+#undef Eba_bc_
+#endif /* EBA_TO_STRING_TABLE */
+
+/* collects output either into a caller's buffer, or into a chunk which
+ * is handed to the writer each time it fills */
+struct eba_string_out_ {
+	char *buf;
+	size_t size;
+	size_t pos;
+	eba_string_writer writer;
+	void *context;
+	int stop;
+};
+
+static void eba_string_flush_(struct eba_string_out_ *out)
+{
+	if (out->writer && out->pos && !out->stop) {
+		if (out->writer(out->context, out->buf, out->pos)) {
+			out->stop = 1;
+		}
+		out->pos = 0;
+	}
+}
+
+static void eba_string_put_(struct eba_string_out_ *out, const char *str,
+			    size_t len)
+{
+	size_t i = 0;
+	size_t avail = 0;
+
+	while (len && !out->stop) {
+		if (out->pos == out->size) {
+			if (!out->writer) {
+				out->stop = 1;
+				return;
+			}
+			eba_string_flush_(out);
+			continue;
+		}
+		avail = out->size - out->pos;
+		if (avail > len) {
+			avail = len;
+		}
+		for (i = 0; i < avail; ++i) {
+			out->buf[out->pos + i] = str[i];
+		}
+		out->pos += avail;
+		str += avail;
+		len -= avail;
+	}
+}
+
+/* the characters of a byte, in the order that they are printed */
+static void eba_byte_to_chars_(unsigned char byte, enum eba_endian endian,
+			       char *chars)
+{
+	size_t i = 0;
+#if (EBA_TO_STRING_TABLE)
+	const char *row = eba_byte_chars_[byte];
+
+	if (endian == eba_big_endian) {
+		for (i = 0; i < 8; ++i) {
+			chars[i] = row[i];
+		}
+	} else {
+		for (i = 0; i < 8; ++i) {
+			chars[i] = row[7 - i];
+		}
+	}
+#else
+	for (i = 0; i < CHAR_BIT; ++i) {
+		unsigned bit = (endian == eba_big_endian)
+		    ? ((CHAR_BIT - 1) - i) : i;
+		chars[i] = ((byte >> bit) & 0x01) ? '1' : '0';
+	}
+#endif
+}
+
+static void eba_string_binary_(struct eba *eba, struct eba_string_out_ *out)
+{
+	size_t i = 0;
+	char chars[1 + CHAR_BIT];
+
+	chars[0] = ' ';
+	for (i = 0; i < eba->size_bytes && !out->stop; ++i) {
+		eba_byte_to_chars_(eba->bits[i], eba->endian, chars + 1);
+		if (i) {
+			eba_string_put_(out, chars, 1 + CHAR_BIT);
+		} else {
+			eba_string_put_(out, chars + 1, CHAR_BIT);
+		}
+	}
+}
+
+static void eba_string_hex_(struct eba *eba, struct eba_string_out_ *out)
+{
+	const char *hex = "0123456789abcdef";
+	size_t i = 0;
+	size_t j = 0;
+	size_t digits = (CHAR_BIT + 3) / 4;
+	char chars[(CHAR_BIT + 3) / 4];
+
+	for (i = 0; i < eba->size_bytes && !out->stop; ++i) {
+		unsigned byte = eba->bits[i];
+		for (j = 0; j < digits; ++j) {
+			chars[(digits - 1) - j] = hex[byte & 0x0F];
+			byte = byte >> 4;
+		}
+		eba_string_put_(out, chars, digits);
+	}
+}
+
+static void eba_string_run_(struct eba_string_out_ *out, char c,
+			    unsigned long count, int first)
+{
+	char num[1 + 1 + 1 + (sizeof(unsigned long) * CHAR_BIT)];
+	size_t pos = sizeof(num);
+
+	do {
+		num[--pos] = (char)('0' + (count % 10));
+		count = count / 10;
+	} while (count);
+	num[--pos] = '*';
+	num[--pos] = c;
+	if (!first) {
+		num[--pos] = ' ';
+	}
+	eba_string_put_(out, num + pos, sizeof(num) - pos);
+}
+
+static void eba_string_runs_(struct eba *eba, struct eba_string_out_ *out)
+{
+	size_t i = 0;
+	size_t j = 0;
+	char c = '0';
+	unsigned long count = 0;
+	int first = 1;
+	char chars[CHAR_BIT];
+
+	for (i = 0; i < eba->size_bytes && !out->stop; ++i) {
+		unsigned char byte = eba->bits[i];
+		char all = 0;
+
+		if (byte == 0x00) {
+			all = '0';
+		} else if (byte == UCHAR_MAX) {
+			all = '1';
+		}
+		if (all && (all == c || !count)) {
+			c = all;
+			count += CHAR_BIT;
+			continue;
+		}
+		eba_byte_to_chars_(byte, eba->endian, chars);
+		for (j = 0; j < CHAR_BIT; ++j) {
+			if (count && chars[j] != c) {
+				eba_string_run_(out, c, count, first);
+				first = 0;
+				count = 0;
+			}
+			c = chars[j];
+			++count;
+		}
+	}
+	if (count) {
+		eba_string_run_(out, c, count, first);
+	}
+}
+
+static void eba_string_format_(struct eba *eba, enum eba_string_format format,
+			       struct eba_string_out_ *out)
+{
+	switch (format) {
+	case eba_string_hex:
+		eba_string_hex_(eba, out);
+		break;
+	case eba_string_runs:
+		eba_string_runs_(eba, out);
+		break;
+	case eba_string_binary:
+	default:
+		eba_string_binary_(eba, out);
+		break;
+	}
+}
+
+char *eba_to_string_format(struct eba *eba, enum eba_string_format format,
+			   char *buf, size_t len)
+{
+	struct eba_string_out_ out;
+
+	if (!buf) {
+		return NULL;
+	}
+	if (len < 2) {
+		return NULL;
+	}
+	buf[0] = '\0';
+	if (!eba || !eba->bits) {
+		return buf;
+	}
+
+	out.buf = buf;
+	out.size = len - 1;
+	out.pos = 0;
+	out.writer = NULL;
+	out.context = NULL;
+	out.stop = 0;
+
+	eba_string_format_(eba, format, &out);
+
+	if (!out.stop) {
+		buf[out.pos] = '\0';
+		return buf;
+	}
+
+	buf[len - 2] = '!';
+	buf[len - 1] = '\0';
+	return buf;
+}
+
+char *eba_to_string(struct eba *eba, char *buf, size_t len)
+{
+	return eba_to_string_format(eba, eba_string_binary, buf, len);
+}
+
+int eba_to_string_stream(struct eba *eba, enum eba_string_format format,
+			 eba_string_writer writer, void *context)
+{
+	struct eba_string_out_ out;
+	char chunk[Eba_string_chunk_size];
+
+	if (!writer) {
+		return 1;
+	}
+	if (!eba || !eba->bits) {
+		return 0;
+	}
+
+	out.buf = chunk;
+	out.size = Eba_string_chunk_size;
+	out.pos = 0;
+	out.writer = writer;
+	out.context = context;
+	out.stop = 0;
+
+	eba_string_format_(eba, format, &out);
+	eba_string_flush_(&out);
+
+	return out.stop;
+}
+#endif /* EBA_SKIP_TO_STRING */
+
+#if (!(EBA_SKIP_FROM_STRING))
+
+/* eight '0' or '1' chars can be checked and packed with a few word ops */
+#ifndef EBA_FROM_STRING_SWAR
+#if ((CHAR_BIT == 8) && (ULONG_MAX > 0xFFFFFFFFUL))
+#define EBA_FROM_STRING_SWAR 1
+#else
+#define EBA_FROM_STRING_SWAR 0
+#endif
+#endif
+
+#if (EBA_FROM_STRING_SWAR)
+static int eba_swar_binary_byte_(const char *str, enum eba_endian endian,
+				 unsigned char *byte)
+{
+	unsigned long word = 0;
+	size_t i = 0;
+
+	for (i = 0; i < 8; ++i) {
+		word |= ((unsigned long)((unsigned char)str[i])) << (8 * i);
+	}
+
+	/* each byte of the word becomes 0x00 or 0x01 if it was a '0' or '1' */
+	word ^= 0x3030303030303030UL;
+	if (word & 0xFEFEFEFEFEFEFEFEUL) {
+		return 0;
+	}
+
+	/* gather the low bit of each byte into the top byte */
+	if (endian == eba_big_endian) {
+		word = (word * 0x8040201008040201UL) >> 56;
+	} else {
+		word = (word * 0x0102040810204080UL) >> 56;
+	}
+	*byte = (unsigned char)word;
+	return 1;
+}
+#endif
+
+static int eba_from_string_error_(size_t pos, size_t *error_pos)
+{
+	if (error_pos) {
+		*error_pos = pos;
+	}
+	return 1;
+}
+
+static int eba_from_string_binary_(struct eba *eba, const char *str,
+				   size_t len, size_t *error_pos)
+{
+	size_t pos = 0;
+	size_t byte_i = 0;
+	unsigned nbits = 0;
+	unsigned char cur = 0;
+
+#if (EBA_FROM_STRING_SWAR)
+	/* the fast path reads eight chars at once, thus it must not be
+	 * given a len which reaches past the '\0' */
+	while (pos < len && str[pos]) {
+		++pos;
+	}
+	len = pos;
+	pos = 0;
+#endif
+
+	while (pos < len && str[pos]) {
+#if (EBA_FROM_STRING_SWAR)
+		if (nbits == 0 && byte_i < eba->size_bytes && (len - pos) >= 8
+		    && eba_swar_binary_byte_(str + pos, eba->endian, &cur)) {
+			eba->bits[byte_i++] = cur;
+			cur = 0;
+			pos += 8;
+			continue;
+		}
+#endif
+		if (str[pos] == ' ') {
+			++pos;
+			continue;
+		}
+		if ((str[pos] != '0' && str[pos] != '1')
+		    || (byte_i >= eba->size_bytes)) {
+			return eba_from_string_error_(pos, error_pos);
+		}
+		if (str[pos] == '1') {
+			if (eba->endian == eba_big_endian) {
+				cur |= (1U << ((CHAR_BIT - 1) - nbits));
+			} else {
+				cur |= (1U << nbits);
+			}
+		}
+		if (++nbits == CHAR_BIT) {
+			eba->bits[byte_i++] = cur;
+			cur = 0;
+			nbits = 0;
+		}
+		++pos;
+	}
+
+	if (nbits || byte_i != eba->size_bytes) {
+		return eba_from_string_error_(pos, error_pos);
+	}
+	return 0;
+}
+
+static int eba_hex_digit_(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return 10 + (c - 'a');
+	}
+	if (c >= 'A' && c <= 'F') {
+		return 10 + (c - 'A');
+	}
+	return -1;
+}
+
+static int eba_from_string_hex_(struct eba *eba, const char *str, size_t len,
+				size_t *error_pos)
+{
+	size_t pos = 0;
+	size_t byte_i = 0;
+	unsigned ndigits = 0;
+	unsigned cur = 0;
+	unsigned digits = (CHAR_BIT + 3) / 4;
+	int val = 0;
+
+	while (pos < len && str[pos]) {
+		if (str[pos] == ' ') {
+			++pos;
+			continue;
+		}
+		val = eba_hex_digit_(str[pos]);
+		if (val < 0 || byte_i >= eba->size_bytes) {
+			return eba_from_string_error_(pos, error_pos);
+		}
+		cur = (cur << 4) | (unsigned)val;
+		if (++ndigits == digits) {
+			eba->bits[byte_i++] = (unsigned char)cur;
+			cur = 0;
+			ndigits = 0;
+		}
+		++pos;
+	}
+
+	if (ndigits || byte_i != eba->size_bytes) {
+		return eba_from_string_error_(pos, error_pos);
+	}
+	return 0;
+}
+
+/* set the bit which is printed at char position "i" of the binary format */
+static void eba_set_printed_bit_(struct eba *eba, unsigned long i,
+				 unsigned char val)
+{
+	size_t byte = i / CHAR_BIT;
+	unsigned offset = i % CHAR_BIT;
+
+	if (eba->endian == eba_big_endian) {
+		offset = (CHAR_BIT - 1) - offset;
+	}
+	eba->bits[byte] = eba_set_byte_bit(eba->bits[byte], offset, val);
+}
+
+static int eba_from_string_runs_(struct eba *eba, const char *str,
+				 size_t len, size_t *error_pos)
+{
+	size_t pos = 0;
+	size_t start = 0;
+	unsigned long size_bits = eba->size_bytes * CHAR_BIT;
+	unsigned long done = 0;
+	unsigned long count = 0;
+	unsigned long i = 0;
+	unsigned char val = 0;
+
+	while (pos < len && str[pos]) {
+		if (str[pos] == ' ') {
+			++pos;
+			continue;
+		}
+		if ((str[pos] != '0' && str[pos] != '1')
+		    || ((pos + 1) >= len) || (str[pos + 1] != '*')) {
+			return eba_from_string_error_(pos, error_pos);
+		}
+		val = (str[pos] == '1') ? 1 : 0;
+		pos += 2;
+
+		start = pos;
+		count = 0;
+		while (pos < len && str[pos] >= '0' && str[pos] <= '9') {
+			if (count > ((size_bits - done) / 10)) {
+				return eba_from_string_error_(start, error_pos);
+			}
+			count = (count * 10) + (unsigned long)(str[pos] - '0');
+			++pos;
+		}
+		if (pos == start || count > (size_bits - done)) {
+			return eba_from_string_error_(start, error_pos);
+		}
+
+		/* whole bytes are a simple fill, the edges are bit by bit */
+		for (i = 0; i < count && ((done + i) % CHAR_BIT); ++i) {
+			eba_set_printed_bit_(eba, done + i, val);
+		}
+		if ((count - i) >= CHAR_BIT) {
+			size_t nbytes = (count - i) / CHAR_BIT;
+			eembed_memset(eba->bits + ((done + i) / CHAR_BIT),
+				      val ? 0xFF : 0x00, nbytes);
+			i += nbytes * CHAR_BIT;
+		}
+		for (; i < count; ++i) {
+			eba_set_printed_bit_(eba, done + i, val);
+		}
+		done += count;
+	}
+
+	if (done != size_bits) {
+		return eba_from_string_error_(pos, error_pos);
+	}
+	return 0;
+}
+
+int eba_from_string_format(struct eba *eba, enum eba_string_format format,
+			   const char *str, size_t len, size_t *error_pos)
+{
+	if (!eba || !eba->bits || !str) {
+		return eba_from_string_error_(0, error_pos);
+	}
+
+	switch (format) {
+	case eba_string_hex:
+		return eba_from_string_hex_(eba, str, len, error_pos);
+	case eba_string_runs:
+		return eba_from_string_runs_(eba, str, len, error_pos);
+	case eba_string_binary:
+	default:
+		return eba_from_string_binary_(eba, str, len, error_pos);
+	}
+}
+
+int eba_from_string(struct eba *eba, const char *str, size_t len,
+		    size_t *error_pos)
+{
+	return eba_from_string_format(eba, eba_string_binary, str, len,
+				      error_pos);
+}
+#endif /* EBA_SKIP_FROM_STRING */
+
+#if (!(EBA_SKIP_SIMILARITY))
+
+unsigned long eba_hamming_distance(struct eba *a, struct eba *b)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+
+	eba_count_pair_(a, b, eba_count_xor_, &count, &unused);
+	return count;
+}
+
+unsigned long eba_count_and(struct eba *a, struct eba *b)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+
+	eba_count_pair_(a, b, eba_count_and_, &count, &unused);
+	return count;
+}
+
+unsigned long eba_count_or(struct eba *a, struct eba *b)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+
+	eba_count_pair_(a, b, eba_count_or_, &count, &unused);
+	return count;
+}
+
+void eba_count_and_or(struct eba *a, struct eba *b, unsigned long *and_count,
+		      unsigned long *or_count)
+{
+	unsigned long c_and = 0;
+	unsigned long c_or = 0;
+
+	eba_count_pair_(a, b, eba_count_and_or_, &c_and, &c_or);
+	if (and_count) {
+		*and_count = c_and;
+	}
+	if (or_count) {
+		*or_count = c_or;
+	}
+}
+
+double eba_jaccard(struct eba *a, struct eba *b)
+{
+	unsigned long c_and = 0;
+	unsigned long c_or = 0;
+
+	eba_count_pair_(a, b, eba_count_and_or_, &c_and, &c_or);
+	if (!c_or) {
+		return 1.0;
+	}
+	return ((double)c_and) / ((double)c_or);
+}
+#endif /* EBA_SKIP_SIMILARITY */
+
+#if (!(EBA_SKIP_MATRIX))
+
+#ifndef EBA_MATRIX_PREFETCH_ROWS
+#define EBA_MATRIX_PREFETCH_ROWS 4
+#endif
+
+/* the early exit is checked between blocks of this many bytes, which are
+ * each counted by the kernel for the instruction set */
+#define Eba_matrix_block_bytes 256
+
+/* popcount(a ^ b) but gives up, returning a value larger than the bound,
+ * once the bound has been exceeded */
+static unsigned long eba_xor_count_bounded_(const unsigned char *a,
+					    const unsigned char *b,
+					    size_t len, unsigned long bound)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+	size_t i = 0;
+	size_t block = 0;
+
+	for (i = 0; i < len; i += block) {
+		block = eba_min_(len - i, Eba_matrix_block_bytes);
+		eba_count_bytes_(a + i, b + i, block, eba_count_xor_, &count,
+				 &unused);
+		if (count > bound) {
+			return count;
+		}
+	}
+	return count;
+}
+
+struct eba *eba_matrix_row(struct eba_matrix *matrix, size_t row,
+			   struct eba *view)
+{
+	eembed_assert(matrix);
+	eembed_assert(view);
+	eembed_assert(row < matrix->rows);
+
+	view->bits = matrix->bits + (row * matrix->row_bytes);
+	view->size_bytes = matrix->row_bytes;
+	view->endian = matrix->endian;
+	return view;
+}
+
+static unsigned long eba_matrix_distance_(struct eba_matrix *matrix,
+					  size_t row, struct eba *query,
+					  int direct, unsigned long bound)
+{
+	struct eba view;
+	const unsigned char *bits = NULL;
+	unsigned long distance = 0;
+	unsigned long unused = 0;
+
+	if (direct) {
+		bits = matrix->bits + (row * matrix->row_bytes);
+		return eba_xor_count_bounded_(query->bits, bits,
+					      matrix->row_bytes, bound);
+	}
+	eba_matrix_row(matrix, row, &view);
+	eba_count_pair_(query, &view, eba_count_xor_, &distance, &unused);
+	return distance;
+}
+
+/* can the query be compared to rows byte for byte? */
+static int eba_matrix_direct_(struct eba_matrix *matrix, struct eba *query)
+{
+	return (query->size_bytes == matrix->row_bytes)
+	    && (query->endian == matrix->endian);
+}
+
+/* insert into a list sorted by distance, then by row; keeps at most k */
+static size_t eba_match_insert_(struct eba_match *matches, size_t found,
+				size_t k, size_t row, unsigned long distance)
+{
+	size_t i = 0;
+
+	if (found == k) {
+		if (!k || !(distance < matches[k - 1].distance
+			    || (distance == matches[k - 1].distance
+				&& row < matches[k - 1].row))) {
+			return found;
+		}
+		--found;
+	}
+	for (i = found; i > 0; --i) {
+		if (matches[i - 1].distance < distance
+		    || (matches[i - 1].distance == distance
+			&& matches[i - 1].row < row)) {
+			break;
+		}
+		matches[i] = matches[i - 1];
+	}
+	matches[i].row = row;
+	matches[i].distance = distance;
+	return found + 1;
+}
+
+size_t eba_matrix_nearest_rows(struct eba_matrix *matrix, struct eba *query,
+			       size_t row_begin, size_t row_end,
+			       struct eba_match *matches, size_t found,
+			       size_t k)
+{
+	size_t row = 0;
+	size_t prefetch = 0;
+	unsigned long distance = 0;
+	unsigned long bound = 0;
+	int direct = 0;
+
+	eembed_assert(matrix);
+	eba_assert_not_null_(query);
+	eembed_assert(matches || !k);
+	eembed_assert(found <= k);
+
+	if (row_end > matrix->rows) {
+		row_end = matrix->rows;
+	}
+	direct = eba_matrix_direct_(matrix, query);
+	bound = (found == k && k) ? matches[k - 1].distance : ULONG_MAX;
+
+	for (row = row_begin; row < row_end; ++row) {
+		prefetch = row + EBA_MATRIX_PREFETCH_ROWS;
+		if (prefetch < row_end) {
+			Eba_prefetch_(matrix->bits
+				      + (prefetch * matrix->row_bytes));
+		}
+		distance = eba_matrix_distance_(matrix, row, query, direct,
+						bound);
+		if (distance <= bound) {
+			found = eba_match_insert_(matches, found, k, row,
+						  distance);
+			if (found == k && k) {
+				bound = matches[k - 1].distance;
+			}
+		}
+	}
+	return found;
+}
+
+size_t eba_matrix_nearest(struct eba_matrix *matrix, struct eba *query,
+			  struct eba_match *matches, size_t k)
+{
+	return eba_matrix_nearest_rows(matrix, query, 0, matrix->rows,
+				       matches, 0, k);
+}
+
+size_t eba_matrix_merge_nearest(struct eba_match *matches, size_t found,
+				size_t k, const struct eba_match *more,
+				size_t more_found)
+{
+	size_t i = 0;
+
+	for (i = 0; i < more_found; ++i) {
+		found = eba_match_insert_(matches, found, k, more[i].row,
+					  more[i].distance);
+	}
+	return found;
+}
+
+size_t eba_matrix_within_rows(struct eba_matrix *matrix, struct eba *query,
+			      size_t row_begin, size_t row_end,
+			      unsigned long max_distance,
+			      struct eba_match *matches, size_t capacity)
+{
+	size_t row = 0;
+	size_t prefetch = 0;
+	size_t found = 0;
+	unsigned long distance = 0;
+	int direct = 0;
+
+	eembed_assert(matrix);
+	eba_assert_not_null_(query);
+	eembed_assert(matches || !capacity);
+
+	if (row_end > matrix->rows) {
+		row_end = matrix->rows;
+	}
+	direct = eba_matrix_direct_(matrix, query);
+
+	for (row = row_begin; row < row_end; ++row) {
+		prefetch = row + EBA_MATRIX_PREFETCH_ROWS;
+		if (prefetch < row_end) {
+			Eba_prefetch_(matrix->bits
+				      + (prefetch * matrix->row_bytes));
+		}
+		distance = eba_matrix_distance_(matrix, row, query, direct,
+						max_distance);
+		if (distance <= max_distance) {
+			if (found < capacity) {
+				matches[found].row = row;
+				matches[found].distance = distance;
+			}
+			++found;
+		}
+	}
+	return found;
+}
+
+size_t eba_matrix_within(struct eba_matrix *matrix, struct eba *query,
+			 unsigned long max_distance, struct eba_match *matches,
+			 size_t capacity)
+{
+	return eba_matrix_within_rows(matrix, query, 0, matrix->rows,
+				      max_distance, matches, capacity);
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba_matrix *eba_matrix_new(size_t rows, unsigned long bits_per_row,
+				  enum eba_endian endian)
+{
+	struct eba_matrix *matrix = NULL;
+	unsigned char *bytes = NULL;
+	size_t header_size = 0;
+	size_t row_bytes = 0;
+	size_t len = 0;
+
+	row_bytes = bits_per_row / CHAR_BIT;
+	if ((row_bytes * CHAR_BIT) < bits_per_row) {
+		row_bytes += 1;
+	}
+	if (!rows || !row_bytes || (rows > (((size_t)-1) / row_bytes))) {
+		return NULL;
+	}
+
+	header_size = eembed_align(sizeof(struct eba_matrix));
+	len = header_size + (rows * row_bytes);
+	if (len < header_size) {
+		return NULL;
+	}
+	bytes = (unsigned char *)eembed_malloc(len);
+	if (!bytes) {
+		return NULL;
+	}
+
+	matrix = (struct eba_matrix *)bytes;
+	matrix->bits = bytes + header_size;
+	matrix->row_bytes = row_bytes;
+	matrix->rows = rows;
+	matrix->endian = endian;
+	eembed_memset(matrix->bits, 0x00, rows * row_bytes);
+
+	return matrix;
+}
+
+void eba_matrix_free(struct eba_matrix *matrix)
+{
+	eembed_free(matrix);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+#undef Eba_matrix_block_bytes
+#endif /* EBA_SKIP_MATRIX */
+
+#if (!(EBA_SKIP_BLOOM))
+
+#ifndef EBA_BLOOM_PREFETCH_DISTANCE
+#define EBA_BLOOM_PREFETCH_DISTANCE 8
+#endif
+
+#define Eba_bloom_block_bytes 64
+#define Eba_bloom_block_bits (Eba_bloom_block_bytes * 8)
+#define Eba_mask32 0xFFFFFFFFUL
+
+/* Where unsigned long has 64 bits, the hashes do too, so that the probes
+ * of a filter of more than 2^32 bits reach all of it. */
+#if (ULONG_MAX > 0xFFFFFFFFUL)
+#define Eba_bloom_hash64_ 1
+#else
+#define Eba_bloom_hash64_ 0
+#endif
+
+/* the murmur3 finalizer, to spread the bits of a hash */
+static unsigned long eba_bloom_mix_(unsigned long h)
+{
+#if (Eba_bloom_hash64_)
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDUL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53UL;
+	h ^= h >> 33;
+#else
+	h &= Eba_mask32;
+	h ^= h >> 16;
+	h = (h * 0x85EBCA6BUL) & Eba_mask32;
+	h ^= h >> 13;
+	h = (h * 0xC2B2AE35UL) & Eba_mask32;
+	h ^= h >> 16;
+#endif
+	return h;
+}
+
+unsigned long eba_bloom_hash(const void *key, size_t len)
+{
+	const unsigned char *bytes = (const unsigned char *)key;
+	size_t i = 0;
+#if (Eba_bloom_hash64_)
+	unsigned long h = 0xCBF29CE484222325UL;
+
+	/* FNV-1a, 64 bit */
+	for (i = 0; i < len; ++i) {
+		h ^= bytes[i];
+		h *= 0x100000001B3UL;
+	}
+#else
+	unsigned long h = 2166136261UL;
+
+	/* FNV-1a, 32 bit */
+	for (i = 0; i < len; ++i) {
+		h ^= bytes[i];
+		h = (h * 16777619UL) & Eba_mask32;
+	}
+#endif
+	return h;
+}
+
+/* the two hashes for double hashing, derived from the one key hash */
+static void eba_bloom_hashes_(unsigned long hash, unsigned long *h1,
+			      unsigned long *h2)
+{
+	*h1 = eba_bloom_mix_(hash);
+	*h2 = eba_bloom_mix_((*h1) ^ 0x9E3779B9UL) | 1;
+}
+
+/* the byte which the first probe of the key will touch */
+static unsigned char *eba_bloom_first_byte_(struct eba_bloom *bloom,
+					    unsigned long h1)
+{
+	unsigned long size_bits = bloom->eba.size_bytes * 8;
+	size_t blocks = bloom->eba.size_bytes / Eba_bloom_block_bytes;
+	size_t block = 0;
+
+	if (bloom->layout == eba_bloom_blocked) {
+		block = h1 % blocks;
+		return bloom->eba.bits + (block * Eba_bloom_block_bytes);
+	}
+	return bloom->eba.bits + ((h1 % size_bits) / 8);
+}
+
+static void eba_bloom_prefetch_(struct eba_bloom *bloom, unsigned long hash)
+{
+	unsigned long h1 = 0;
+	unsigned long h2 = 0;
+	unsigned long pos = 0;
+	unsigned long step = 0;
+	unsigned long size_bits = bloom->eba.size_bytes * 8;
+	unsigned i = 0;
+
+	eba_bloom_hashes_(hash, &h1, &h2);
+	if (bloom->layout == eba_bloom_blocked) {
+		Eba_prefetch_(eba_bloom_first_byte_(bloom, h1));
+		return;
+	}
+	pos = h1 % size_bits;
+	step = h2 % size_bits;
+	for (i = 0; i < bloom->k; ++i) {
+		Eba_prefetch_(bloom->eba.bits + (pos / 8));
+		pos += step;
+		if (pos >= size_bits) {
+			pos -= size_bits;
+		}
+	}
+}
+
+/* sets (if "set" is non-zero) or tests the k bits of a key,
+ * returns 1 if all k bits were already set */
+static unsigned char eba_bloom_probe_(struct eba_bloom *bloom,
+				      unsigned long hash, int set)
+{
+	unsigned long h1 = 0;
+	unsigned long h2 = 0;
+	unsigned long pos = 0;
+	unsigned long step = 0;
+	unsigned long size_bits = 0;
+	unsigned char *bytes = NULL;
+	unsigned char all = 1;
+	unsigned char mask = 0;
+	unsigned i = 0;
+
+	eba_bloom_hashes_(hash, &h1, &h2);
+
+	if (bloom->layout == eba_bloom_blocked) {
+		/* every probe lands in the same 64 byte block */
+		bytes = eba_bloom_first_byte_(bloom, h1);
+		size_bits = Eba_bloom_block_bits;
+		pos = h2 % size_bits;
+		step = ((h2 >> 9) | 1) % size_bits;
+	} else {
+		bytes = bloom->eba.bits;
+		size_bits = bloom->eba.size_bytes * 8;
+		pos = h1 % size_bits;
+		step = h2 % size_bits;
+	}
+
+	for (i = 0; i < bloom->k; ++i) {
+		mask = (unsigned char)(1U << (pos % 8));
+		if (!(bytes[pos / 8] & mask)) {
+			if (!set) {
+				return 0;
+			}
+			all = 0;
+			bytes[pos / 8] |= mask;
+		}
+		pos += step;
+		if (pos >= size_bits) {
+			pos -= size_bits;
+		}
+	}
+	return all;
+}
+
+int eba_bloom_init(struct eba_bloom *bloom, unsigned char *bits,
+		   size_t size_bytes, unsigned k,
+		   enum eba_bloom_layout layout)
+{
+	eembed_assert(CHAR_BIT == 8);
+
+	if (!bloom || !bits || !size_bytes || !k) {
+		return 1;
+	}
+	/* the probe positions are unsigned long bit indexes */
+	if (size_bytes > (ULONG_MAX / 8)) {
+		return 1;
+	}
+	if (layout == eba_bloom_blocked
+	    && (size_bytes % Eba_bloom_block_bytes)) {
+		return 1;
+	}
+
+	bloom->eba.bits = bits;
+	bloom->eba.size_bytes = size_bytes;
+	/* fixed, so that the bytes are portable */
+	bloom->eba.endian = eba_endian_little;
+	bloom->k = k;
+	bloom->layout = layout;
+	return 0;
+}
+
+void eba_bloom_add(struct eba_bloom *bloom, unsigned long hash)
+{
+	eembed_assert(bloom);
+	eba_bloom_probe_(bloom, hash, 1);
+}
+
+unsigned char eba_bloom_contains(struct eba_bloom *bloom, unsigned long hash)
+{
+	eembed_assert(bloom);
+	return eba_bloom_probe_(bloom, hash, 0);
+}
+
+void eba_bloom_add_batch(struct eba_bloom *bloom, const unsigned long *hashes,
+			 size_t n)
+{
+	size_t i = 0;
+	size_t ahead = 0;
+
+	eembed_assert(bloom);
+	eembed_assert(hashes || !n);
+
+	for (i = 0; i < n && i < EBA_BLOOM_PREFETCH_DISTANCE; ++i) {
+		eba_bloom_prefetch_(bloom, hashes[i]);
+	}
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_BLOOM_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			eba_bloom_prefetch_(bloom, hashes[ahead]);
+		}
+		eba_bloom_probe_(bloom, hashes[i], 1);
+	}
+}
+
+size_t eba_bloom_contains_batch(struct eba_bloom *bloom,
+				const unsigned long *hashes, size_t n,
+				unsigned char *results)
+{
+	size_t i = 0;
+	size_t ahead = 0;
+	size_t found = 0;
+	unsigned char result = 0;
+
+	eembed_assert(bloom);
+	eembed_assert(hashes || !n);
+
+	for (i = 0; i < n && i < EBA_BLOOM_PREFETCH_DISTANCE; ++i) {
+		eba_bloom_prefetch_(bloom, hashes[i]);
+	}
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_BLOOM_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			eba_bloom_prefetch_(bloom, hashes[ahead]);
+		}
+		result = eba_bloom_probe_(bloom, hashes[i], 0);
+		if (results) {
+			results[i] = result;
+		}
+		found += result;
+	}
+	return found;
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba_bloom *eba_bloom_new(unsigned long num_bits, unsigned k,
+				enum eba_bloom_layout layout)
+{
+	struct eba_bloom *bloom = NULL;
+	unsigned char *bytes = NULL;
+	unsigned char *bits = NULL;
+	size_t header_size = 0;
+	size_t size_bytes = 0;
+	size_t round_to = 0;
+	size_t over = 0;
+
+	round_to = (layout == eba_bloom_blocked) ? Eba_bloom_block_bytes : 1;
+	size_bytes = num_bits / 8;
+	if ((size_bytes * 8) < num_bits) {
+		size_bytes += 1;
+	}
+	if (size_bytes % round_to) {
+		size_bytes += round_to - (size_bytes % round_to);
+	}
+	if (!size_bytes || !k) {
+		return NULL;
+	}
+
+	/* over-allocate so that bits may start on a cache line, otherwise
+	 * a block may straddle two lines */
+	header_size = eembed_align(sizeof(struct eba_bloom));
+	bytes = (unsigned char *)eembed_malloc(header_size + EBA_ALIGN_BYTES
+					       - 1 + size_bytes);
+	if (!bytes) {
+		return NULL;
+	}
+	bloom = (struct eba_bloom *)bytes;
+	bits = bytes + header_size;
+	over = ((size_t)bits) % EBA_ALIGN_BYTES;
+	if (over) {
+		bits += EBA_ALIGN_BYTES - over;
+	}
+	eba_bloom_init(bloom, bits, size_bytes, k, layout);
+	eembed_memset(bloom->eba.bits, 0x00, size_bytes);
+	return bloom;
+}
+
+void eba_bloom_free(struct eba_bloom *bloom)
+{
+	eembed_free(bloom);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+#undef Eba_bloom_hash64_
+#undef Eba_mask32
+#undef Eba_bloom_block_bits
+#undef Eba_bloom_block_bytes
+#endif /* EBA_SKIP_BLOOM */
+
+#if (!(EBA_SKIP_COUNTERS))
+
+#ifndef EBA_COUNTERS_PREFETCH_DISTANCE
+#define EBA_COUNTERS_PREFETCH_DISTANCE 8
+#endif
+
+int eba_counters_init(struct eba_counters *counters, unsigned char *bits,
+		      size_t size_bytes, unsigned bits_per_counter)
+{
+	if (!counters || !bits || !size_bytes) {
+		return 1;
+	}
+	if (bits_per_counter != 2 && bits_per_counter != 4
+	    && bits_per_counter != 8) {
+		return 1;
+	}
+
+	counters->eba.bits = bits;
+	counters->eba.size_bytes = size_bytes;
+	/* fixed, so that the bytes are portable */
+	counters->eba.endian = eba_endian_little;
+	counters->bits_per_counter = bits_per_counter;
+	counters->size = (size_bytes * CHAR_BIT) / bits_per_counter;
+	counters->max = (1U << bits_per_counter) - 1;
+	return 0;
+}
+
+unsigned eba_counters_get(struct eba_counters *counters, size_t i)
+{
+	unsigned nbits = counters->bits_per_counter;
+
+	eembed_assert(i < counters->size);
+	return (unsigned)eba_get_bits(&counters->eba, i * nbits, nbits);
+}
+
+void eba_counters_set(struct eba_counters *counters, size_t i, unsigned val)
+{
+	unsigned nbits = counters->bits_per_counter;
+
+	eembed_assert(i < counters->size);
+	if (val > counters->max) {
+		val = counters->max;
+	}
+	eba_set_bits(&counters->eba, i * nbits, nbits, val);
+}
+
+unsigned eba_counters_increment(struct eba_counters *counters, size_t i)
+{
+	unsigned val = eba_counters_get(counters, i);
+
+	if (val < counters->max) {
+		eba_counters_set(counters, i, ++val);
+	}
+	return val;
+}
+
+unsigned eba_counters_decrement(struct eba_counters *counters, size_t i)
+{
+	unsigned val = eba_counters_get(counters, i);
+
+	if (val > 0) {
+		eba_counters_set(counters, i, --val);
+	}
+	return val;
+}
+
+static void eba_counters_prefetch_(struct eba_counters *counters, size_t i)
+{
+	size_t byte = (i * counters->bits_per_counter) / CHAR_BIT;
+
+	Eba_prefetch_(counters->eba.bits + byte);
+}
+
+void eba_counters_increment_batch(struct eba_counters *counters,
+				  const size_t *indexes, size_t n)
+{
+	size_t i = 0;
+	size_t ahead = 0;
+
+	eembed_assert(counters);
+	eembed_assert(indexes || !n);
+
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_COUNTERS_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			eba_counters_prefetch_(counters, indexes[ahead]);
+		}
+		eba_counters_increment(counters, indexes[i]);
+	}
+}
+
+void eba_counters_decrement_batch(struct eba_counters *counters,
+				  const size_t *indexes, size_t n)
+{
+	size_t i = 0;
+	size_t ahead = 0;
+
+	eembed_assert(counters);
+	eembed_assert(indexes || !n);
+
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_COUNTERS_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			eba_counters_prefetch_(counters, indexes[ahead]);
+		}
+		eba_counters_decrement(counters, indexes[i]);
+	}
+}
+
+#if (!(EBA_SKIP_BLOOM))
+
+/* calls the function for each of the k counters of the key, stopping
+ * if the function returns non-zero */
+static int eba_counting_bloom_each_(struct eba_counting_bloom *bloom,
+				    unsigned long hash,
+				    int (*func)(struct eba_counters *counters,
+						size_t i, void *context),
+				    void *context)
+{
+	unsigned long h1 = 0;
+	unsigned long h2 = 0;
+	size_t pos = 0;
+	size_t step = 0;
+	size_t size = bloom->counters.size;
+	unsigned i = 0;
+
+	eba_bloom_hashes_(hash, &h1, &h2);
+	pos = h1 % size;
+	step = h2 % size;
+	for (i = 0; i < bloom->k; ++i) {
+		if (func(&bloom->counters, pos, context)) {
+			return 1;
+		}
+		pos += step;
+		if (pos >= size) {
+			pos -= size;
+		}
+	}
+	return 0;
+}
+
+static int eba_counting_bloom_min_(struct eba_counters *counters, size_t i,
+				   void *context)
+{
+	unsigned *min = (unsigned *)context;
+	unsigned val = eba_counters_get(counters, i);
+
+	if (val < *min) {
+		*min = val;
+	}
+	return (*min == 0);
+}
+
+static int eba_counting_bloom_inc_(struct eba_counters *counters, size_t i,
+				   void *context)
+{
+	(void)context;
+	eba_counters_increment(counters, i);
+	return 0;
+}
+
+static int eba_counting_bloom_dec_(struct eba_counters *counters, size_t i,
+				   void *context)
+{
+	(void)context;
+	/* a saturated counter no longer knows its count, leave it */
+	if (eba_counters_get(counters, i) < counters->max) {
+		eba_counters_decrement(counters, i);
+	}
+	return 0;
+}
+
+int eba_counting_bloom_init(struct eba_counting_bloom *bloom,
+			    unsigned char *bits, size_t size_bytes,
+			    unsigned bits_per_counter, unsigned k)
+{
+	if (!bloom || !k) {
+		return 1;
+	}
+	bloom->k = k;
+	return eba_counters_init(&bloom->counters, bits, size_bytes,
+				 bits_per_counter);
+}
+
+void eba_counting_bloom_add(struct eba_counting_bloom *bloom,
+			    unsigned long hash)
+{
+	eembed_assert(bloom);
+	eba_counting_bloom_each_(bloom, hash, eba_counting_bloom_inc_, NULL);
+}
+
+unsigned eba_counting_bloom_count(struct eba_counting_bloom *bloom,
+				  unsigned long hash)
+{
+	unsigned min = 0;
+
+	eembed_assert(bloom);
+	min = bloom->counters.max;
+	eba_counting_bloom_each_(bloom, hash, eba_counting_bloom_min_, &min);
+	return min;
+}
+
+unsigned char eba_counting_bloom_contains(struct eba_counting_bloom *bloom,
+					  unsigned long hash)
+{
+	return eba_counting_bloom_count(bloom, hash) ? 1 : 0;
+}
+
+int eba_counting_bloom_remove(struct eba_counting_bloom *bloom,
+			      unsigned long hash)
+{
+	if (!eba_counting_bloom_contains(bloom, hash)) {
+		return 1;
+	}
+	eba_counting_bloom_each_(bloom, hash, eba_counting_bloom_dec_, NULL);
+	return 0;
+}
+#endif /* (!(EBA_SKIP_BLOOM)) */
+
+#if (!(EBA_SKIP_NEW))
+struct eba_counters *eba_counters_new(size_t num_counters,
+				      unsigned bits_per_counter)
+{
+	struct eba_counters *counters = NULL;
+	unsigned char *bytes = NULL;
+	size_t header_size = 0;
+	size_t size_bytes = 0;
+
+	if (!bits_per_counter || bits_per_counter > CHAR_BIT) {
+		return NULL;
+	}
+	size_bytes = num_counters / (CHAR_BIT / bits_per_counter);
+	if ((size_bytes * (CHAR_BIT / bits_per_counter)) < num_counters) {
+		size_bytes += 1;
+	}
+
+	header_size = eembed_align(sizeof(struct eba_counters));
+	bytes = (unsigned char *)eembed_malloc(header_size + size_bytes);
+	if (!bytes) {
+		return NULL;
+	}
+	counters = (struct eba_counters *)bytes;
+	if (eba_counters_init(counters, bytes + header_size, size_bytes,
+			      bits_per_counter)) {
+		eembed_free(bytes);
+		return NULL;
+	}
+	eembed_memset(counters->eba.bits, 0x00, size_bytes);
+	return counters;
+}
+
+void eba_counters_free(struct eba_counters *counters)
+{
+	eembed_free(counters);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+#endif /* EBA_SKIP_COUNTERS */
+
+#if (!(EBA_SKIP_ALLOC))
+
+#define Eba_alloc_none ((size_t)-1)
+
+size_t eba_alloc_size_bytes(size_t slots)
+{
+	size_t words[EBA_ALLOC_MAX_LEVELS];
+	size_t total = 0;
+	unsigned levels = 0;
+	unsigned i = 0;
+
+	levels = eba_levels_layout_(slots, words, EBA_ALLOC_MAX_LEVELS);
+	for (i = 0; i < levels; ++i) {
+		total += words[i];
+	}
+	return total * sizeof(unsigned long);
+}
+
+static unsigned long eba_alloc_word_(struct eba_alloc *alloc, unsigned level,
+				     size_t w)
+{
+	return eba_load_ul_(alloc->level[level] + (w * sizeof(unsigned long)));
+}
+
+/* sets then clears bits of a word, and keeps the levels above in step */
+static void eba_alloc_update_(struct eba_alloc *alloc, unsigned level,
+			      size_t w, unsigned long set, unsigned long clear)
+{
+	unsigned long old = 0;
+	unsigned long word = 0;
+	unsigned long bit = 0;
+
+	eembed_assert(w < alloc->level_words[level]);
+
+	old = eba_alloc_word_(alloc, level, w);
+	word = (old | set) & ~clear;
+	eba_store_ul_(alloc->level[level] + (w * sizeof(unsigned long)), word);
+
+	if ((level + 1) == alloc->levels) {
+		return;
+	}
+	if ((old == ~0UL) == (word == ~0UL)) {
+		return;
+	}
+	bit = 1UL << (w % Eba_ul_bits);
+	if (word == ~0UL) {
+		eba_alloc_update_(alloc, level + 1, w / Eba_ul_bits, bit, 0);
+	} else {
+		eba_alloc_update_(alloc, level + 1, w / Eba_ul_bits, 0, bit);
+	}
+}
+
+/* the first clear bit of the level at or after pos, or Eba_alloc_none */
+static size_t eba_alloc_next_free_(struct eba_alloc *alloc, unsigned level,
+				   size_t pos)
+{
+	size_t w = pos / Eba_ul_bits;
+	unsigned long below = 0;
+	unsigned long word = 0;
+
+	if (w >= alloc->level_words[level]) {
+		return Eba_alloc_none;
+	}
+	below = (1UL << (pos % Eba_ul_bits)) - 1;
+	word = eba_alloc_word_(alloc, level, w) | below;
+	if (word != ~0UL) {
+		return (w * Eba_ul_bits) + eba_ctz_ul_(~word);
+	}
+	if ((level + 1) == alloc->levels) {
+		/* the top level is a single word */
+		return Eba_alloc_none;
+	}
+
+	/* the level above knows which of the following words has space */
+	w = eba_alloc_next_free_(alloc, level + 1, w + 1);
+	if (w == Eba_alloc_none) {
+		return Eba_alloc_none;
+	}
+	word = eba_alloc_word_(alloc, level, w);
+	eembed_assert(word != ~0UL);
+	return (w * Eba_ul_bits) + eba_ctz_ul_(~word);
+}
+
+/* the first used slot in [pos, end), or end */
+static size_t eba_alloc_next_used_(struct eba_alloc *alloc, size_t pos,
+				   size_t end)
+{
+	size_t w = 0;
+	unsigned long word = 0;
+	size_t found = 0;
+
+	while (pos < end) {
+		w = pos / Eba_ul_bits;
+		word = eba_alloc_word_(alloc, 0, w);
+		word &= ~((1UL << (pos % Eba_ul_bits)) - 1);
+		if (word) {
+			found = (w * Eba_ul_bits) + eba_ctz_ul_(word);
+			return found < end ? found : end;
+		}
+		pos = (w + 1) * Eba_ul_bits;
+	}
+	return end;
+}
+
+/* sets or clears the slots [first, first + n) a word at a time */
+static void eba_alloc_mark_(struct eba_alloc *alloc, size_t first, size_t n,
+			    unsigned char used)
+{
+	size_t end = first + n;
+	size_t w = 0;
+	size_t offset = 0;
+	size_t span = 0;
+	unsigned long mask = 0;
+
+	while (first < end) {
+		w = first / Eba_ul_bits;
+		offset = first % Eba_ul_bits;
+		span = Eba_ul_bits - offset;
+		if (span > (end - first)) {
+			span = end - first;
+		}
+		if (span == Eba_ul_bits) {
+			mask = ~0UL;
+		} else {
+			mask = ((1UL << span) - 1) << offset;
+		}
+		if (used) {
+			eba_alloc_update_(alloc, 0, w, mask, 0);
+		} else {
+			eba_alloc_update_(alloc, 0, w, 0, mask);
+		}
+		first += span;
+	}
+}
+
+int eba_alloc_init(struct eba_alloc *alloc, unsigned char *mem,
+		   size_t mem_len, size_t slots)
+{
+	size_t size_bytes = eba_alloc_size_bytes(slots);
+	size_t offset = 0;
+	size_t last = 0;
+	size_t tail = 0;
+	unsigned i = 0;
+
+	if (!alloc || !mem || !size_bytes || mem_len < size_bytes) {
+		return 1;
+	}
+
+	alloc->levels = eba_levels_layout_(slots, alloc->level_words,
+					   EBA_ALLOC_MAX_LEVELS);
+	for (i = 0; i < alloc->levels; ++i) {
+		alloc->level[i] = mem + offset;
+		offset += alloc->level_words[i] * sizeof(unsigned long);
+	}
+	for (; i < EBA_ALLOC_MAX_LEVELS; ++i) {
+		alloc->level[i] = NULL;
+		alloc->level_words[i] = 0;
+	}
+	eembed_memset(mem, 0x00, size_bytes);
+
+	alloc->used.bits = alloc->level[0];
+	alloc->used.size_bytes = alloc->level_words[0] * sizeof(unsigned long);
+	/* fixed, to match the word at a time access */
+	alloc->used.endian = eba_endian_little;
+	alloc->slots = slots;
+	alloc->in_use = 0;
+
+	/* the bits past the end of each level are never free */
+	for (i = 0; i < alloc->levels; ++i) {
+		tail = i ? alloc->level_words[i - 1] : slots;
+		if (tail % Eba_ul_bits) {
+			last = alloc->level_words[i] - 1;
+			eba_alloc_update_(alloc, i, last,
+					  ~((1UL << (tail % Eba_ul_bits)) - 1),
+					  0);
+		}
+	}
+	return 0;
+}
+
+int eba_alloc_slot(struct eba_alloc *alloc, size_t *slot)
+{
+	size_t found = 0;
+
+	eembed_assert(alloc);
+	eembed_assert(slot);
+
+	found = eba_alloc_next_free_(alloc, 0, 0);
+	if (found == Eba_alloc_none) {
+		return 1;
+	}
+	eembed_assert(found < alloc->slots);
+	eba_alloc_update_(alloc, 0, found / Eba_ul_bits,
+			  1UL << (found % Eba_ul_bits), 0);
+	++alloc->in_use;
+	*slot = found;
+	return 0;
+}
+
+int eba_alloc_slots(struct eba_alloc *alloc, size_t n, size_t *first)
+{
+	size_t start = 0;
+	size_t used = 0;
+
+	eembed_assert(alloc);
+	eembed_assert(first);
+
+	if (!n || n > (alloc->slots - alloc->in_use)) {
+		return 1;
+	}
+	while (1) {
+		start = eba_alloc_next_free_(alloc, 0, start);
+		if (start == Eba_alloc_none || n > (alloc->slots - start)) {
+			return 1;
+		}
+		used = eba_alloc_next_used_(alloc, start, start + n);
+		if (used == (start + n)) {
+			break;
+		}
+		start = used + 1;
+	}
+	eba_alloc_mark_(alloc, start, n, 1);
+	alloc->in_use += n;
+	*first = start;
+	return 0;
+}
+
+void eba_alloc_release(struct eba_alloc *alloc, size_t slot)
+{
+	eembed_assert(alloc);
+	eembed_assert(slot < alloc->slots);
+	eembed_assert(eba_alloc_in_use(alloc, slot));
+
+	eba_alloc_update_(alloc, 0, slot / Eba_ul_bits, 0,
+			  1UL << (slot % Eba_ul_bits));
+	--alloc->in_use;
+}
+
+void eba_alloc_release_slots(struct eba_alloc *alloc, size_t first, size_t n)
+{
+	eembed_assert(alloc);
+	eembed_assert(first <= alloc->slots);
+	eembed_assert(n <= (alloc->slots - first));
+	eembed_assert(n <= alloc->in_use);
+
+	eba_alloc_mark_(alloc, first, n, 0);
+	alloc->in_use -= n;
+}
+
+unsigned char eba_alloc_in_use(struct eba_alloc *alloc, size_t slot)
+{
+	eembed_assert(alloc);
+	eembed_assert(slot < alloc->slots);
+
+	return eba_get(&alloc->used, slot);
+}
+
+void eba_alloc_cache_init(struct eba_alloc_cache *cache,
+			  struct eba_alloc *alloc, eba_alloc_lock_func lock,
+			  eba_alloc_lock_func unlock, void *lock_context)
+{
+	eembed_assert(cache);
+	eembed_assert(alloc);
+
+	cache->alloc = alloc;
+	cache->lock = lock;
+	cache->unlock = unlock;
+	cache->lock_context = lock_context;
+	cache->count = 0;
+}
+
+static void eba_alloc_cache_lock_(struct eba_alloc_cache *cache)
+{
+	if (cache->lock) {
+		cache->lock(cache->lock_context);
+	}
+}
+
+static void eba_alloc_cache_unlock_(struct eba_alloc_cache *cache)
+{
+	if (cache->unlock) {
+		cache->unlock(cache->lock_context);
+	}
+}
+
+int eba_alloc_cache_slot(struct eba_alloc_cache *cache, size_t *slot)
+{
+	eembed_assert(cache);
+	eembed_assert(slot);
+
+	if (!cache->count) {
+		/* refill half, leaving room for releases */
+		eba_alloc_cache_lock_(cache);
+		while (cache->count < (EBA_ALLOC_CACHE_SIZE / 2)) {
+			if (eba_alloc_slot(cache->alloc,
+					   cache->slots + cache->count)) {
+				break;
+			}
+			++cache->count;
+		}
+		eba_alloc_cache_unlock_(cache);
+		if (!cache->count) {
+			return 1;
+		}
+	}
+	*slot = cache->slots[--cache->count];
+	return 0;
+}
+
+/* returns the oldest cached slots until only keep remain */
+static void eba_alloc_cache_drain_(struct eba_alloc_cache *cache,
+				   size_t keep)
+{
+	size_t i = 0;
+	size_t n = 0;
+
+	if (cache->count <= keep) {
+		return;
+	}
+	n = cache->count - keep;
+	eba_alloc_cache_lock_(cache);
+	for (i = 0; i < n; ++i) {
+		eba_alloc_release(cache->alloc, cache->slots[i]);
+	}
+	eba_alloc_cache_unlock_(cache);
+	eembed_memmove(cache->slots, cache->slots + n, keep * sizeof(size_t));
+	cache->count = keep;
+}
+
+void eba_alloc_cache_release(struct eba_alloc_cache *cache, size_t slot)
+{
+	eembed_assert(cache);
+
+	if (cache->count == EBA_ALLOC_CACHE_SIZE) {
+		eba_alloc_cache_drain_(cache, EBA_ALLOC_CACHE_SIZE / 2);
+	}
+	cache->slots[cache->count++] = slot;
+}
+
+void eba_alloc_cache_flush(struct eba_alloc_cache *cache)
+{
+	eembed_assert(cache);
+
+	eba_alloc_cache_drain_(cache, 0);
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba_alloc *eba_alloc_new(size_t slots)
+{
+	struct eba_alloc *alloc = NULL;
+	unsigned char *bytes = NULL;
+	size_t header_size = 0;
+	size_t size_bytes = 0;
+
+	size_bytes = eba_alloc_size_bytes(slots);
+	if (!size_bytes) {
+		return NULL;
+	}
+
+	header_size = eembed_align(sizeof(struct eba_alloc));
+	bytes = (unsigned char *)eembed_malloc(header_size + size_bytes);
+	if (!bytes) {
+		return NULL;
+	}
+	alloc = (struct eba_alloc *)bytes;
+	if (eba_alloc_init(alloc, bytes + header_size, size_bytes, slots)) {
+		eembed_free(bytes);
+		return NULL;
+	}
+	return alloc;
+}
+
+void eba_alloc_free(struct eba_alloc *alloc)
+{
+	eembed_free(alloc);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+#undef Eba_alloc_none
+#endif /* EBA_SKIP_ALLOC */
+
+#if (!(EBA_SKIP_SPARSE))
+
+#define Eba_sparse_none ((size_t)-1)
+
+static size_t eba_sparse_lines_(size_t size_bytes)
+{
+	return (size_bytes / EBA_SPARSE_LINE_BYTES)
+	    + ((size_bytes % EBA_SPARSE_LINE_BYTES) ? 1 : 0);
+}
+
+size_t eba_sparse_summary_bytes(size_t size_bytes)
+{
+	size_t words[EBA_SPARSE_MAX_LEVELS];
+	size_t total = 0;
+	unsigned levels = 0;
+	unsigned i = 0;
+
+	levels = eba_levels_layout_(eba_sparse_lines_(size_bytes), words,
+				    EBA_SPARSE_MAX_LEVELS);
+	for (i = 0; i < levels; ++i) {
+		total += words[i];
+	}
+	return total * sizeof(unsigned long);
+}
+
+static unsigned long eba_sparse_level_word_(struct eba_sparse *sparse,
+					    unsigned level, size_t w)
+{
+	return eba_load_ul_(sparse->level[level] + (w * sizeof(unsigned long)));
+}
+
+/* sets then clears bits of a summary word, and the levels above it */
+static void eba_sparse_update_(struct eba_sparse *sparse, unsigned level,
+			       size_t w, unsigned long set,
+			       unsigned long clear)
+{
+	unsigned long old = 0;
+	unsigned long word = 0;
+	unsigned long bit = 0;
+
+	eembed_assert(w < sparse->level_words[level]);
+
+	old = eba_sparse_level_word_(sparse, level, w);
+	word = (old | set) & ~clear;
+	eba_store_ul_(sparse->level[level] + (w * sizeof(unsigned long)), word);
+
+	if ((level + 1) == sparse->levels) {
+		return;
+	}
+	if ((!old) == (!word)) {
+		return;
+	}
+	bit = 1UL << (w % Eba_ul_bits);
+	if (word) {
+		eba_sparse_update_(sparse, level + 1, w / Eba_ul_bits, bit, 0);
+	} else {
+		eba_sparse_update_(sparse, level + 1, w / Eba_ul_bits, 0, bit);
+	}
+}
+
+/* the first set bit of the level at or after pos, or Eba_sparse_none */
+static size_t eba_sparse_next_set_(struct eba_sparse *sparse, unsigned level,
+				   size_t pos)
+{
+	size_t w = pos / Eba_ul_bits;
+	unsigned long word = 0;
+
+	if (w >= sparse->level_words[level]) {
+		return Eba_sparse_none;
+	}
+	word = eba_sparse_level_word_(sparse, level, w);
+	word &= ~((1UL << (pos % Eba_ul_bits)) - 1);
+	if (word) {
+		return (w * Eba_ul_bits) + eba_ctz_ul_(word);
+	}
+	if ((level + 1) == sparse->levels) {
+		return Eba_sparse_none;
+	}
+
+	w = eba_sparse_next_set_(sparse, level + 1, w + 1);
+	if (w == Eba_sparse_none) {
+		return Eba_sparse_none;
+	}
+	word = eba_sparse_level_word_(sparse, level, w);
+	eembed_assert(word);
+	return (w * Eba_ul_bits) + eba_ctz_ul_(word);
+}
+
+/* up to a word of eba.bits, starting at byte, but not past end */
+static unsigned long eba_sparse_bits_word_(struct eba_sparse *sparse,
+					   size_t byte, size_t end)
+{
+	unsigned long word = 0;
+	size_t i = 0;
+
+	if ((end - byte) >= sizeof(unsigned long)) {
+		return eba_load_ul_(sparse->eba.bits + byte);
+	}
+	for (i = 0; (byte + i) < end; ++i) {
+		word |= ((unsigned long)sparse->eba.bits[byte + i])
+		    << (CHAR_BIT * i);
+	}
+	return word;
+}
+
+static size_t eba_sparse_line_end_(struct eba_sparse *sparse, size_t line)
+{
+	size_t end = (line + 1) * EBA_SPARSE_LINE_BYTES;
+
+	return eba_min_(end, sparse->eba.size_bytes);
+}
+
+/* the first set bit in the line at or after bit pos, or Eba_sparse_none */
+static size_t eba_sparse_scan_line_(struct eba_sparse *sparse, size_t line,
+				    size_t pos)
+{
+	size_t end = eba_sparse_line_end_(sparse, line);
+	size_t byte = pos / CHAR_BIT;
+	unsigned long word = 0;
+
+	word = eba_sparse_bits_word_(sparse, byte, end);
+	word &= (~0UL) << (pos % CHAR_BIT);
+	while (!word) {
+		byte += sizeof(unsigned long);
+		if (byte >= end) {
+			return Eba_sparse_none;
+		}
+		word = eba_sparse_bits_word_(sparse, byte, end);
+	}
+	return (byte * CHAR_BIT) + eba_ctz_ul_(word);
+}
+
+static unsigned char eba_sparse_line_is_zero_(struct eba_sparse *sparse,
+					      size_t line)
+{
+	size_t end = eba_sparse_line_end_(sparse, line);
+	size_t byte = line * EBA_SPARSE_LINE_BYTES;
+
+	for (; byte < end; byte += sizeof(unsigned long)) {
+		if (eba_sparse_bits_word_(sparse, byte, end)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void eba_sparse_rebuild(struct eba_sparse *sparse)
+{
+	size_t lines = 0;
+	size_t line = 0;
+	unsigned level = 0;
+
+	eembed_assert(sparse);
+
+	for (level = 0; level < sparse->levels; ++level) {
+		eembed_memset(sparse->level[level], 0x00,
+			      sparse->level_words[level]
+			      * sizeof(unsigned long));
+	}
+	lines = eba_sparse_lines_(sparse->eba.size_bytes);
+	for (line = 0; line < lines; ++line) {
+		if (!eba_sparse_line_is_zero_(sparse, line)) {
+			eba_sparse_update_(sparse, 0, line / Eba_ul_bits,
+					   1UL << (line % Eba_ul_bits), 0);
+		}
+	}
+}
+
+int eba_sparse_init(struct eba_sparse *sparse, unsigned char *bits,
+		    size_t size_bytes, unsigned char *summary,
+		    size_t summary_len)
+{
+	size_t needed = eba_sparse_summary_bytes(size_bytes);
+	size_t offset = 0;
+	unsigned i = 0;
+
+	if (!sparse || !bits || !summary || !needed || summary_len < needed) {
+		return 1;
+	}
+
+	sparse->eba.bits = bits;
+	sparse->eba.size_bytes = size_bytes;
+	/* fixed, so that searching forward is walking forward in memory */
+	sparse->eba.endian = eba_endian_little;
+	sparse->levels = eba_levels_layout_(eba_sparse_lines_(size_bytes),
+					    sparse->level_words,
+					    EBA_SPARSE_MAX_LEVELS);
+	for (i = 0; i < sparse->levels; ++i) {
+		sparse->level[i] = summary + offset;
+		offset += sparse->level_words[i] * sizeof(unsigned long);
+	}
+	for (; i < EBA_SPARSE_MAX_LEVELS; ++i) {
+		sparse->level[i] = NULL;
+		sparse->level_words[i] = 0;
+	}
+	eba_sparse_rebuild(sparse);
+	return 0;
+}
+
+void eba_sparse_set(struct eba_sparse *sparse, unsigned long index,
+		    unsigned char val)
+{
+	size_t line = (index / CHAR_BIT) / EBA_SPARSE_LINE_BYTES;
+	unsigned long bit = 1UL << (line % Eba_ul_bits);
+	unsigned long word = 0;
+
+	eembed_assert(sparse);
+
+	eba_set(&sparse->eba, index, val);
+	word = eba_sparse_level_word_(sparse, 0, line / Eba_ul_bits);
+	if (val) {
+		if (!(word & bit)) {
+			eba_sparse_update_(sparse, 0, line / Eba_ul_bits, bit,
+					   0);
+		}
+	} else if ((word & bit) && eba_sparse_line_is_zero_(sparse, line)) {
+		eba_sparse_update_(sparse, 0, line / Eba_ul_bits, 0, bit);
+	}
+}
+
+int eba_sparse_next(struct eba_sparse *sparse, unsigned long index,
+		    unsigned long *found)
+{
+	size_t line = 0;
+	size_t pos = 0;
+
+	eembed_assert(sparse);
+	eembed_assert(found);
+
+	if ((index / CHAR_BIT) >= sparse->eba.size_bytes) {
+		return 1;
+	}
+	line = (index / CHAR_BIT) / EBA_SPARSE_LINE_BYTES;
+	pos = eba_sparse_next_set_(sparse, 0, line);
+	if (pos == line) {
+		pos = eba_sparse_scan_line_(sparse, line, index);
+		if (pos != Eba_sparse_none) {
+			*found = pos;
+			return 0;
+		}
+		pos = eba_sparse_next_set_(sparse, 0, line + 1);
+	}
+	if (pos == Eba_sparse_none) {
+		return 1;
+	}
+	line = pos;
+	pos = eba_sparse_scan_line_(sparse, line,
+				    line * EBA_SPARSE_LINE_BYTES * CHAR_BIT);
+	eembed_assert(pos != Eba_sparse_none);
+	*found = pos;
+	return 0;
+}
+
+void eba_sparse_clear_all(struct eba_sparse *sparse)
+{
+	size_t line = 0;
+	size_t begin = 0;
+	unsigned level = 0;
+
+	eembed_assert(sparse);
+
+	for (line = eba_sparse_next_set_(sparse, 0, 0);
+	     line != Eba_sparse_none;
+	     line = eba_sparse_next_set_(sparse, 0, line + 1)) {
+		begin = line * EBA_SPARSE_LINE_BYTES;
+		eembed_memset(sparse->eba.bits + begin, 0x00,
+			      eba_sparse_line_end_(sparse, line) - begin);
+	}
+	for (level = 0; level < sparse->levels; ++level) {
+		eembed_memset(sparse->level[level], 0x00,
+			      sparse->level_words[level]
+			      * sizeof(unsigned long));
+	}
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba_sparse *eba_sparse_new(unsigned long num_bits)
+{
+	struct eba_sparse *sparse = NULL;
+	unsigned char *bytes = NULL;
+	size_t header_size = 0;
+	size_t size_bytes = 0;
+	size_t summary_bytes = 0;
+
+	size_bytes = (num_bits / CHAR_BIT) + ((num_bits % CHAR_BIT) ? 1 : 0);
+	summary_bytes = eba_sparse_summary_bytes(size_bytes);
+	if (!summary_bytes) {
+		return NULL;
+	}
+
+	header_size = eembed_align(sizeof(struct eba_sparse));
+	bytes = (unsigned char *)eembed_malloc(header_size + summary_bytes
+					       + size_bytes);
+	if (!bytes) {
+		return NULL;
+	}
+	eembed_memset(bytes + header_size + summary_bytes, 0x00, size_bytes);
+	sparse = (struct eba_sparse *)bytes;
+	if (eba_sparse_init(sparse, bytes + header_size + summary_bytes,
+			    size_bytes, bytes + header_size, summary_bytes)) {
+		eembed_free(bytes);
+		return NULL;
+	}
+	return sparse;
+}
+
+void eba_sparse_free(struct eba_sparse *sparse)
+{
+	eembed_free(sparse);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+#undef Eba_sparse_none
+#endif /* EBA_SKIP_SPARSE */
+
+#if (!(EBA_SKIP_COPY_BITS))
+
+/* the word of src bits starting at bit pos, a funnel shift of the
+ * word at the byte of pos with the byte after it */
+static unsigned long eba_funnel_ul_(struct eba *src, unsigned long pos)
+{
+	size_t k = pos / CHAR_BIT;
+	unsigned shift = pos % CHAR_BIT;
+	unsigned long word = eba_load_index_ul_(src, k);
+	unsigned long next = 0;
+
+	if (shift) {
+		next = *eba_index_byte_(src, k + Eba_ul_bytes);
+		word = (word >> shift) | (next << (Eba_ul_bits - shift));
+	}
+	return word;
+}
+
+static void eba_copy_byte_(struct eba *dst, size_t k, struct eba *src,
+			   unsigned long pos)
+{
+	unsigned long byte = eba_get_bits(src, pos, CHAR_BIT);
+
+	*eba_index_byte_(dst, k) = (unsigned char)byte;
+}
+
+/* whole dst bytes [k, k + n) from the src bits starting at pos */
+static void eba_copy_funnel_(struct eba *dst, size_t k, struct eba *src,
+			     unsigned long pos, size_t n,
+			     unsigned char backward)
+{
+	unsigned long word = 0;
+	size_t i = 0;
+
+	if (!backward) {
+		for (i = 0; (i + Eba_ul_bytes) <= n; i += Eba_ul_bytes) {
+			word = eba_funnel_ul_(src, pos + (i * CHAR_BIT));
+			eba_store_index_ul_(dst, k + i, word);
+		}
+		for (; i < n; ++i) {
+			eba_copy_byte_(dst, k + i, src, pos + (i * CHAR_BIT));
+		}
+		return;
+	}
+
+	/* the dst is ahead of the src in the same array, start at the end */
+	for (i = n; i % Eba_ul_bytes;) {
+		--i;
+		eba_copy_byte_(dst, k + i, src, pos + (i * CHAR_BIT));
+	}
+	while (i) {
+		i -= Eba_ul_bytes;
+		word = eba_funnel_ul_(src, pos + (i * CHAR_BIT));
+		eba_store_index_ul_(dst, k + i, word);
+	}
+}
+
+void eba_copy_bits(struct eba *dst, unsigned long dst_index, struct eba *src,
+		   unsigned long src_index, unsigned long nbits)
+{
+	unsigned long val = 0;
+	unsigned long tail_val = 0;
+	unsigned head = 0;
+	unsigned tail = 0;
+	size_t k = 0;
+	size_t n = 0;
+	unsigned long pos = 0;
+	unsigned char *to = NULL;
+	unsigned char *from = NULL;
+
+	eba_assert_not_null_(dst);
+	eba_assert_not_null_(src);
+	eembed_assert((dst_index + nbits) <= (dst->size_bytes * CHAR_BIT));
+	eembed_assert((src_index + nbits) <= (src->size_bytes * CHAR_BIT));
+
+	if (nbits <= Eba_ul_bits) {
+		val = eba_get_bits(src, src_index, nbits);
+		eba_set_bits(dst, dst_index, nbits, val);
+		return;
+	}
+
+	/* the bits before and after the whole bytes of dst are read first,
+	 * as copying the bytes may overwrite them if the ranges overlap */
+	head = (CHAR_BIT - (dst_index % CHAR_BIT)) % CHAR_BIT;
+	tail = (dst_index + nbits) % CHAR_BIT;
+	val = eba_get_bits(src, src_index, head);
+	tail_val = eba_get_bits(src, src_index + (nbits - tail), tail);
+
+	k = (dst_index + head) / CHAR_BIT;
+	n = (nbits - (head + tail)) / CHAR_BIT;
+	pos = src_index + head;
+
+	if ((dst->endian == src->endian) && !(pos % CHAR_BIT)) {
+		to = eba_index_byte_(dst, k);
+		from = eba_index_byte_(src, pos / CHAR_BIT);
+		if (dst->endian == eba_big_endian) {
+			/* the bytes run downwards from there */
+			to -= (n - 1);
+			from -= (n - 1);
+		}
+		eembed_memmove(to, from, n);
+	} else {
+		eba_copy_funnel_(dst, k, src, pos, n,
+				 (dst->bits == src->bits)
+				 && (dst_index > src_index));
+	}
+
+	eba_set_bits(dst, dst_index, head, val);
+	eba_set_bits(dst, dst_index + (nbits - tail), tail, tail_val);
+}
+
+#endif /* EBA_SKIP_COPY_BITS */
+
+#if (!(EBA_SKIP_BITSTREAM))
+
+static unsigned long eba_size_bits_(struct eba *eba)
+{
+	return ((unsigned long)eba->size_bytes) * CHAR_BIT;
+}
+
+void eba_bitwriter_init(struct eba_bitwriter *writer, struct eba *eba,
+			unsigned long index)
+{
+	eembed_assert(writer);
+	eba_assert_not_null_(eba);
+	eembed_assert(index <= eba_size_bits_(eba));
+
+	writer->eba = eba;
+	writer->index = index;
+	writer->acc = 0;
+	writer->count = 0;
+}
+
+/* returns non-zero if nbits more would not fit */
+static int eba_bitwriter_full_(struct eba_bitwriter *writer,
+			       unsigned long nbits)
+{
+	unsigned long left = 0;
+
+	left = eba_size_bits_(writer->eba) - (writer->index + writer->count);
+	return nbits > left;
+}
+
+int eba_bitwriter_put(struct eba_bitwriter *writer, unsigned long val,
+		      unsigned nbits)
+{
+	unsigned used = 0;
+
+	eembed_assert(writer);
+	eembed_assert(nbits <= Eba_ul_bits);
+
+	if (!nbits) {
+		return 0;
+	}
+	if (eba_bitwriter_full_(writer, nbits)) {
+		return 1;
+	}
+	if (nbits < Eba_ul_bits) {
+		val &= (1UL << nbits) - 1;
+	}
+	writer->acc |= val << writer->count;
+	if ((writer->count + nbits) < Eba_ul_bits) {
+		writer->count += nbits;
+		return 0;
+	}
+
+	/* the accumulator is full, write it out as one word */
+	if (!(writer->index % CHAR_BIT)) {
+		eba_store_index_ul_(writer->eba, writer->index / CHAR_BIT,
+				    writer->acc);
+	} else {
+		eba_set_bits(writer->eba, writer->index, Eba_ul_bits,
+			     writer->acc);
+	}
+	writer->index += Eba_ul_bits;
+	used = Eba_ul_bits - writer->count;
+	writer->acc = (used < Eba_ul_bits) ? (val >> used) : 0;
+	writer->count = nbits - used;
+	return 0;
+}
+
+int eba_bitwriter_put_unary(struct eba_bitwriter *writer, unsigned long q)
+{
+	eembed_assert(writer);
+
+	if (q == (unsigned long)-1 || eba_bitwriter_full_(writer, q + 1)) {
+		return 1;
+	}
+	while (q >= Eba_ul_bits) {
+		eba_bitwriter_put(writer, 0, Eba_ul_bits);
+		q -= Eba_ul_bits;
+	}
+	return eba_bitwriter_put(writer, 1UL << q, q + 1);
+}
+
+int eba_bitwriter_put_gamma(struct eba_bitwriter *writer, unsigned long x)
+{
+	unsigned n = 0;
+
+	eembed_assert(writer);
+
+	if (!x) {
+		return 1;
+	}
+	n = eba_high_bit_ul_(x);
+	if (eba_bitwriter_full_(writer, (2UL * n) + 1)) {
+		return 1;
+	}
+	if (((2 * n) + 1) <= Eba_ul_bits) {
+		/* the whole code as one field */
+		x &= (1UL << n) - 1;
+		return eba_bitwriter_put(writer, (1UL << n) | (x << (n + 1)),
+					 (2 * n) + 1);
+	}
+	eba_bitwriter_put_unary(writer, n);
+	return eba_bitwriter_put(writer, x, n);
+}
+
+void eba_bitwriter_flush(struct eba_bitwriter *writer)
+{
+	eembed_assert(writer);
+
+	eba_set_bits(writer->eba, writer->index, writer->count, writer->acc);
+}
+
+unsigned long eba_bitwriter_position(struct eba_bitwriter *writer)
+{
+	eembed_assert(writer);
+
+	return writer->index + writer->count;
+}
+
+void eba_bitreader_init(struct eba_bitreader *reader, struct eba *eba,
+			unsigned long index)
+{
+	eembed_assert(reader);
+	eba_assert_not_null_(eba);
+	eembed_assert(index <= eba_size_bits_(eba));
+
+	reader->eba = eba;
+	reader->index = index;
+	reader->acc = 0;
+	reader->count = 0;
+}
+
+/* the next word (or what is left) of the eba, returns how many bits */
+static unsigned eba_bitreader_refill_(struct eba_bitreader *reader,
+				      unsigned long *word)
+{
+	unsigned long left = eba_size_bits_(reader->eba) - reader->index;
+
+	if (left < Eba_ul_bits) {
+		*word = eba_get_bits(reader->eba, reader->index,
+				     (unsigned)left);
+		return (unsigned)left;
+	}
+	if (!(reader->index % CHAR_BIT)) {
+		*word = eba_load_index_ul_(reader->eba,
+					   reader->index / CHAR_BIT);
+	} else {
+		*word = eba_get_bits(reader->eba, reader->index, Eba_ul_bits);
+	}
+	return Eba_ul_bits;
+}
+
+int eba_bitreader_get(struct eba_bitreader *reader, unsigned nbits,
+		      unsigned long *val)
+{
+	unsigned long word = 0;
+	unsigned long got = 0;
+	unsigned avail = 0;
+	unsigned need = 0;
+
+	eembed_assert(reader);
+	eembed_assert(val);
+	eembed_assert(nbits <= Eba_ul_bits);
+
+	if (nbits <= reader->count) {
+		got = reader->acc;
+		if (nbits < Eba_ul_bits) {
+			got &= (1UL << nbits) - 1;
+			reader->acc >>= nbits;
+		} else {
+			reader->acc = 0;
+		}
+		reader->count -= nbits;
+		*val = got;
+		return 0;
+	}
+
+	avail = eba_bitreader_refill_(reader, &word);
+	need = nbits - reader->count;
+	if (avail < need) {
+		return 1;
+	}
+	got = reader->acc | (word << reader->count);
+	if (nbits < Eba_ul_bits) {
+		got &= (1UL << nbits) - 1;
+	}
+	reader->acc = (need < Eba_ul_bits) ? (word >> need) : 0;
+	reader->count = avail - need;
+	reader->index += avail;
+	*val = got;
+	return 0;
+}
+
+int eba_bitreader_get_unary(struct eba_bitreader *reader, unsigned long *q)
+{
+	unsigned long zeros = 0;
+	unsigned long word = 0;
+	unsigned avail = 0;
+	unsigned z = 0;
+
+	eembed_assert(reader);
+	eembed_assert(q);
+
+	/* the accumulator holds no bits above count */
+	while (!reader->acc) {
+		zeros += reader->count;
+		avail = eba_bitreader_refill_(reader, &word);
+		if (!avail) {
+			reader->count = 0;
+			return 1;
+		}
+		reader->acc = word;
+		reader->count = avail;
+		reader->index += avail;
+	}
+	z = eba_ctz_ul_(reader->acc);
+	reader->acc = ((z + 1) < Eba_ul_bits) ? (reader->acc >> (z + 1)) : 0;
+	reader->count -= (z + 1);
+	*q = zeros + z;
+	return 0;
+}
+
+int eba_bitreader_get_gamma(struct eba_bitreader *reader, unsigned long *x)
+{
+	unsigned long n = 0;
+	unsigned long low = 0;
+
+	eembed_assert(x);
+
+	if (eba_bitreader_get_unary(reader, &n)) {
+		return 1;
+	}
+	if (n >= Eba_ul_bits) {
+		return 1;
+	}
+	if (eba_bitreader_get(reader, (unsigned)n, &low)) {
+		return 1;
+	}
+	*x = (1UL << n) | low;
+	return 0;
+}
+
+unsigned long eba_bitreader_position(struct eba_bitreader *reader)
+{
+	eembed_assert(reader);
+
+	return reader->index - reader->count;
+}
+
+#endif /* EBA_SKIP_BITSTREAM */
+
+#if (!(EBA_SKIP_ALIGNED))
+
+/* alignment enough for a struct eba */
+#define Eba_header_align \
+	((sizeof(size_t) > sizeof(void *)) ? sizeof(size_t) : sizeof(void *))
+
+/* the distance from ptr to the next multiple of align */
+static size_t eba_align_pad_(const unsigned char *ptr, size_t align)
+{
+	size_t over = ((size_t)ptr) % align;
+
+	return over ? (align - over) : 0;
+}
+
+size_t eba_aligned_size_bytes(unsigned long num_bits)
+{
+	size_t words = 0;
+	size_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+
+	words = num_bits / bits_per_word;
+	if ((words * bits_per_word) < num_bits) {
+		words += 1;
+	}
+	if (!words) {
+		words = 1;
+	}
+	return words * sizeof(unsigned long);
+}
+
+int eba_init_aligned(struct eba *eba, unsigned char *mem, size_t mem_len,
+		     unsigned long num_bits, enum eba_endian endian)
+{
+	size_t size_bytes = eba_aligned_size_bytes(num_bits);
+	size_t pad = 0;
+
+	if (!eba || !mem) {
+		return 1;
+	}
+	pad = eba_align_pad_(mem, EBA_ALIGN_BYTES);
+	if (mem_len < pad || (mem_len - pad) < size_bytes) {
+		return 1;
+	}
+
+	eba->bits = mem + pad;
+	eba->size_bytes = size_bytes;
+	eba->endian = endian;
+	eembed_memset(eba->bits, 0x00, size_bytes);
+	return 0;
+}
+
+void eba_arena_init(struct eba_arena *arena, unsigned char *mem,
+		    size_t size)
+{
+	eembed_assert(arena);
+	eembed_assert(mem || !size);
+
+	arena->mem = mem;
+	arena->size = size;
+	arena->used = 0;
+}
+
+void eba_arena_reset(struct eba_arena *arena)
+{
+	eembed_assert(arena);
+
+	arena->used = 0;
+}
+
+struct eba *eba_new_in(struct eba_arena *arena, unsigned long num_bits,
+		       enum eba_endian endian)
+{
+	struct eba *eba = NULL;
+	unsigned char *next = NULL;
+	size_t left = 0;
+	size_t pad = 0;
+
+	eembed_assert(arena);
+
+	next = arena->mem + arena->used;
+	left = arena->size - arena->used;
+	pad = eba_align_pad_(next, Eba_header_align);
+	if (left < (pad + sizeof(struct eba))) {
+		return NULL;
+	}
+	eba = (struct eba *)(next + pad);
+	next += pad + sizeof(struct eba);
+	left -= pad + sizeof(struct eba);
+
+	if (eba_init_aligned(eba, next, left, num_bits, endian)) {
+		return NULL;
+	}
+	arena->used = (size_t)((eba->bits + eba->size_bytes) - arena->mem);
+	return eba;
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba *eba_new_aligned(unsigned long num_bits, enum eba_endian endian)
+{
+	struct eba *eba = NULL;
+	unsigned char *bytes = NULL;
+	size_t header_size = 0;
+	size_t len = 0;
+
+	header_size = eembed_align(sizeof(struct eba));
+	len = EBA_ALIGN_BYTES - 1 + eba_aligned_size_bytes(num_bits);
+	bytes = (unsigned char *)eembed_malloc(header_size + len);
+	if (!bytes) {
+		return NULL;
+	}
+	eba = (struct eba *)bytes;
+	if (eba_init_aligned(eba, bytes + header_size, len, num_bits, endian)) {
+		eembed_free(bytes);
+		return NULL;
+	}
+	return eba;
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+#undef Eba_header_align
+#endif /* EBA_SKIP_ALIGNED */
+
+#if ((!(EBA_SKIP_POOL)) && (!(EBA_SKIP_NEW)))
+
+#define Eba_pool_min_bytes 8
+
+struct eba_pool_slab {
+	struct eba_pool_slab *next;
+	unsigned size_class;
+};
+
+static size_t eba_pool_class_bytes_(unsigned size_class)
+{
+	return ((size_t)Eba_pool_min_bytes) << size_class;
+}
+
+static size_t eba_pool_stride_(unsigned size_class)
+{
+	return eembed_align(sizeof(struct eba))
+	    + eba_pool_class_bytes_(size_class);
+}
+
+/* the smallest class with room for num_bits */
+static unsigned eba_pool_class_(unsigned long num_bits)
+{
+	unsigned min_bits_log2 = eba_high_bit_ul_(Eba_pool_min_bytes
+						  * CHAR_BIT);
+
+	if (num_bits <= (Eba_pool_min_bytes * CHAR_BIT)) {
+		return 0;
+	}
+	/* the sizes are random, avoid a loop of unpredictable length */
+	return (eba_high_bit_ul_(num_bits - 1) + 1) - min_bits_log2;
+}
+
+static unsigned char *eba_pool_bits_(struct eba *eba)
+{
+	return ((unsigned char *)eba) + eembed_align(sizeof(struct eba));
+}
+
+/* free arrays are linked through their bits pointer */
+static void eba_pool_push_(struct eba_pool *pool, struct eba *eba,
+			   unsigned size_class)
+{
+	eba->bits = (unsigned char *)pool->free_list[size_class];
+	pool->free_list[size_class] = eba;
+}
+
+static void eba_pool_push_slab_(struct eba_pool *pool,
+				struct eba_pool_slab *slab)
+{
+	unsigned char *bytes = (unsigned char *)slab;
+	size_t header_size = eembed_align(sizeof(struct eba_pool_slab));
+	size_t stride = eba_pool_stride_(slab->size_class);
+	struct eba *eba = NULL;
+	size_t i = 0;
+
+	/* pushed in reverse, so that they are handed out in address order */
+	for (i = EBA_POOL_SLAB_ARRAYS; i > 0; --i) {
+		eba = (struct eba *)(bytes + header_size + ((i - 1) * stride));
+		eba->size_bytes = eba_pool_class_bytes_(slab->size_class);
+		eba_pool_push_(pool, eba, slab->size_class);
+	}
+}
+
+static int eba_pool_grow_(struct eba_pool *pool, unsigned size_class)
+{
+	struct eba_pool_slab *slab = NULL;
+	size_t size = 0;
+
+	size = eembed_align(sizeof(struct eba_pool_slab))
+	    + (EBA_POOL_SLAB_ARRAYS * eba_pool_stride_(size_class));
+	slab = (struct eba_pool_slab *)eembed_malloc(size);
+	if (!slab) {
+		return 1;
+	}
+	slab->size_class = size_class;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+	eba_pool_push_slab_(pool, slab);
+	return 0;
+}
+
+/* an array from the free list, not yet cleared */
+static struct eba *eba_pool_pop_(struct eba_pool *pool, unsigned size_class)
+{
+	struct eba *eba = NULL;
+
+	if (!pool->free_list[size_class]) {
+		if (eba_pool_grow_(pool, size_class)) {
+			return NULL;
+		}
+	}
+	eba = pool->free_list[size_class];
+	pool->free_list[size_class] = (struct eba *)eba->bits;
+	eba->bits = eba_pool_bits_(eba);
+	return eba;
+}
+
+static struct eba *eba_pool_ready_(struct eba *eba, enum eba_endian endian)
+{
+	if (eba) {
+		eba->endian = endian;
+		eembed_memset(eba->bits, 0x00, eba->size_bytes);
+	}
+	return eba;
+}
+
+void eba_pool_init(struct eba_pool *pool)
+{
+	unsigned i = 0;
+
+	eembed_assert(pool);
+
+	pool->slabs = NULL;
+	for (i = 0; i < EBA_POOL_CLASSES; ++i) {
+		pool->free_list[i] = NULL;
+	}
+}
+
+void eba_pool_destroy(struct eba_pool *pool)
+{
+	struct eba_pool_slab *slab = NULL;
+
+	eembed_assert(pool);
+
+	while (pool->slabs) {
+		slab = pool->slabs;
+		pool->slabs = slab->next;
+		eembed_free(slab);
+	}
+	eba_pool_init(pool);
+}
+
+void eba_pool_reset(struct eba_pool *pool)
+{
+	struct eba_pool_slab *slab = NULL;
+	unsigned i = 0;
+
+	eembed_assert(pool);
+
+	for (i = 0; i < EBA_POOL_CLASSES; ++i) {
+		pool->free_list[i] = NULL;
+	}
+	for (slab = pool->slabs; slab; slab = slab->next) {
+		eba_pool_push_slab_(pool, slab);
+	}
+}
+
+struct eba *eba_pool_new(struct eba_pool *pool, unsigned long num_bits,
+			 enum eba_endian endian)
+{
+	eembed_assert(pool);
+
+	if (num_bits > EBA_POOL_MAX_BITS) {
+		return NULL;
+	}
+	return eba_pool_ready_(eba_pool_pop_(pool, eba_pool_class_(num_bits)),
+			       endian);
+}
+
+void eba_pool_free(struct eba_pool *pool, struct eba *eba)
+{
+	eembed_assert(pool);
+
+	if (!eba) {
+		return;
+	}
+	eembed_assert(eba->size_bytes <= (EBA_POOL_MAX_BITS / CHAR_BIT));
+	eba_pool_push_(pool, eba, eba_pool_class_(eba->size_bytes * CHAR_BIT));
+}
+
+void eba_pool_cache_init(struct eba_pool_cache *cache, struct eba_pool *pool,
+			 eba_pool_lock_func lock, eba_pool_lock_func unlock,
+			 void *lock_context)
+{
+	unsigned i = 0;
+
+	eembed_assert(cache);
+	eembed_assert(pool);
+
+	cache->pool = pool;
+	cache->lock = lock;
+	cache->unlock = unlock;
+	cache->lock_context = lock_context;
+	for (i = 0; i < EBA_POOL_CLASSES; ++i) {
+		cache->count[i] = 0;
+	}
+}
+
+static void eba_pool_cache_lock_(struct eba_pool_cache *cache)
+{
+	if (cache->lock) {
+		cache->lock(cache->lock_context);
+	}
+}
+
+static void eba_pool_cache_unlock_(struct eba_pool_cache *cache)
+{
+	if (cache->unlock) {
+		cache->unlock(cache->lock_context);
+	}
+}
+
+struct eba *eba_pool_cache_new(struct eba_pool_cache *cache,
+			       unsigned long num_bits, enum eba_endian endian)
+{
+	struct eba *eba = NULL;
+	unsigned c = 0;
+
+	eembed_assert(cache);
+
+	if (num_bits > EBA_POOL_MAX_BITS) {
+		return NULL;
+	}
+	c = eba_pool_class_(num_bits);
+	if (!cache->count[c]) {
+		/* refill half, leaving room for frees */
+		eba_pool_cache_lock_(cache);
+		while (cache->count[c] < (EBA_POOL_CACHE_SIZE / 2)) {
+			eba = eba_pool_pop_(cache->pool, c);
+			if (!eba) {
+				break;
+			}
+			cache->arrays[c][cache->count[c]++] = eba;
+		}
+		eba_pool_cache_unlock_(cache);
+		if (!cache->count[c]) {
+			return NULL;
+		}
+	}
+	eba = cache->arrays[c][--cache->count[c]];
+	return eba_pool_ready_(eba, endian);
+}
+
+/* returns the oldest cached arrays of the class until only keep remain */
+static void eba_pool_cache_drain_(struct eba_pool_cache *cache, unsigned c,
+				  size_t keep)
+{
+	size_t i = 0;
+	size_t n = 0;
+
+	if (cache->count[c] <= keep) {
+		return;
+	}
+	n = cache->count[c] - keep;
+	eba_pool_cache_lock_(cache);
+	for (i = 0; i < n; ++i) {
+		eba_pool_push_(cache->pool, cache->arrays[c][i], c);
+	}
+	eba_pool_cache_unlock_(cache);
+	eembed_memmove(cache->arrays[c], cache->arrays[c] + n,
+		       keep * sizeof(struct eba *));
+	cache->count[c] = keep;
+}
+
+void eba_pool_cache_free(struct eba_pool_cache *cache, struct eba *eba)
+{
+	unsigned c = 0;
+
+	eembed_assert(cache);
+
+	if (!eba) {
+		return;
+	}
+	eembed_assert(eba->size_bytes <= (EBA_POOL_MAX_BITS / CHAR_BIT));
+	c = eba_pool_class_(eba->size_bytes * CHAR_BIT);
+	if (cache->count[c] == EBA_POOL_CACHE_SIZE) {
+		eba_pool_cache_drain_(cache, c, EBA_POOL_CACHE_SIZE / 2);
+	}
+	cache->arrays[c][cache->count[c]++] = eba;
+}
+
+void eba_pool_cache_flush(struct eba_pool_cache *cache)
+{
+	unsigned c = 0;
+
+	eembed_assert(cache);
+
+	for (c = 0; c < EBA_POOL_CLASSES; ++c) {
+		eba_pool_cache_drain_(cache, c, 0);
+	}
+}
+
+#undef Eba_pool_min_bytes
+#endif /* ((!(EBA_SKIP_POOL)) && (!(EBA_SKIP_NEW))) */
+
+#if ((!(EBA_SKIP_COW)) && (!(EBA_SKIP_NEW)))
+
+#define Eba_cow_page_bits (((unsigned long)EBA_COW_PAGE_BYTES) * CHAR_BIT)
+
+struct eba_cow_page {
+	size_t refs;
+};
+
+/* every page is full, except possibly the last */
+static size_t eba_cow_page_bytes_(const struct eba_cow *cow, size_t page)
+{
+	unsigned long bits = cow->num_bits - (page * Eba_cow_page_bits);
+
+	if (bits > Eba_cow_page_bits) {
+		bits = Eba_cow_page_bits;
+	}
+	return (bits / CHAR_BIT) + ((bits % CHAR_BIT) ? 1 : 0);
+}
+
+static unsigned char *eba_cow_page_bits_(struct eba_cow_page *page)
+{
+	return ((unsigned char *)page)
+	    + eembed_align(sizeof(struct eba_cow_page));
+}
+
+static struct eba_cow_page *eba_cow_page_new_(size_t size_bytes)
+{
+	struct eba_cow_page *page = NULL;
+	size_t size = 0;
+
+	size = eembed_align(sizeof(struct eba_cow_page)) + size_bytes;
+	page = (struct eba_cow_page *)eembed_malloc(size);
+	if (page) {
+		page->refs = 1;
+	}
+	return page;
+}
+
+static void eba_cow_page_release_(struct eba_cow_page *page)
+{
+	if (page) {
+		--page->refs;
+		if (!page->refs) {
+			eembed_free(page);
+		}
+	}
+}
+
+/* the struct and its table of pages in one allocation, no pages yet */
+static struct eba_cow *eba_cow_alloc_(unsigned long num_bits,
+				      enum eba_endian endian)
+{
+	struct eba_cow *cow = NULL;
+	size_t header_size = 0;
+	size_t num_pages = 0;
+	size_t i = 0;
+
+	num_pages = (num_bits / Eba_cow_page_bits)
+	    + ((num_bits % Eba_cow_page_bits) ? 1 : 0);
+	header_size = eembed_align(sizeof(struct eba_cow));
+	cow = (struct eba_cow *)eembed_malloc(header_size +
+					      (num_pages *
+					       sizeof(struct eba_cow_page *)));
+	if (!cow) {
+		return NULL;
+	}
+	cow->num_bits = num_bits;
+	cow->endian = endian;
+	cow->num_pages = num_pages;
+	cow->pages = (struct eba_cow_page **)(((unsigned char *)cow)
+					      + header_size);
+	for (i = 0; i < num_pages; ++i) {
+		cow->pages[i] = NULL;
+	}
+	return cow;
+}
+
+struct eba_cow *eba_cow_new(unsigned long num_bits, enum eba_endian endian)
+{
+	struct eba_cow *cow = NULL;
+	size_t size_bytes = 0;
+	size_t i = 0;
+
+	cow = eba_cow_alloc_(num_bits, endian);
+	if (!cow) {
+		return NULL;
+	}
+	for (i = 0; i < cow->num_pages; ++i) {
+		size_bytes = eba_cow_page_bytes_(cow, i);
+		cow->pages[i] = eba_cow_page_new_(size_bytes);
+		if (!cow->pages[i]) {
+			eba_cow_free(cow);
+			return NULL;
+		}
+		eembed_memset(eba_cow_page_bits_(cow->pages[i]), 0x00,
+			      size_bytes);
+	}
+	return cow;
+}
+
+void eba_cow_free(struct eba_cow *cow)
+{
+	size_t i = 0;
+
+	if (!cow) {
+		return;
+	}
+	for (i = 0; i < cow->num_pages; ++i) {
+		eba_cow_page_release_(cow->pages[i]);
+	}
+	eembed_free(cow);
+}
+
+struct eba_cow *eba_cow_snapshot(struct eba_cow *cow)
+{
+	struct eba_cow *snapshot = NULL;
+	size_t i = 0;
+
+	eembed_assert(cow);
+
+	snapshot = eba_cow_alloc_(cow->num_bits, cow->endian);
+	if (!snapshot) {
+		return NULL;
+	}
+	for (i = 0; i < cow->num_pages; ++i) {
+		snapshot->pages[i] = cow->pages[i];
+		++snapshot->pages[i]->refs;
+	}
+	return snapshot;
+}
+
+void eba_cow_page_view(const struct eba_cow *cow, size_t page,
+		       struct eba *view)
+{
+	eembed_assert(cow);
+	eembed_assert(view);
+	eembed_assert(page < cow->num_pages);
+
+	view->endian = cow->endian;
+	view->bits = eba_cow_page_bits_(cow->pages[page]);
+	view->size_bytes = eba_cow_page_bytes_(cow, page);
+}
+
+int eba_cow_page_write(struct eba_cow *cow, size_t page, struct eba *view)
+{
+	struct eba_cow_page *copy = NULL;
+	size_t size_bytes = 0;
+
+	eembed_assert(cow);
+	eembed_assert(view);
+	eembed_assert(page < cow->num_pages);
+
+	if (cow->pages[page]->refs > 1) {
+		size_bytes = eba_cow_page_bytes_(cow, page);
+		copy = eba_cow_page_new_(size_bytes);
+		if (!copy) {
+			return 1;
+		}
+		eembed_memcpy(eba_cow_page_bits_(copy),
+			      eba_cow_page_bits_(cow->pages[page]), size_bytes);
+		eba_cow_page_release_(cow->pages[page]);
+		cow->pages[page] = copy;
+	}
+	eba_cow_page_view(cow, page, view);
+	return 0;
+}
+
+unsigned char eba_cow_get(const struct eba_cow *cow, unsigned long index)
+{
+	struct eba view;
+
+	eembed_assert(cow);
+	eembed_assert(index < cow->num_bits);
+
+	eba_cow_page_view(cow, index / Eba_cow_page_bits, &view);
+	return eba_get(&view, index % Eba_cow_page_bits);
+}
+
+int eba_cow_set(struct eba_cow *cow, unsigned long index, unsigned char val)
+{
+	struct eba view;
+
+	eembed_assert(cow);
+	eembed_assert(index < cow->num_bits);
+
+	if (eba_cow_page_write(cow, index / Eba_cow_page_bits, &view)) {
+		return 1;
+	}
+	eba_set(&view, index % Eba_cow_page_bits, val);
+	return 0;
+}
+
+size_t eba_cow_private_pages(const struct eba_cow *cow)
+{
+	size_t count = 0;
+	size_t i = 0;
+
+	eembed_assert(cow);
+
+	for (i = 0; i < cow->num_pages; ++i) {
+		if (cow->pages[i]->refs == 1) {
+			++count;
+		}
+	}
+	return count;
+}
+
+#undef Eba_cow_page_bits
+#endif /* ((!(EBA_SKIP_COW)) && (!(EBA_SKIP_NEW))) */
+
+#if (!(EBA_SKIP_DIFF))
+
+#define Eba_diff_word_bytes EBA_DIFF_WORD_BYTES
+
+size_t eba_diff_dirty_bits(size_t size_bytes)
+{
+	return (size_bytes / Eba_diff_word_bytes)
+	    + ((size_bytes % Eba_diff_word_bytes) ? 1 : 0);
+}
+
+void eba_diff_touch(struct eba *dirty, struct eba *eba, unsigned long index)
+{
+	size_t byte = 0;
+
+	eembed_assert(dirty);
+	eembed_assert(dirty->endian == eba_endian_little);
+	eba_assert_not_null_(eba);
+	eembed_assert(index < (eba->size_bytes * CHAR_BIT));
+
+	/* eba_diff compares the bytes in memory order, and in a big
+	 * endian array the low bits are at the end */
+	byte = index / CHAR_BIT;
+	if (eba->endian == eba_big_endian) {
+		byte = (eba->size_bytes - 1) - byte;
+	}
+	eba_set(dirty, byte / Eba_diff_word_bytes, 1);
+}
+
+/* the bytes of a word, the last word may be short */
+static size_t eba_diff_word_end_(size_t size_bytes, size_t word)
+{
+	size_t end = (word + 1) * Eba_diff_word_bytes;
+
+	return (end < size_bytes) ? end : size_bytes;
+}
+
+static int eba_diff_changed_(struct eba *old_eba, struct eba *new_eba,
+			     struct eba *dirty, size_t word)
+{
+	unsigned char changed = 0;
+	size_t end = 0;
+	size_t i = 0;
+
+	if (dirty && !eba_get(dirty, word)) {
+		return 0;
+	}
+	end = eba_diff_word_end_(new_eba->size_bytes, word);
+	for (i = word * Eba_diff_word_bytes; i < end; ++i) {
+		changed |= old_eba->bits[i] ^ new_eba->bits[i];
+	}
+	return changed ? 1 : 0;
+}
+
+/* the next changed word, or words if there are none */
+static size_t eba_diff_next_(struct eba *old_eba, struct eba *new_eba,
+			     struct eba *dirty, size_t word, size_t words)
+{
+	while (word < words) {
+		/* a clean byte of the map skips CHAR_BIT words */
+		if (dirty && !(word % CHAR_BIT)
+		    && !dirty->bits[word / CHAR_BIT]) {
+			word += CHAR_BIT;
+		} else if (eba_diff_changed_(old_eba, new_eba, dirty, word)) {
+			return word;
+		} else {
+			++word;
+		}
+	}
+	return words;
+}
+
+static size_t eba_diff_put_varint_(unsigned char *patch, size_t patch_len,
+				   size_t pos, size_t x)
+{
+	unsigned char byte = 0;
+
+	do {
+		byte = (unsigned char)(x & 0x7F);
+		x >>= 7;
+		if (x) {
+			byte |= 0x80;
+		}
+		if (pos < patch_len) {
+			patch[pos] = byte;
+		}
+		++pos;
+	} while (x);
+	return pos;
+}
+
+static int eba_diff_get_varint_(const unsigned char *patch, size_t patch_len,
+				size_t *pos, size_t *x)
+{
+	unsigned char byte = 0;
+	size_t shift = 0;
+
+	*x = 0;
+	do {
+		if ((*pos >= patch_len)
+		    || (shift >= (sizeof(size_t) * CHAR_BIT))) {
+			return 1;
+		}
+		byte = patch[(*pos)++];
+		*x |= ((size_t)(byte & 0x7F)) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	return 0;
+}
+
+size_t eba_diff(struct eba *old_eba, struct eba *new_eba, struct eba *dirty,
+		unsigned char *patch, size_t patch_len)
+{
+	size_t words = 0;
+	size_t word = 0;
+	size_t last = 0;
+	size_t run_end = 0;
+	size_t end = 0;
+	size_t pos = 0;
+	size_t i = 0;
+
+	eembed_assert(old_eba);
+	eembed_assert(new_eba);
+	eembed_assert(old_eba->size_bytes == new_eba->size_bytes);
+	eembed_assert(patch || !patch_len);
+	eembed_assert(!dirty || (dirty->endian == eba_endian_little));
+
+	words = eba_diff_dirty_bits(new_eba->size_bytes);
+	eembed_assert(!dirty || ((dirty->size_bytes * CHAR_BIT) >= words));
+
+	word = eba_diff_next_(old_eba, new_eba, dirty, 0, words);
+	while (word < words) {
+		run_end = word + 1;
+		while ((run_end < words)
+		       && eba_diff_changed_(old_eba, new_eba, dirty, run_end)) {
+			++run_end;
+		}
+		pos = eba_diff_put_varint_(patch, patch_len, pos, word - last);
+		pos = eba_diff_put_varint_(patch, patch_len, pos,
+					   run_end - word);
+		end = eba_diff_word_end_(new_eba->size_bytes, run_end - 1);
+		for (i = word * Eba_diff_word_bytes; i < end; ++i, ++pos) {
+			if (pos < patch_len) {
+				patch[pos] =
+				    old_eba->bits[i] ^ new_eba->bits[i];
+			}
+		}
+		last = run_end;
+		word = eba_diff_next_(old_eba, new_eba, dirty, run_end, words);
+	}
+	return pos;
+}
+
+/* checks the whole patch before applying it, if apply is set */
+static int eba_patch_(struct eba *eba, const unsigned char *patch,
+		      size_t patch_len, int apply)
+{
+	size_t words = 0;
+	size_t word = 0;
+	size_t skip = 0;
+	size_t run = 0;
+	size_t end = 0;
+	size_t pos = 0;
+	size_t i = 0;
+
+	words = eba_diff_dirty_bits(eba->size_bytes);
+	while (pos < patch_len) {
+		if (eba_diff_get_varint_(patch, patch_len, &pos, &skip)
+		    || eba_diff_get_varint_(patch, patch_len, &pos, &run)) {
+			return 1;
+		}
+		if ((!run) || (skip > (words - word))
+		    || (run > ((words - word) - skip))) {
+			return 1;
+		}
+		word += skip;
+		end = eba_diff_word_end_(eba->size_bytes, (word + run) - 1);
+		i = word * Eba_diff_word_bytes;
+		if ((end - i) > (patch_len - pos)) {
+			return 1;
+		}
+		if (apply) {
+			for (; i < end; ++i, ++pos) {
+				eba->bits[i] ^= patch[pos];
+			}
+		} else {
+			pos += (end - i);
+		}
+		word += run;
+	}
+	return 0;
+}
+
+int eba_patch(struct eba *eba, const unsigned char *patch, size_t patch_len)
+{
+	eembed_assert(eba);
+	eembed_assert(patch || !patch_len);
+
+	if (eba_patch_(eba, patch, patch_len, 0)) {
+		return 1;
+	}
+	return eba_patch_(eba, patch, patch_len, 1);
+}
+
+#undef Eba_diff_word_bytes
+#endif /* EBA_SKIP_DIFF */
+
+#if (!(EBA_SKIP_DIRTY))
+
+size_t eba_dirty_marks_bytes(size_t size_bytes, size_t region_bytes)
+{
+	size_t regions = 0;
+
+	eembed_assert(region_bytes);
+
+	regions = (size_bytes / region_bytes)
+	    + ((size_bytes % region_bytes) ? 1 : 0);
+	return (regions / CHAR_BIT) + ((regions % CHAR_BIT) ? 1 : 0);
+}
+
+int eba_dirty_init(struct eba_dirty *dirty, struct eba *eba,
+		   size_t region_bytes, unsigned char *marks, size_t marks_len)
+{
+	size_t size_bytes = 0;
+
+	eembed_assert(dirty);
+	eembed_assert(eba);
+
+	if ((!region_bytes) || (region_bytes & (region_bytes - 1))) {
+		return 1;
+	}
+	size_bytes = eba_dirty_marks_bytes(eba->size_bytes, region_bytes);
+	if ((!marks && size_bytes) || (marks_len < size_bytes)) {
+		return 1;
+	}
+	dirty->eba = eba;
+	dirty->marks.endian = eba_endian_little;
+	dirty->marks.bits = marks;
+	dirty->marks.size_bytes = size_bytes;
+	dirty->regions = (eba->size_bytes / region_bytes)
+	    + ((eba->size_bytes % region_bytes) ? 1 : 0);
+	for (dirty->region_shift = 0; region_bytes > 1; region_bytes >>= 1) {
+		++dirty->region_shift;
+	}
+	eba_dirty_clear(dirty);
+	return 0;
+}
+
+#if (!(EBA_SKIP_NEW))
+struct eba_dirty *eba_dirty_new(struct eba *eba, size_t region_bytes)
+{
+	struct eba_dirty *dirty = NULL;
+	size_t header_size = 0;
+	size_t marks_len = 0;
+
+	eembed_assert(eba);
+
+	if ((!region_bytes) || (region_bytes & (region_bytes - 1))) {
+		return NULL;
+	}
+	header_size = eembed_align(sizeof(struct eba_dirty));
+	marks_len = eba_dirty_marks_bytes(eba->size_bytes, region_bytes);
+	dirty = (struct eba_dirty *)eembed_malloc(header_size + marks_len);
+	if (!dirty) {
+		return NULL;
+	}
+	eba_dirty_init(dirty, eba, region_bytes,
+		       ((unsigned char *)dirty) + header_size, marks_len);
+	return dirty;
+}
+
+void eba_dirty_free(struct eba_dirty *dirty)
+{
+	eembed_free(dirty);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+/* marks the regions holding bytes first through last */
+static void eba_dirty_mark_bytes_(struct eba_dirty *dirty, size_t first,
+				  size_t last)
+{
+	size_t region = first >> dirty->region_shift;
+	size_t end = last >> dirty->region_shift;
+
+	for (; region <= end; ++region) {
+		eba_set(&dirty->marks, region, 1);
+	}
+}
+
+void eba_dirty_mark_bits(struct eba_dirty *dirty, unsigned long index,
+			 unsigned long nbits)
+{
+	size_t first = 0;
+	size_t last = 0;
+
+	eembed_assert(dirty);
+
+	if (!nbits) {
+		return;
+	}
+	first = index / CHAR_BIT;
+	last = (index + (nbits - 1)) / CHAR_BIT;
+	eembed_assert(last < dirty->eba->size_bytes);
+	if (dirty->eba->endian == eba_big_endian) {
+		first = (dirty->eba->size_bytes - 1) - first;
+		last = (dirty->eba->size_bytes - 1) - last;
+		eba_dirty_mark_bytes_(dirty, last, first);
+	} else {
+		eba_dirty_mark_bytes_(dirty, first, last);
+	}
+}
+
+void eba_dirty_mark_all(struct eba_dirty *dirty)
+{
+	eembed_assert(dirty);
+
+	/* bits past the last region are never read */
+	eembed_memset(dirty->marks.bits, 0xFF, dirty->marks.size_bytes);
+}
+
+void eba_dirty_set(struct eba_dirty *dirty, unsigned long index,
+		   unsigned char val)
+{
+	eembed_assert(dirty);
+
+	eba_set(dirty->eba, index, val);
+	eba_dirty_mark_bits(dirty, index, 1);
+}
+
+void eba_dirty_set_bits(struct eba_dirty *dirty, unsigned long index,
+			unsigned nbits, unsigned long val)
+{
+	eembed_assert(dirty);
+
+	eba_set_bits(dirty->eba, index, nbits, val);
+	eba_dirty_mark_bits(dirty, index, nbits);
+}
+
+#if (!(EBA_SKIP_SET_ALL))
+void eba_dirty_set_all(struct eba_dirty *dirty, unsigned char val)
+{
+	eembed_assert(dirty);
+
+	eba_set_all(dirty->eba, val);
+	eba_dirty_mark_all(dirty);
+}
+#endif /* (!(EBA_SKIP_SET_ALL)) */
+
+#if (!(EBA_SKIP_TOGGLE))
+void eba_dirty_toggle(struct eba_dirty *dirty, unsigned long index)
+{
+	eembed_assert(dirty);
+
+	eba_toggle(dirty->eba, index);
+	eba_dirty_mark_bits(dirty, index, 1);
+}
+#endif /* (!(EBA_SKIP_TOGGLE)) */
+
+#if (!(EBA_SKIP_SWAP))
+void eba_dirty_swap(struct eba_dirty *dirty, unsigned long index1,
+		    unsigned long index2)
+{
+	eembed_assert(dirty);
+
+	eba_swap(dirty->eba, index1, index2);
+	eba_dirty_mark_bits(dirty, index1, 1);
+	eba_dirty_mark_bits(dirty, index2, 1);
+}
+#endif /* (!(EBA_SKIP_SWAP)) */
+
+#if (!(EBA_SKIP_SHIFTS))
+/* a shift or rotate may move every bit */
+static void eba_dirty_moved_(struct eba_dirty *dirty,
+			     unsigned long positions)
+{
+	if (positions) {
+		eba_dirty_mark_all(dirty);
+	}
+}
+
+void eba_dirty_rotate_left(struct eba_dirty *dirty, unsigned long positions)
+{
+	eembed_assert(dirty);
+
+	eba_rotate_left(dirty->eba, positions);
+	eba_dirty_moved_(dirty, positions);
+}
+
+void eba_dirty_rotate_right(struct eba_dirty *dirty, unsigned long positions)
+{
+	eembed_assert(dirty);
+
+	eba_rotate_right(dirty->eba, positions);
+	eba_dirty_moved_(dirty, positions);
+}
+
+void eba_dirty_shift_left(struct eba_dirty *dirty, unsigned long positions)
+{
+	eembed_assert(dirty);
+
+	eba_shift_left(dirty->eba, positions);
+	eba_dirty_moved_(dirty, positions);
+}
+
+void eba_dirty_shift_right(struct eba_dirty *dirty, unsigned long positions)
+{
+	eembed_assert(dirty);
+
+	eba_shift_right(dirty->eba, positions);
+	eba_dirty_moved_(dirty, positions);
+}
+
+void eba_dirty_shift_left_fill(struct eba_dirty *dirty,
+			       unsigned long positions, unsigned char fillval)
+{
+	eembed_assert(dirty);
+
+	eba_shift_left_fill(dirty->eba, positions, fillval);
+	eba_dirty_moved_(dirty, positions);
+}
+
+void eba_dirty_shift_right_fill(struct eba_dirty *dirty,
+				unsigned long positions, unsigned char fillval)
+{
+	eembed_assert(dirty);
+
+	eba_shift_right_fill(dirty->eba, positions, fillval);
+	eba_dirty_moved_(dirty, positions);
+}
+#endif /* (!(EBA_SKIP_SHIFTS)) */
+
+#if (!(EBA_SKIP_COPY_BITS))
+void eba_dirty_copy_bits(struct eba_dirty *dirty, unsigned long dst_index,
+			 struct eba *src, unsigned long src_index,
+			 unsigned long nbits)
+{
+	eembed_assert(dirty);
+
+	eba_copy_bits(dirty->eba, dst_index, src, src_index, nbits);
+	eba_dirty_mark_bits(dirty, dst_index, nbits);
+}
+#endif /* (!(EBA_SKIP_COPY_BITS)) */
+
+int eba_dirty_next(struct eba_dirty *dirty, size_t offset, size_t *start,
+		   size_t *len)
+{
+	size_t region = 0;
+	size_t end = 0;
+
+	eembed_assert(dirty);
+	eembed_assert(start);
+	eembed_assert(len);
+
+	if (offset >= dirty->eba->size_bytes) {
+		return 1;
+	}
+	region = offset >> dirty->region_shift;
+	while (region < dirty->regions) {
+		/* a clean byte of marks skips CHAR_BIT regions */
+		if (!(region % CHAR_BIT)
+		    && !dirty->marks.bits[region / CHAR_BIT]) {
+			region += CHAR_BIT;
+		} else if (eba_get(&dirty->marks, region)) {
+			break;
+		} else {
+			++region;
+		}
+	}
+	if (region >= dirty->regions) {
+		return 1;
+	}
+	for (end = region + 1; end < dirty->regions; ++end) {
+		if (!eba_get(&dirty->marks, end)) {
+			break;
+		}
+	}
+	*start = region << dirty->region_shift;
+	end <<= dirty->region_shift;
+	if (end > dirty->eba->size_bytes) {
+		end = dirty->eba->size_bytes;
+	}
+	*len = end - *start;
+	return 0;
+}
+
+void eba_dirty_clear_range(struct eba_dirty *dirty, size_t start,
+			   size_t len)
+{
+	size_t region = 0;
+	size_t end = 0;
+
+	eembed_assert(dirty);
+
+	if (!len) {
+		return;
+	}
+	region = start >> dirty->region_shift;
+	end = (start + (len - 1)) >> dirty->region_shift;
+	for (; (region <= end) && (region < dirty->regions); ++region) {
+		eba_set(&dirty->marks, region, 0);
 	}
 }
 
-static void eba_shift_right_el_(struct eba *eba, unsigned long positions,
-				enum eba_shift_fill_val fill)
+void eba_dirty_clear(struct eba_dirty *dirty)
 {
-	unsigned long i = 0;
-	size_t shift_bytes = 0;
-	unsigned char lowest = 0x00;
-	size_t size_bits = 0;
-	size_t shift_bits = 0;
-	unsigned char *buf = NULL;
-	size_t buf_size = 0;
-	size_t tmp_size = Eba_stack_buf_size;
-	unsigned char tmp[Eba_stack_buf_size];
+	eembed_assert(dirty);
 
-	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+	eembed_memset(dirty->marks.bits, 0x00, dirty->marks.size_bytes);
+}
 
-	buf = eba->bits;
-	buf_size = eba->size_bytes;
-	size_bits = eba->size_bytes * CHAR_BIT;
+#endif /* EBA_SKIP_DIRTY */
 
-	if (positions >= size_bits) {
-		if (fill == eba_fill_ring) {
-			positions = positions % size_bits;
-		} else {
-			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
-			eembed_memset(eba->bits, all_vals, eba->size_bytes);
-			return;
+#if (!(EBA_SKIP_BATCH))
+
+size_t eba_test_batch(struct eba *eba, const unsigned long *idx, size_t n,
+		      unsigned char *out)
+{
+	unsigned char bit = 0;
+	size_t found = 0;
+	size_t ahead = 0;
+	size_t i = 0;
+
+	eembed_assert(eba);
+	eembed_assert(idx || !n);
+
+	for (i = 0; i < n && i < EBA_BATCH_PREFETCH_DISTANCE; ++i) {
+		Eba_prefetch_(eba_bit_byte_(eba, idx[i]));
+	}
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_BATCH_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			Eba_prefetch_(eba_bit_byte_(eba, idx[ahead]));
+		}
+		eembed_assert(idx[i] < (eba->size_bytes * CHAR_BIT));
+		bit = (*eba_bit_byte_(eba, idx[i]) >> (idx[i] % CHAR_BIT));
+		bit &= 0x01;
+		if (out) {
+			out[i] = bit;
 		}
+		found += bit;
 	}
+	return found;
+}
 
-	if (positions == 0) {
-		return;
+#endif /* EBA_SKIP_BATCH */
+
+#if (!(EBA_SKIP_BITMATRIX))
+
+/* the transpose works on square tiles of this many bits, small enough
+ * that the source and destination rows of a tile stay in the L1 cache;
+ * a multiple of 64 */
+#ifndef EBA_BITMATRIX_TILE_BITS
+#define EBA_BITMATRIX_TILE_BITS 256
+#endif
+
+size_t eba_bitmatrix_row_bytes(size_t cols)
+{
+	size_t word_bits = sizeof(unsigned long) * CHAR_BIT;
+	size_t words = (cols / word_bits) + ((cols % word_bits) ? 1 : 0);
+
+	return words * sizeof(unsigned long);
+}
+
+size_t eba_bitmatrix_size_bytes(size_t rows, size_t cols)
+{
+	return rows * eba_bitmatrix_row_bytes(cols);
+}
+
+int eba_bitmatrix_init(struct eba_bitmatrix *matrix, unsigned char *bits,
+		       size_t bits_len, size_t rows, size_t cols)
+{
+	size_t size_bytes = eba_bitmatrix_size_bytes(rows, cols);
+
+	eembed_assert(matrix);
+
+	if ((!rows) || (!cols) || (!bits) || (bits_len < size_bytes)) {
+		return 1;
 	}
+	matrix->eba.bits = bits;
+	matrix->eba.size_bytes = size_bytes;
+	matrix->eba.endian = eba_endian_little;
+	matrix->rows = rows;
+	matrix->cols = cols;
+	matrix->row_bytes = eba_bitmatrix_row_bytes(cols);
+	eembed_memset(bits, 0x00, size_bytes);
+	return 0;
+}
 
-	shift_bytes = positions / CHAR_BIT;
-	while (shift_bytes) {
-		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
-		if (fill == eba_fill_ring) {
-			eembed_memcpy(tmp, buf, mv_bytes);
-		}
-		eembed_memmove(buf, buf + mv_bytes, buf_size - mv_bytes);
-		eembed_memcpy(buf + buf_size - mv_bytes, tmp, mv_bytes);
+#if (!(EBA_SKIP_NEW))
+struct eba_bitmatrix *eba_bitmatrix_new(size_t rows, size_t cols)
+{
+	struct eba_bitmatrix *matrix = NULL;
+	size_t header_size = 0;
+	size_t size_bytes = 0;
 
-		shift_bytes -= mv_bytes;
+	if ((!rows) || (!cols)) {
+		return NULL;
+	}
+	header_size = eembed_align(sizeof(struct eba_bitmatrix));
+	size_bytes = eba_bitmatrix_size_bytes(rows, cols);
+	matrix = (struct eba_bitmatrix *)eembed_malloc(header_size
+						       + size_bytes);
+	if (!matrix) {
+		return NULL;
 	}
+	eba_bitmatrix_init(matrix, ((unsigned char *)matrix) + header_size,
+			   size_bytes, rows, cols);
+	return matrix;
+}
 
-	shift_bits = positions % CHAR_BIT;
-	if (shift_bits == 0) {
-		return;
+void eba_bitmatrix_free(struct eba_bitmatrix *matrix)
+{
+	eembed_free(matrix);
+}
+#endif /* (!(EBA_SKIP_NEW)) */
+
+unsigned char eba_bitmatrix_get(struct eba_bitmatrix *matrix, size_t row,
+				size_t col)
+{
+	unsigned char *byte = NULL;
+
+	eembed_assert(matrix);
+	eembed_assert(row < matrix->rows);
+	eembed_assert(col < matrix->cols);
+
+	byte = matrix->eba.bits + (row * matrix->row_bytes) + (col / CHAR_BIT);
+	return (*byte >> (col % CHAR_BIT)) & 0x01;
+}
+
+void eba_bitmatrix_set(struct eba_bitmatrix *matrix, size_t row, size_t col,
+		       unsigned char val)
+{
+	unsigned char *byte = NULL;
+	unsigned char mask = 0;
+
+	eembed_assert(matrix);
+	eembed_assert(row < matrix->rows);
+	eembed_assert(col < matrix->cols);
+
+	byte = matrix->eba.bits + (row * matrix->row_bytes) + (col / CHAR_BIT);
+	mask = (unsigned char)(1U << (col % CHAR_BIT));
+	if (val) {
+		*byte |= mask;
+	} else {
+		*byte &= (unsigned char)~mask;
 	}
+}
 
-	switch (fill) {
-	case eba_fill_zero:
-		lowest = 0x00;
-		break;
-	case eba_fill_one:
-		lowest = 0xFF;
-		break;
-	case eba_fill_ring:
-		lowest = buf[0];
-		break;
+struct eba *eba_bitmatrix_row(struct eba_bitmatrix *matrix, size_t row,
+			      struct eba *view)
+{
+	eembed_assert(matrix);
+	eembed_assert(view);
+	eembed_assert(row < matrix->rows);
+
+	view->bits = matrix->eba.bits + (row * matrix->row_bytes);
+	view->size_bytes = matrix->row_bytes;
+	view->endian = eba_endian_little;
+	return view;
+}
+
+void eba_bitmatrix_get_col(struct eba_bitmatrix *matrix, size_t col,
+			   struct eba *out)
+{
+	size_t row = 0;
+
+	eembed_assert(matrix);
+	eembed_assert(out);
+	eembed_assert((out->size_bytes * CHAR_BIT) >= matrix->rows);
+
+	for (row = 0; row < matrix->rows; ++row) {
+		eba_set(out, row, eba_bitmatrix_get(matrix, row, col));
 	}
-	for (i = 0; i < buf_size; ++i) {
-		unsigned char hi_val = i < (buf_size - 1) ? buf[i + 1] : lowest;
-		unsigned char lo_val = buf[i];
-		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
-		unsigned u16_b = (u16_a >> shift_bits);
-		unsigned char val = 0xFF & ((unsigned char)u16_b);
-		buf[i] = val;
+}
+
+void eba_bitmatrix_set_col(struct eba_bitmatrix *matrix, size_t col,
+			   struct eba *in)
+{
+	size_t row = 0;
+
+	eembed_assert(matrix);
+	eembed_assert(in);
+	eembed_assert((in->size_bytes * CHAR_BIT) >= matrix->rows);
+
+	for (row = 0; row < matrix->rows; ++row) {
+		eba_bitmatrix_set(matrix, row, col, eba_get(in, row));
 	}
-	return;
 }
 
-static void eba_shift_right_(struct eba *eba, unsigned long positions,
-			     enum eba_shift_fill_val fill)
+unsigned long eba_bitmatrix_row_popcount(struct eba_bitmatrix *matrix,
+					 size_t row)
 {
-	if (eba->endian == eba_big_endian) {
-		eba_shift_right_be_(eba, positions, fill);
-	} else {
-		eba_shift_right_el_(eba, positions, fill);
+	eembed_assert(matrix);
+	eembed_assert(row < matrix->rows);
+
+	/* the padding bits are clear, so whole words may be counted */
+	return eba_popcount_bytes_(matrix->eba.bits
+				   + (row * matrix->row_bytes),
+				   matrix->row_bytes);
+}
+
+/* a block kernel transposes the bits of one byte column of a group of
+ * rows, which starts on a multiple of the group height */
+typedef void (*eba_bitmatrix_block_func_)(struct eba_bitmatrix *dst,
+					  struct eba_bitmatrix *src,
+					  size_t row, size_t col_byte);
+
+/* the byte at col_byte of each of n rows; rows past the end are zero */
+static void eba_bitmatrix_gather_(struct eba_bitmatrix *src, size_t row,
+				  size_t col_byte, unsigned char *in,
+				  size_t n)
+{
+	unsigned char *bytes = src->eba.bits + (row * src->row_bytes);
+	size_t i = 0;
+
+	for (i = 0; i < n && (row + i) < src->rows; ++i) {
+		in[i] = bytes[col_byte];
+		bytes += src->row_bytes;
+	}
+	for (; i < n; ++i) {
+		in[i] = 0;
 	}
 }
 
-static void eba_shift_left_be_(struct eba *eba, unsigned long positions,
-			       enum eba_shift_fill_val fill)
+/* the destination row which holds source column bit of col_byte,
+ * or NULL if the source has no such column */
+static unsigned char *eba_bitmatrix_dst_(struct eba_bitmatrix *dst,
+					 size_t row, size_t col_byte,
+					 size_t bit)
 {
-	unsigned long i = 0;
-	size_t shift_bytes = 0;
-	unsigned char highest = 0x00;
-	size_t shift_bits = 0;
-	size_t size_bits = 0;
-	unsigned char *buf = NULL;
-	size_t buf_size = 0;
-	size_t tmp_size = Eba_stack_buf_size;
-	unsigned char tmp[Eba_stack_buf_size];
+	size_t dst_row = (col_byte * CHAR_BIT) + bit;
 
-	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+	if (dst_row >= dst->rows) {
+		return NULL;
+	}
+	return dst->eba.bits + (dst_row * dst->row_bytes) + (row / CHAR_BIT);
+}
 
-	size_bits = eba->size_bytes * CHAR_BIT;
-	if (positions >= size_bits) {
-		if (fill == eba_fill_ring) {
-			positions = positions % size_bits;
-		} else {
-			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
-			eembed_memset(eba->bits, all_vals, eba->size_bytes);
-			return;
+/* transposes the square block of bytes: bit j of in[i] becomes
+ * bit i of out[j] */
+static void eba_transpose_bytes_(const unsigned char *in, unsigned char *out)
+{
+#if ((CHAR_BIT == 8) && (ULONG_MAX > 0xFFFFFFFFUL))
+	/* an 8x8 block in a word, with three rounds of swapping bits
+	 * across the diagonal: single bits, pairs, then nibbles */
+	unsigned long x = 0;
+	unsigned long t = 0;
+	size_t i = 0;
+
+	for (i = 0; i < 8; ++i) {
+		x |= ((unsigned long)in[i]) << (8 * i);
+	}
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAUL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCUL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0UL;
+	x = x ^ t ^ (t << 28);
+	for (i = 0; i < 8; ++i) {
+		out[i] = (unsigned char)(x >> (8 * i));
+	}
+#else
+	size_t i = 0;
+	size_t j = 0;
+
+	for (j = 0; j < CHAR_BIT; ++j) {
+		out[j] = 0;
+		for (i = 0; i < CHAR_BIT; ++i) {
+			out[j] |= (unsigned char)(((in[i] >> j) & 0x01) << i);
 		}
 	}
+#endif
+}
 
-	if (positions == 0) {
-		return;
+static void eba_bitmatrix_block_c89_(struct eba_bitmatrix *dst,
+				     struct eba_bitmatrix *src, size_t row,
+				     size_t col_byte)
+{
+	unsigned char in[CHAR_BIT];
+	unsigned char out[CHAR_BIT];
+	unsigned char *d = NULL;
+	size_t j = 0;
+
+	eba_bitmatrix_gather_(src, row, col_byte, in, CHAR_BIT);
+	eba_transpose_bytes_(in, out);
+	for (j = 0; j < CHAR_BIT; ++j) {
+		d = eba_bitmatrix_dst_(dst, row, col_byte, j);
+		if (d) {
+			*d = out[j];
+		}
 	}
+}
 
-	buf = eba->bits;
-	buf_size = eba->size_bytes;
+#if (Eba_isa_dispatch_)
+/* pmovmskb collects the high bit of each byte, which is one column of a
+ * group of rows; shifting each byte left brings up the next column, so
+ * eight of these transpose a byte column of 16, 32 or 64 rows */
+__attribute__((target("sse2")))
+static void eba_bitmatrix_block_sse2_(struct eba_bitmatrix *dst,
+				      struct eba_bitmatrix *src, size_t row,
+				      size_t col_byte)
+{
+	unsigned char in[16];
+	unsigned char *d = NULL;
+	unsigned mask = 0;
+	__m128i v;
+	size_t j = 0;
 
-	shift_bytes = positions / CHAR_BIT;
-	while (shift_bytes) {
-		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
-		if (fill == eba_fill_ring) {
-			eembed_memcpy(tmp, buf, mv_bytes);
+	eba_bitmatrix_gather_(src, row, col_byte, in, 16);
+	v = _mm_loadu_si128((const __m128i *)in);
+	for (j = 8; j-- > 0;) {
+		mask = (unsigned)_mm_movemask_epi8(v);
+		v = _mm_slli_epi64(v, 1);
+		d = eba_bitmatrix_dst_(dst, row, col_byte, j);
+		if (d) {
+			d[0] = (unsigned char)mask;
+			d[1] = (unsigned char)(mask >> 8);
 		}
-		eembed_memmove(buf, buf + mv_bytes, buf_size - mv_bytes);
-		eembed_memcpy(buf + buf_size - mv_bytes, tmp, mv_bytes);
+	}
+}
 
-		shift_bytes -= mv_bytes;
+__attribute__((target("avx2")))
+static void eba_bitmatrix_block_avx2_(struct eba_bitmatrix *dst,
+				      struct eba_bitmatrix *src, size_t row,
+				      size_t col_byte)
+{
+	unsigned char in[32];
+	unsigned char *d = NULL;
+	unsigned mask = 0;
+	__m256i v;
+	size_t i = 0;
+	size_t j = 0;
+
+	eba_bitmatrix_gather_(src, row, col_byte, in, 32);
+	v = _mm256_loadu_si256((const __m256i *)in);
+	for (j = 8; j-- > 0;) {
+		mask = (unsigned)_mm256_movemask_epi8(v);
+		v = _mm256_slli_epi64(v, 1);
+		d = eba_bitmatrix_dst_(dst, row, col_byte, j);
+		for (i = 0; d && i < 4; ++i) {
+			d[i] = (unsigned char)(mask >> (8 * i));
+		}
 	}
+}
 
-	shift_bits = positions % CHAR_BIT;
+__attribute__((target("avx512f,avx512bw")))
+static void eba_bitmatrix_block_avx512_(struct eba_bitmatrix *dst,
+					struct eba_bitmatrix *src, size_t row,
+					size_t col_byte)
+{
+	unsigned char in[64];
+	unsigned char *d = NULL;
+	unsigned long mask = 0;
+	__m512i v;
+	size_t i = 0;
+	size_t j = 0;
 
-	switch (fill) {
-	case eba_fill_zero:
-		highest = 0x00;
+	eba_bitmatrix_gather_(src, row, col_byte, in, 64);
+	v = _mm512_loadu_si512((const void *)in);
+	for (j = 8; j-- > 0;) {
+		mask = (unsigned long)_mm512_movepi8_mask(v);
+		v = _mm512_slli_epi64(v, 1);
+		d = eba_bitmatrix_dst_(dst, row, col_byte, j);
+		for (i = 0; d && i < 8; ++i) {
+			d[i] = (unsigned char)(mask >> (8 * i));
+		}
+	}
+}
+#endif /* Eba_isa_dispatch_ */
+
+int eba_bitmatrix_transpose(struct eba_bitmatrix *dst,
+			    struct eba_bitmatrix *src)
+{
+	eba_bitmatrix_block_func_ block = eba_bitmatrix_block_c89_;
+	size_t height = CHAR_BIT;
+	size_t tile_bytes = EBA_BITMATRIX_TILE_BITS / CHAR_BIT;
+	size_t col_bytes = 0;
+	size_t row0 = 0;
+	size_t byte0 = 0;
+	size_t row = 0;
+	size_t byte = 0;
+
+	eembed_assert(dst);
+	eembed_assert(src);
+	eembed_assert(dst->eba.bits != src->eba.bits);
+
+	if ((dst->rows != src->cols) || (dst->cols != src->rows)) {
+		return 1;
+	}
+#if (Eba_isa_dispatch_)
+	/* a row is padded to whole words, so even the last group of 64
+	 * rows has a byte in the destination for each */
+	switch (eba_isa_) {
+	case eba_isa_avx512:
+		block = eba_bitmatrix_block_avx512_;
+		height = 64;
 		break;
-	case eba_fill_one:
-		highest = 0xFF;
+	case eba_isa_avx2:
+		block = eba_bitmatrix_block_avx2_;
+		height = 32;
 		break;
-	case eba_fill_ring:
-		highest = buf[0];
+	case eba_isa_sse2:
+		block = eba_bitmatrix_block_sse2_;
+		height = 16;
+		break;
+	case eba_isa_portable:
+	default:
 		break;
 	}
-	for (i = 0; i < buf_size; ++i) {
-		unsigned char hi_val = buf[i];
-		unsigned char lo_val =
-		    i < (buf_size - 1) ? buf[i + 1] : highest;
-		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
-		unsigned u16_b = ((u16_a << shift_bits) >> 8);
-		unsigned char val = 0xFF & ((unsigned char)u16_b);
-		buf[i] = val;
+#endif
+	col_bytes = (src->cols / CHAR_BIT) + ((src->cols % CHAR_BIT) ? 1 : 0);
+	for (row0 = 0; row0 < src->rows; row0 += EBA_BITMATRIX_TILE_BITS) {
+		for (byte0 = 0; byte0 < col_bytes; byte0 += tile_bytes) {
+			for (row = row0; row < src->rows
+			     && row < row0 + EBA_BITMATRIX_TILE_BITS;
+			     row += height) {
+				for (byte = byte0; byte < col_bytes
+				     && byte < byte0 + tile_bytes; ++byte) {
+					block(dst, src, row, byte);
+				}
+			}
+		}
 	}
+	return 0;
 }
 
-static void eba_shift_left_el_(struct eba *eba, unsigned long positions,
-			       enum eba_shift_fill_val fill)
+#endif /* EBA_SKIP_BITMATRIX */
+
+#if (Eba_need_gf2_)
+
+/* dst = x ^ y, a word at a time, len being a whole number of words;
+ * dst may be x */
+static void eba_gf2_xor_(unsigned char *dst, const unsigned char *x,
+			 const unsigned char *y, size_t len)
 {
-	unsigned char *buf = NULL;
+	unsigned long word = 0;
 	size_t i = 0;
-	size_t buf_size = 0;
-	size_t shift_bytes = 0;
-	size_t shift_bits = 0;
-	size_t size_bits = 0;
-	unsigned char highest = 0;
-	size_t tmp_size = Eba_stack_buf_size;
-	unsigned char tmp[Eba_stack_buf_size];
 
-	eembed_memset(tmp, (fill == eba_fill_one ? 0xFF : 0x00), tmp_size);
+	for (i = 0; i < len; i += Eba_ul_bytes) {
+		word = eba_load_ul_(x + i) ^ eba_load_ul_(y + i);
+		eba_store_ul_(dst + i, word);
+	}
+}
+
+static unsigned char *eba_gf2_row_(struct eba_bitmatrix *m, size_t row)
+{
+	return m->eba.bits + (row * m->row_bytes);
+}
+
+void eba_gf2_mul_vec(struct eba *y, struct eba_bitmatrix *a, struct eba *x)
+{
+	unsigned long count = 0;
+	unsigned long unused = 0;
+	size_t row = 0;
+	size_t col = 0;
+	int by_words = 0;
+
+	eembed_assert(y);
+	eembed_assert(a);
+	eembed_assert(x);
+	eembed_assert(y->bits != x->bits);
+	eembed_assert((x->size_bytes * CHAR_BIT) >= a->cols);
+	eembed_assert((y->size_bytes * CHAR_BIT) >= a->rows);
+
+	/* the row padding is clear, so the bits of x past cols drop out */
+	by_words = (x->endian == eba_endian_little)
+	    && (x->size_bytes >= a->row_bytes);
+
+	for (row = 0; row < a->rows; ++row) {
+		count = 0;
+		if (by_words) {
+			eba_count_bytes_(eba_gf2_row_(a, row), x->bits,
+					 a->row_bytes, eba_count_and_, &count,
+					 &unused);
+		} else {
+			for (col = 0; col < a->cols; ++col) {
+				count += eba_bitmatrix_get(a, row, col)
+				    & eba_get(x, col);
+			}
+		}
+		eba_set(y, row, (unsigned char)(count & 0x01));
+	}
+}
+
+size_t eba_gf2_mul_scratch_bytes(struct eba_bitmatrix *b)
+{
+	eembed_assert(b);
+
+	return (((size_t)1) << CHAR_BIT) * b->row_bytes;
+}
+
+int eba_gf2_mul(struct eba_bitmatrix *c, struct eba_bitmatrix *a,
+		struct eba_bitmatrix *b, unsigned char *scratch,
+		size_t scratch_len)
+{
+	unsigned char *table = scratch;
+	unsigned long word = 0;
+	size_t a_bytes = 0;
+	size_t entries = 0;
+	size_t entry = 0;
+	size_t brow = 0;
+	size_t row = 0;
+	size_t k = 0;
+	unsigned char byte = 0;
+
+	eembed_assert(c);
+	eembed_assert(a);
+	eembed_assert(b);
+
+	if ((a->cols != b->rows) || (c->rows != a->rows)
+	    || (c->cols != b->cols)) {
+		return 1;
+	}
+	if (scratch && (scratch_len < eba_gf2_mul_scratch_bytes(b))) {
+		return 1;
+	}
+	eembed_assert(c->eba.bits != a->eba.bits);
+	eembed_assert(c->eba.bits != b->eba.bits);
+
+	eembed_memset(c->eba.bits, 0x00, c->eba.size_bytes);
 
-	eba_assert_not_null_(eba);
-	eembed_assert(CHAR_BIT == 8);
-	eembed_assert(eba->size_bytes);
-	eembed_assert(eba->size_bytes < (ULONG_MAX * 8));
+	if (!scratch) {
+		/* each row of c is the XOR of the rows of b picked by the
+		 * set bits of the row of a */
+		for (row = 0; row < a->rows; ++row) {
+			for (k = 0; k < a->row_bytes; k += Eba_ul_bytes) {
+				word = eba_load_ul_(eba_gf2_row_(a, row) + k);
+				for (; word; word &= (word - 1)) {
+					brow = (k * CHAR_BIT)
+					    + eba_ctz_ul_(word);
+					eba_gf2_xor_(eba_gf2_row_(c, row),
+						     eba_gf2_row_(c, row),
+						     eba_gf2_row_(b, brow),
+						     c->row_bytes);
+				}
+			}
+		}
+		return 0;
+	}
 
-	size_bits = eba->size_bytes * CHAR_BIT;
-	if (positions >= size_bits) {
-		if (fill == eba_fill_ring) {
-			positions = positions % size_bits;
-		} else {
-			int all_vals = (fill == eba_fill_zero) ? 0 : -1;
-			eembed_memset(eba->bits, all_vals, eba->size_bytes);
-			return;
+	/* the method of four Russians: for each byte column of a, a table
+	 * of every XOR of those rows of b, then one XOR per row of c */
+	a_bytes = (a->cols / CHAR_BIT) + ((a->cols % CHAR_BIT) ? 1 : 0);
+	for (k = 0; k < a_bytes; ++k) {
+		brow = k * CHAR_BIT;
+		entries = b->rows - brow;
+		entries = ((size_t)1) << ((entries < CHAR_BIT) ? entries
+					  : CHAR_BIT);
+		eembed_memset(table, 0x00, b->row_bytes);
+		for (entry = 1; entry < entries; ++entry) {
+			/* the entry without its lowest bit, plus that row */
+			eba_gf2_xor_(table + (entry * b->row_bytes),
+				     table + ((entry & (entry - 1))
+					      * b->row_bytes),
+				     eba_gf2_row_(b, brow + eba_ctz_ul_(entry)),
+				     b->row_bytes);
+		}
+		for (row = 0; row < a->rows; ++row) {
+			byte = eba_gf2_row_(a, row)[k];
+			if (byte) {
+				eba_gf2_xor_(eba_gf2_row_(c, row),
+					     eba_gf2_row_(c, row),
+					     table + (byte * b->row_bytes),
+					     c->row_bytes);
+			}
 		}
 	}
+	return 0;
+}
 
-	if (positions == 0) {
-		return;
+size_t eba_gf2_row_reduce(struct eba_bitmatrix *m)
+{
+	unsigned long tmp = 0;
+	unsigned char *pivot_row = NULL;
+	unsigned char *other = NULL;
+	size_t rank = 0;
+	size_t pivot = 0;
+	size_t col = 0;
+	size_t row = 0;
+	size_t from = 0;
+	size_t i = 0;
+
+	eembed_assert(m);
+
+	for (col = 0; col < m->cols && rank < m->rows; ++col) {
+		for (pivot = rank; pivot < m->rows; ++pivot) {
+			if (eba_bitmatrix_get(m, pivot, col)) {
+				break;
+			}
+		}
+		if (pivot == m->rows) {
+			continue;
+		}
+		/* the columns before col are clear in the pivot row, so
+		 * the words before the one holding col may be skipped */
+		from = (col / Eba_ul_bits) * Eba_ul_bytes;
+		pivot_row = eba_gf2_row_(m, pivot);
+		if (pivot != rank) {
+			other = eba_gf2_row_(m, rank);
+			for (i = from; i < m->row_bytes; i += Eba_ul_bytes) {
+				tmp = eba_load_ul_(other + i);
+				eba_store_ul_(other + i,
+					      eba_load_ul_(pivot_row + i));
+				eba_store_ul_(pivot_row + i, tmp);
+			}
+			pivot_row = other;
+		}
+		for (row = 0; row < m->rows; ++row) {
+			if (row != rank && eba_bitmatrix_get(m, row, col)) {
+				other = eba_gf2_row_(m, row);
+				eba_gf2_xor_(other + from, other + from,
+					     pivot_row + from,
+					     m->row_bytes - from);
+			}
+		}
+		++rank;
 	}
+	return rank;
+}
 
-	buf = eba->bits;
-	buf_size = eba->size_bytes;
+#endif /* EBA_SKIP_GF2 */
 
-	shift_bytes = positions / 8;
-	while (shift_bytes) {
-		size_t mv_bytes = eba_min_(shift_bytes, tmp_size);
+#if (Eba_need_bitslice_)
 
-		if (fill == eba_fill_ring) {
-			unsigned char *orig = buf + (buf_size - mv_bytes);
-			eembed_memcpy(tmp, orig, mv_bytes);
-		};
+int eba_bitslice_pack(struct eba_bitmatrix *planes,
+		      const unsigned long *values, size_t n)
+{
+	unsigned long words[sizeof(unsigned long) * CHAR_BIT];
+	unsigned long value = 0;
+	size_t base = 0;
+	size_t i = 0;
+	size_t j = 0;
 
-		eembed_memmove(buf + mv_bytes, buf, buf_size - mv_bytes);
-		eembed_memcpy(buf, tmp, mv_bytes);
+	eembed_assert(planes);
+	eembed_assert(values || !n);
 
-		shift_bytes -= mv_bytes;
+	if ((planes->cols != n) || (planes->rows > Eba_ul_bits)) {
+		return 1;
+	}
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		for (j = 0; j < planes->rows; ++j) {
+			words[j] = 0;
+		}
+		for (i = 0; i < Eba_ul_bits && (base + i) < n; ++i) {
+			value = values[base + i];
+			if (planes->rows < Eba_ul_bits) {
+				value &= ((1UL << planes->rows) - 1);
+			}
+			for (; value; value &= (value - 1)) {
+				words[eba_ctz_ul_(value)] |= (1UL << i);
+			}
+		}
+		for (j = 0; j < planes->rows; ++j) {
+			eba_store_ul_(planes->eba.bits + (j * planes->row_bytes)
+				      + (base / CHAR_BIT), words[j]);
+		}
 	}
+	return 0;
+}
 
-	shift_bits = positions % CHAR_BIT;
+void eba_bitslice_unpack(unsigned long *values,
+			 struct eba_bitmatrix *planes)
+{
+	unsigned long word = 0;
+	size_t base = 0;
+	size_t i = 0;
+	size_t j = 0;
 
-	switch (fill) {
-	case eba_fill_zero:
-		highest = 0x00;
-		break;
-	case eba_fill_one:
-		highest = 0xFF;
-		break;
-	case eba_fill_ring:
-		highest = buf[buf_size - 1];
-		break;
-	};
-	for (i = 0; i < buf_size; ++i) {
-		size_t byte_pos = buf_size - (1 + i);
-		unsigned char hi_val = buf[byte_pos];
-		unsigned char lo_val = byte_pos ? buf[byte_pos - 1] : highest;
-		unsigned u16_a = (((unsigned)hi_val) << 8) | ((unsigned)lo_val);
-		unsigned u16_b = ((u16_a << shift_bits) >> 8);
-		unsigned char val = 0xFF & ((unsigned char)u16_b);
-		buf[byte_pos] = val;
-	}
+	eembed_assert(planes);
+	eembed_assert(values);
+	eembed_assert(planes->rows <= Eba_ul_bits);
 
-	return;
+	for (i = 0; i < planes->cols; ++i) {
+		values[i] = 0;
+	}
+	for (j = 0; j < planes->rows; ++j) {
+		for (base = 0; base < planes->cols; base += Eba_ul_bits) {
+			word = eba_load_ul_(planes->eba.bits
+					    + (j * planes->row_bytes)
+					    + (base / CHAR_BIT));
+			for (; word; word &= (word - 1)) {
+				i = base + eba_ctz_ul_(word);
+				values[i] |= (1UL << j);
+			}
+		}
+	}
 }
 
-static void eba_shift_left_(struct eba *eba, unsigned long positions,
-			    enum eba_shift_fill_val fill)
+/* for a word of values, the lanes less than c and equal to c, from the
+ * top plane down; stops once no lane is still equal */
+static void eba_bitslice_cmp_(struct eba_bitmatrix *planes, size_t byte,
+			      unsigned long c, unsigned long *lt,
+			      unsigned long *eq)
 {
-	if (eba->endian == eba_big_endian) {
-		eba_shift_left_be_(eba, positions, fill);
-	} else {
-		eba_shift_left_el_(eba, positions, fill);
+	const unsigned char *bits = planes->eba.bits + byte;
+	unsigned long plane = 0;
+	unsigned long less = 0;
+	unsigned long same = ~0UL;
+	size_t j = planes->rows;
+
+	if ((planes->rows < Eba_ul_bits) && (c >> planes->rows)) {
+		*lt = ~0UL;
+		*eq = 0;
+		return;
+	}
+	while (j-- > 0 && same) {
+		plane = eba_load_ul_(bits + (j * planes->row_bytes));
+		if ((c >> j) & 0x01) {
+			less |= same & ~plane;
+			same &= plane;
+		} else {
+			same &= ~plane;
+		}
 	}
+	*lt = less;
+	*eq = same;
 }
 
-void eba_rotate_right(struct eba *eba, unsigned long positions)
+enum eba_bitslice_op_ {
+	eba_bitslice_lt_,
+	eba_bitslice_le_,
+	eba_bitslice_eq_,
+	eba_bitslice_between_
+};
+
+static int eba_bitslice_eval_(struct eba *out, struct eba_bitmatrix *planes,
+			      unsigned long lo, unsigned long hi,
+			      enum eba_bitslice_op_ op)
 {
-	eba_shift_right_(eba, positions, eba_fill_ring);
+	unsigned long result = 0;
+	unsigned long lt = 0;
+	unsigned long eq = 0;
+	unsigned long lt2 = 0;
+	unsigned long eq2 = 0;
+	size_t tail = 0;
+	size_t byte = 0;
+
+	eembed_assert(out);
+	eembed_assert(planes);
+
+	if ((out->endian != eba_endian_little)
+	    || (out->size_bytes < planes->row_bytes)) {
+		return 1;
+	}
+	for (byte = 0; byte < planes->row_bytes; byte += Eba_ul_bytes) {
+		eba_bitslice_cmp_(planes, byte, hi, &lt, &eq);
+		switch (op) {
+		case eba_bitslice_lt_:
+			result = lt;
+			break;
+		case eba_bitslice_le_:
+			result = lt | eq;
+			break;
+		case eba_bitslice_eq_:
+			result = eq;
+			break;
+		case eba_bitslice_between_:
+			/* lo <= x, and x <= hi */
+			eba_bitslice_cmp_(planes, byte, lo, &lt2, &eq2);
+			result = (~lt2) & (lt | eq);
+			break;
+		}
+		eba_store_ul_(out->bits + byte, result);
+	}
+	/* clear the lanes past the last value */
+	tail = planes->cols % Eba_ul_bits;
+	if (tail) {
+		byte = ((planes->cols / Eba_ul_bits) * Eba_ul_bytes);
+		result = eba_load_ul_(out->bits + byte);
+		eba_store_ul_(out->bits + byte, result & ((1UL << tail) - 1));
+	}
+	return 0;
 }
 
-void eba_rotate_left(struct eba *eba, unsigned long positions)
+int eba_bitslice_lt(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c)
 {
-	eba_shift_left_(eba, positions, eba_fill_ring);
+	return eba_bitslice_eval_(out, planes, 0, c, eba_bitslice_lt_);
 }
 
-void eba_shift_left(struct eba *eba, unsigned long positions)
+int eba_bitslice_le(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c)
 {
-	eba_shift_left_(eba, positions, eba_fill_zero);
+	return eba_bitslice_eval_(out, planes, 0, c, eba_bitslice_le_);
 }
 
-void eba_shift_left_fill(struct eba *eba, unsigned long positions,
-			 unsigned char fillval)
+int eba_bitslice_eq(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c)
 {
-	eba_shift_left_(eba, positions, fillval ? eba_fill_one : eba_fill_zero);
+	return eba_bitslice_eval_(out, planes, 0, c, eba_bitslice_eq_);
 }
 
-void eba_shift_right(struct eba *eba, unsigned long positions)
+int eba_bitslice_between(struct eba *out, struct eba_bitmatrix *planes,
+			 unsigned long lo, unsigned long hi)
 {
-	eba_shift_right_(eba, positions, eba_fill_zero);
+	return eba_bitslice_eval_(out, planes, lo, hi,
+				  eba_bitslice_between_);
 }
 
-void eba_shift_right_fill(struct eba *eba, unsigned long positions,
-			  unsigned char fillval)
+#endif /* EBA_SKIP_BITSLICE */
+
+#if (!(EBA_SKIP_COMPRESS))
+
+#if (Eba_isa_dispatch_)
+/* for words with fewer selected, the ctz loop is quicker */
+#define Eba_compress_dense_ 8
+
+/* vpcompress writes the selected lanes of a vector contiguously, and
+ * vpexpand the reverse; the masked loads and stores never touch the
+ * lanes past n, so neither src nor dst need room to spare */
+__attribute__((target("avx512f")))
+static size_t eba_compress_ui_avx512_(unsigned long word,
+				      const unsigned int *src,
+				      unsigned int *dst)
 {
-	eba_shift_right_(eba, positions,
-			 fillval ? eba_fill_one : eba_fill_zero);
+	__mmask16 m;
+	__m512i v;
+	size_t count = 0;
+	size_t q = 0;
+
+	for (q = 0; q < 4; ++q) {
+		m = (__mmask16)(word >> (16 * q));
+		if (m) {
+			v = _mm512_maskz_loadu_epi32(m, (const void *)
+						     (src + (16 * q)));
+			_mm512_mask_compressstoreu_epi32((void *)(dst + count),
+							 m, v);
+			count += (size_t)__builtin_popcount(m);
+		}
+	}
+	return count;
 }
 
-#endif /* (!(EBA_SKIP_SHIFTS)) */
+__attribute__((target("avx512f")))
+static size_t eba_compress_ul_avx512_(unsigned long word,
+				      const unsigned long *src,
+				      unsigned long *dst)
+{
+	__mmask8 m;
+	__m512i v;
+	size_t count = 0;
+	size_t q = 0;
 
-#if (!(EBA_SKIP_NEW))
+	for (q = 0; q < 8; ++q) {
+		m = (__mmask8)(word >> (8 * q));
+		if (m) {
+			v = _mm512_maskz_loadu_epi64(m, (const void *)
+						     (src + (8 * q)));
+			_mm512_mask_compressstoreu_epi64((void *)(dst + count),
+							 m, v);
+			count += (size_t)__builtin_popcount(m);
+		}
+	}
+	return count;
+}
 
-struct eba *eba_new_endian(unsigned long num_bits, enum eba_endian endian)
+__attribute__((target("avx512f")))
+static size_t eba_expand_ui_avx512_(unsigned long word,
+				    const unsigned int *src,
+				    unsigned int *dst)
 {
-	struct eba *eba = NULL;
-	unsigned char *bytes = NULL;
-	size_t len = 0;
-	size_t eba_s_size = 0;
-	size_t array_size = 0;
+	__mmask16 m;
+	__m512i v;
+	size_t count = 0;
+	size_t q = 0;
 
-	array_size = num_bits / CHAR_BIT;
-	if ((array_size * CHAR_BIT) < num_bits) {
-		array_size += 1;
+	for (q = 0; q < 4; ++q) {
+		m = (__mmask16)(word >> (16 * q));
+		if (m) {
+			v = _mm512_maskz_expandloadu_epi32(m, (const void *)
+							   (src + count));
+			_mm512_mask_storeu_epi32((void *)(dst + (16 * q)), m,
+						 v);
+			count += (size_t)__builtin_popcount(m);
+		}
 	}
+	return count;
+}
 
-	eba_s_size = sizeof(struct eba);
-	len = eembed_align(eba_s_size) + array_size;
-	bytes = (unsigned char *)eembed_malloc(len);
-	if (!bytes) {
-		return NULL;
+__attribute__((target("avx512f")))
+static size_t eba_expand_ul_avx512_(unsigned long word,
+				    const unsigned long *src,
+				    unsigned long *dst)
+{
+	__mmask8 m;
+	__m512i v;
+	size_t count = 0;
+	size_t q = 0;
+
+	for (q = 0; q < 8; ++q) {
+		m = (__mmask8)(word >> (8 * q));
+		if (m) {
+			v = _mm512_maskz_expandloadu_epi64(m, (const void *)
+							   (src + count));
+			_mm512_mask_storeu_epi64((void *)(dst + (8 * q)), m,
+						 v);
+			count += (size_t)__builtin_popcount(m);
+		}
 	}
+	return count;
+}
+#endif /* Eba_isa_dispatch_ */
 
-	eba = eba_from_bytes(bytes, len, endian);
-	eba_set_all(eba, 0x00);
-	return eba;
+size_t eba_compress_ui(struct eba *mask, size_t n, const unsigned int *src,
+		       unsigned int *dst)
+{
+	unsigned long word = 0;
+	size_t count = 0;
+	size_t base = 0;
+
+	eembed_assert(mask);
+	eembed_assert((mask->size_bytes * CHAR_BIT) >= n);
+	eembed_assert((src && dst) || !n);
+
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		word = eba_bits_word_(mask, base, n);
+#if (Eba_isa_dispatch_)
+		if ((eba_isa_ == eba_isa_avx512)
+		    && (__builtin_popcountl(word) >= Eba_compress_dense_)) {
+			count += eba_compress_ui_avx512_(word, src + base,
+							 dst + count);
+			continue;
+		}
+#endif
+		if (word == ~0UL) {
+			eembed_memmove(dst + count, src + base,
+				       Eba_ul_bits * sizeof(unsigned int));
+			count += Eba_ul_bits;
+			continue;
+		}
+		for (; word; word &= (word - 1)) {
+			dst[count++] = src[base + eba_ctz_ul_(word)];
+		}
+	}
+	return count;
 }
 
-struct eba *eba_new(unsigned long num_bits)
+size_t eba_compress_ul(struct eba *mask, size_t n, const unsigned long *src,
+		       unsigned long *dst)
 {
-	return eba_new_endian(num_bits, eba_big_endian);
+	unsigned long word = 0;
+	size_t count = 0;
+	size_t base = 0;
+
+	eembed_assert(mask);
+	eembed_assert((mask->size_bytes * CHAR_BIT) >= n);
+	eembed_assert((src && dst) || !n);
+
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		word = eba_bits_word_(mask, base, n);
+#if (Eba_isa_dispatch_)
+		if ((eba_isa_ == eba_isa_avx512)
+		    && (__builtin_popcountl(word) >= Eba_compress_dense_)) {
+			count += eba_compress_ul_avx512_(word, src + base,
+							 dst + count);
+			continue;
+		}
+#endif
+		if (word == ~0UL) {
+			eembed_memmove(dst + count, src + base,
+				       Eba_ul_bits * sizeof(unsigned long));
+			count += Eba_ul_bits;
+			continue;
+		}
+		for (; word; word &= (word - 1)) {
+			dst[count++] = src[base + eba_ctz_ul_(word)];
+		}
+	}
+	return count;
 }
 
-void eba_free(struct eba *eba)
+size_t eba_expand_ui(struct eba *mask, size_t n, const unsigned int *src,
+		     unsigned int *dst)
 {
-	eembed_free(eba);
+	unsigned long word = 0;
+	size_t count = 0;
+	size_t base = 0;
+
+	eembed_assert(mask);
+	eembed_assert((mask->size_bytes * CHAR_BIT) >= n);
+	eembed_assert((src && dst) || !n);
+
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		word = eba_bits_word_(mask, base, n);
+#if (Eba_isa_dispatch_)
+		if ((eba_isa_ == eba_isa_avx512)
+		    && (__builtin_popcountl(word) >= Eba_compress_dense_)) {
+			count += eba_expand_ui_avx512_(word, src + count,
+						       dst + base);
+			continue;
+		}
+#endif
+		for (; word; word &= (word - 1)) {
+			dst[base + eba_ctz_ul_(word)] = src[count++];
+		}
+	}
+	return count;
 }
-#endif /* #if (!(EBA_SKIP_NEW)) */
 
-static void eba_get_byte_and_offset_(struct eba *eba, unsigned long index,
-				     size_t *byte, unsigned char *offset)
+size_t eba_expand_ul(struct eba *mask, size_t n, const unsigned long *src,
+		     unsigned long *dst)
 {
-	/* compiler does the right thing; no "div"s in the .s files */
-	*byte = index / CHAR_BIT;
-	*offset = index % CHAR_BIT;
-	eembed_assert((*byte) < eba->size_bytes);
+	unsigned long word = 0;
+	size_t count = 0;
+	size_t base = 0;
 
-	if (eba->endian == eba_big_endian) {
-		*byte = (eba->size_bytes - 1) - (*byte);
+	eembed_assert(mask);
+	eembed_assert((mask->size_bytes * CHAR_BIT) >= n);
+	eembed_assert((src && dst) || !n);
+
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		word = eba_bits_word_(mask, base, n);
+#if (Eba_isa_dispatch_)
+		if ((eba_isa_ == eba_isa_avx512)
+		    && (__builtin_popcountl(word) >= Eba_compress_dense_)) {
+			count += eba_expand_ul_avx512_(word, src + count,
+						       dst + base);
+			continue;
+		}
+#endif
+		for (; word; word &= (word - 1)) {
+			dst[base + eba_ctz_ul_(word)] = src[count++];
+		}
 	}
+	return count;
 }
 
-#if (!(EBA_SKIP_TO_STRING))
-char *eba_to_string(struct eba *eba, char *buf, size_t len)
+#if (Eba_isa_dispatch_)
+#undef Eba_compress_dense_
+#endif
+#endif /* EBA_SKIP_COMPRESS */
+
+#if (!(EBA_SKIP_INDICES))
+
+size_t eba_to_indices(struct eba *eba, unsigned long *out, size_t cap)
 {
+	unsigned long word = 0;
+	size_t n = 0;
+	size_t count = 0;
+	size_t base = 0;
 	size_t i = 0;
-	size_t pos = 0;
-	size_t size_bits = 0;
-	size_t done = 0;
 
-	if (!buf) {
-		return NULL;
-	}
-	if (len < 2) {
-		return NULL;
-	}
-	buf[0] = '\0';
-	if (!eba || !eba->bits) {
-		return buf;
-	}
+	eba_assert_not_null_(eba);
+	eembed_assert(out || !cap);
 
-	size_bits = eba->size_bytes * CHAR_BIT;
-	pos = 0;
-	done = 0;
-	if (eba->endian == eba_endian_little) {
-		for (i = 0; pos < (len - 1) && i < size_bits; ++i) {
-			++done;
-			buf[pos++] = eba_get(eba, i) ? '1' : '0';
-			if ((done % CHAR_BIT == 0)
-			    && (i < (size_bits - 1))
-			    && (pos < (len - 1))) {
-				buf[pos++] = ' ';
+	n = eba->size_bytes * CHAR_BIT;
+	for (base = 0; base < n; base += Eba_ul_bits) {
+		word = eba_bits_word_(eba, base, n);
+		if ((word == ~0UL) && ((count + Eba_ul_bits) <= cap)) {
+			for (i = 0; i < Eba_ul_bits; ++i) {
+				out[count + i] = (unsigned long)(base + i);
 			}
+			count += Eba_ul_bits;
+			continue;
 		}
-	} else {
-		for (i = size_bits; pos < (len - 1) && i; --i) {
-			++done;
-			buf[pos++] = eba_get(eba, (i - 1)) ? '1' : '0';
-			if ((done % CHAR_BIT == 0) && (i - 1)
-			    && (pos < (len - 1))) {
-				buf[pos++] = ' ';
+		for (; word; word &= (word - 1)) {
+			if (count < cap) {
+				out[count] = (unsigned long)base
+				    + eba_ctz_ul_(word);
 			}
+			++count;
 		}
 	}
+	return count;
+}
 
-	if ((pos < len) && (done == size_bits)) {
-		buf[pos] = '\0';
-		return buf;
+/* ORs the word into the bits from index base, a multiple of Eba_ul_bits */
+static void eba_or_word_(struct eba *eba, unsigned long base,
+			 unsigned long word)
+{
+	unsigned char *bytes = NULL;
+	size_t k = base / CHAR_BIT;
+	size_t i = 0;
+
+	if ((k + Eba_ul_bytes) <= eba->size_bytes) {
+		if (eba->endian == eba_big_endian) {
+			bytes = eba->bits
+			    + (eba->size_bytes - (k + Eba_ul_bytes));
+			word = eba_reverse_bytes_ul_(word);
+		} else {
+			bytes = eba->bits + k;
+		}
+		eba_store_ul_(bytes, word | eba_load_ul_(bytes));
+		return;
+	}
+	for (i = 0; i < Eba_ul_bytes && (k + i) < eba->size_bytes; ++i) {
+		if (eba->endian == eba_big_endian) {
+			eba->bits[(eba->size_bytes - 1) - (k + i)] |=
+			    (unsigned char)(word >> (CHAR_BIT * i));
+		} else {
+			eba->bits[k + i] |=
+			    (unsigned char)(word >> (CHAR_BIT * i));
+		}
+	}
+}
+
+/* gathers the bits of each word before writing it */
+static void eba_set_indices_(struct eba *eba, const unsigned long *idx,
+			     size_t n)
+{
+	unsigned long word = 0;
+	unsigned long base = 0;
+	unsigned long next = 0;
+	size_t i = 0;
+
+	for (i = 0; i < n; ++i) {
+		eembed_assert(idx[i] < (eba->size_bytes * CHAR_BIT));
+		next = idx[i] - (idx[i] % Eba_ul_bits);
+		if (next != base) {
+			if (word) {
+				eba_or_word_(eba, base, word);
+			}
+			base = next;
+			word = 0;
+		}
+		word |= 1UL << (idx[i] % Eba_ul_bits);
+	}
+	if (word) {
+		eba_or_word_(eba, base, word);
 	}
+}
 
-	buf[len - 2] = '!';
-	buf[len - 1] = '\0';
-	return buf;
+void eba_from_indices(struct eba *eba, const unsigned long *idx, size_t n)
+{
+	eba_assert_not_null_(eba);
+	eembed_assert(idx || !n);
+
+	eembed_memset(eba->bits, 0x00, eba->size_bytes);
+	eba_set_indices_(eba, idx, n);
 }
-#endif /* EBA_SKIP_TO_STRING */
+
+void eba_or_indices(struct eba *eba, const unsigned long *idx, size_t n)
+{
+	eba_assert_not_null_(eba);
+	eembed_assert(idx || !n);
+
+	eba_set_indices_(eba, idx, n);
+}
+
+size_t eba_filter_indices(struct eba *eba, const unsigned long *idx,
+			  size_t n, unsigned long *out)
+{
+	unsigned long id = 0;
+	size_t count = 0;
+	size_t ahead = 0;
+	size_t i = 0;
+
+	eba_assert_not_null_(eba);
+	eembed_assert((idx && out) || !n);
+
+	for (i = 0; i < n && i < EBA_BATCH_PREFETCH_DISTANCE; ++i) {
+		Eba_prefetch_(eba_bit_byte_(eba, idx[i]));
+	}
+	for (i = 0; i < n; ++i) {
+		ahead = i + EBA_BATCH_PREFETCH_DISTANCE;
+		if (ahead < n) {
+			Eba_prefetch_(eba_bit_byte_(eba, idx[ahead]));
+		}
+		id = idx[i];
+		eembed_assert(id < (eba->size_bytes * CHAR_BIT));
+		/* written either way, but kept only if the bit is set;
+		 * count is never past i, so out may be idx */
+		out[count] = id;
+		count += (*eba_bit_byte_(eba, id) >> (id % CHAR_BIT)) & 0x01;
+	}
+	return count;
+}
+
+#endif /* EBA_SKIP_INDICES */
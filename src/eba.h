@@ -47,6 +47,14 @@ void eba_set(struct eba *eba, unsigned long index, unsigned char val);
 
 unsigned char eba_get(struct eba *eba, unsigned long index);
 
+/* multi-bit fields: bit "j" of the value is the bit at (index + j)
+ * nbits may be up to the number of bits in an unsigned long */
+unsigned long eba_get_bits(struct eba *eba, unsigned long index,
+			   unsigned nbits);
+
+void eba_set_bits(struct eba *eba, unsigned long index, unsigned nbits,
+		  unsigned long val);
+
 /**********************************************************************/
 /* constructors */
 /**********************************************************************/
@@ -59,11 +67,81 @@ struct eba *eba_new_endian(unsigned long num_bits, enum eba_endian endian);
 
 void eba_free(struct eba *eba);
 
+/* aligned construction, so that word or vector loads of the bits are
+ * aligned: bits is aligned to EBA_ALIGN_BYTES, and size_bytes is padded
+ * to a whole number of unsigned longs; the bits start cleared */
+#ifndef EBA_ALIGN_BYTES
+#define EBA_ALIGN_BYTES 64
+#endif
+
+/* the padded size_bytes for num_bits */
+size_t eba_aligned_size_bytes(unsigned long num_bits);
+
+/* mem_len of eba_aligned_size_bytes + EBA_ALIGN_BYTES - 1 is enough for
+ * any mem; returns 0 on success, non-zero if mem_len is too small */
+int eba_init_aligned(struct eba *eba, unsigned char *mem, size_t mem_len,
+		     unsigned long num_bits, enum eba_endian endian);
+
+/* free with eba_free */
+struct eba *eba_new_aligned(unsigned long num_bits, enum eba_endian endian);
+
+/* A region of caller memory from which arrays are carved, for example
+ * for short lived arrays, avoiding eembed_malloc altogether. Arrays
+ * are not freed individually; eba_arena_reset releases them all. */
+struct eba_arena {
+	unsigned char *mem;
+	size_t size;
+	size_t used;
+};
+
+void eba_arena_init(struct eba_arena *arena, unsigned char *mem,
+		    size_t size);
+
+void eba_arena_reset(struct eba_arena *arena);
+
+/* the struct eba and its aligned bits are both taken from the arena;
+ * returns NULL if the arena does not have enough space left */
+struct eba *eba_new_in(struct eba_arena *arena, unsigned long num_bits,
+		       enum eba_endian endian);
+
 /**********************************************************************/
 /* helper functions */
 /**********************************************************************/
 char *eba_to_string(struct eba *eba, char *buf, size_t len);
 
+/* textual representations of the bits:
+ * eba_string_binary: '0' and '1' chars, a space between each byte
+ * eba_string_hex: two lower-case hex digits per byte, bytes in memory order
+ * eba_string_runs: run lengths of the binary chars, e.g.: "0*7 1*2 0*7" */
+enum eba_string_format {
+	eba_string_binary = 0,
+	eba_string_hex,
+	eba_string_runs
+};
+
+/* if the buf is too small, the last char will be a '!' */
+char *eba_to_string_format(struct eba *eba, enum eba_string_format format,
+			   char *buf, size_t len);
+
+/* receives successive chunks of text; a non-zero return stops the stream */
+typedef int (*eba_string_writer)(void *context, const char *str, size_t len);
+
+/* returns 0 on success, non-zero if the writer stopped the stream */
+int eba_to_string_stream(struct eba *eba, enum eba_string_format format,
+			 eba_string_writer writer, void *context);
+
+/* the inverse of eba_to_string; parsing stops at len or at a '\0'
+ * the string must describe exactly eba->size_bytes worth of bits,
+ * spaces between the chars are ignored
+ * returns 0 on success, or non-zero with *error_pos (if not NULL) set
+ * to the offset of the first char which could not be used; on error,
+ * the bits may be partially overwritten */
+int eba_from_string(struct eba *eba, const char *str, size_t len,
+		    size_t *error_pos);
+
+int eba_from_string_format(struct eba *eba, enum eba_string_format format,
+			   const char *str, size_t len, size_t *error_pos);
+
 void eba_set_all(struct eba *eba, unsigned char val);
 
 void eba_toggle(struct eba *eba, unsigned long index);
@@ -84,6 +162,853 @@ void eba_shift_left_fill(struct eba *eba, unsigned long positions,
 void eba_shift_right_fill(struct eba *eba, unsigned long positions,
 			  unsigned char fillval);
 
+/* copies nbits from src, starting at src_index, to dst at dst_index;
+ * the arrays may differ in endian; as with memmove, src and dst may be
+ * the same array with the ranges overlapping */
+void eba_copy_bits(struct eba *dst, unsigned long dst_index, struct eba *src,
+		   unsigned long src_index, unsigned long nbits);
+
+/**********************************************************************/
+/* comparing two arrays, e.g.: binary fingerprints */
+/**********************************************************************/
+/* bits are compared index by index; if one array is shorter, its
+ * missing bits are treated as zero */
+
+/* the number of bits which differ, popcount(a ^ b) */
+unsigned long eba_hamming_distance(struct eba *a, struct eba *b);
+
+/* popcount(a & b) */
+unsigned long eba_count_and(struct eba *a, struct eba *b);
+
+/* popcount(a | b) */
+unsigned long eba_count_or(struct eba *a, struct eba *b);
+
+/* both of the above, in one pass; either pointer may be NULL */
+void eba_count_and_or(struct eba *a, struct eba *b, unsigned long *and_count,
+		      unsigned long *or_count);
+
+/* Jaccard/Tanimoto similarity, popcount(a & b) / popcount(a | b)
+ * if neither array has any bits set, they are considered the same: 1.0 */
+double eba_jaccard(struct eba *a, struct eba *b);
+
+/**********************************************************************/
+/* searching many fixed-width fingerprints */
+/**********************************************************************/
+/* rows of equal size, stored one after the other in one block;
+ * row "i" starts at bits + (i * row_bytes) */
+struct eba_matrix {
+	unsigned char *bits;
+	size_t row_bytes;
+	size_t rows;
+	enum eba_endian endian;
+};
+
+struct eba_match {
+	size_t row;
+	unsigned long distance;
+};
+
+struct eba_matrix *eba_matrix_new(size_t rows, unsigned long bits_per_row,
+				  enum eba_endian endian);
+
+void eba_matrix_free(struct eba_matrix *matrix);
+
+/* fills the view to refer to a row of the matrix, returns the view */
+struct eba *eba_matrix_row(struct eba_matrix *matrix, size_t row,
+			   struct eba *view);
+
+/* finds the k rows with the smallest hamming distance to the query;
+ * the matches are sorted by distance, ties broken by the lower row
+ * returns the number of matches, which is "k" unless there are fewer rows */
+size_t eba_matrix_nearest(struct eba_matrix *matrix, struct eba *query,
+			  struct eba_match *matches, size_t k);
+
+/* finds the rows within max_distance of the query, in row order;
+ * returns the number which matched, but stores no more than capacity */
+size_t eba_matrix_within(struct eba_matrix *matrix, struct eba *query,
+			 unsigned long max_distance, struct eba_match *matches,
+			 size_t capacity);
+
+/* For splitting a search between threads, these search only the rows
+ * from row_begin up to (not including) row_end.
+ * The "found" matches already in the buffer are kept or improved upon,
+ * thus a search may also be continued in pieces. Per-thread results
+ * can be combined with eba_matrix_merge_nearest. */
+size_t eba_matrix_nearest_rows(struct eba_matrix *matrix, struct eba *query,
+			       size_t row_begin, size_t row_end,
+			       struct eba_match *matches, size_t found,
+			       size_t k);
+
+size_t eba_matrix_merge_nearest(struct eba_match *matches, size_t found,
+				size_t k, const struct eba_match *more,
+				size_t more_found);
+
+size_t eba_matrix_within_rows(struct eba_matrix *matrix, struct eba *query,
+			      size_t row_begin, size_t row_end,
+			      unsigned long max_distance,
+			      struct eba_match *matches, size_t capacity);
+
+/**********************************************************************/
+/* bloom filter */
+/**********************************************************************/
+/* eba_bloom_standard: k bits anywhere in the array, k cache misses
+ * eba_bloom_blocked: all k bits of a key in the same 64 byte block,
+ *   at most one cache miss per key, at a small cost in false positives */
+enum eba_bloom_layout {
+	eba_bloom_standard = 0,
+	eba_bloom_blocked
+};
+
+/* The filter state is entirely in eba.bits, thus a filter may be saved
+ * by writing eba.size_bytes of eba.bits, and restored by passing those
+ * bytes to eba_bloom_init with the same k and layout, on a platform with
+ * the same size of unsigned long (which is the size of the hashes). */
+struct eba_bloom {
+	struct eba eba;
+	unsigned k;
+	enum eba_bloom_layout layout;
+};
+
+/* uses the caller's bytes, which are not cleared;
+ * eba_bloom_blocked requires size_bytes to be a multiple of 64, and
+ * for at most one cache miss per key, bits should be aligned to 64
+ * bytes (EBA_ALIGN_BYTES); unaligned bits work, but a block may then
+ * span two cache lines
+ * returns 0 on success */
+int eba_bloom_init(struct eba_bloom *bloom, unsigned char *bits,
+		   size_t size_bytes, unsigned k,
+		   enum eba_bloom_layout layout);
+
+/* for eba_bloom_blocked, num_bits is rounded up to a multiple of 512;
+ * bits are aligned to EBA_ALIGN_BYTES */
+struct eba_bloom *eba_bloom_new(unsigned long num_bits, unsigned k,
+				enum eba_bloom_layout layout);
+
+void eba_bloom_free(struct eba_bloom *bloom);
+
+/* Keys are identified by a hash of at least 32 bits, from which the k
+ * probe positions are derived by double hashing. eba_bloom_hash is
+ * offered for convenience, but any decent hash of the key will do.
+ * Where unsigned long has 64 bits, eba_bloom_hash and the probes use all
+ * 64, so that every bit of a filter larger than 2^32 bits is reachable;
+ * elsewhere a filter may have at most ULONG_MAX bits. */
+unsigned long eba_bloom_hash(const void *key, size_t len);
+
+void eba_bloom_add(struct eba_bloom *bloom, unsigned long hash);
+
+/* returns 0 if the key is absent, 1 if the key may be present */
+unsigned char eba_bloom_contains(struct eba_bloom *bloom, unsigned long hash);
+
+/* the batch versions prefetch the bits for keys further along the
+ * batch, so that the cache misses overlap */
+void eba_bloom_add_batch(struct eba_bloom *bloom, const unsigned long *hashes,
+			 size_t n);
+
+/* results (if not NULL) is filled with n values as from eba_bloom_contains;
+ * returns the number of keys which may be present */
+size_t eba_bloom_contains_batch(struct eba_bloom *bloom,
+				const unsigned long *hashes, size_t n,
+				unsigned char *results);
+
+/**********************************************************************/
+/* packed arrays of small counters */
+/**********************************************************************/
+/* each counter is a 2, 4 or 8 bit field of the eba;
+ * as with eba_bloom, the state is entirely in eba.bits */
+struct eba_counters {
+	struct eba eba;
+	unsigned bits_per_counter;
+	size_t size;
+	unsigned max;
+};
+
+/* uses the caller's bytes, which are not cleared; returns 0 on success */
+int eba_counters_init(struct eba_counters *counters, unsigned char *bits,
+		      size_t size_bytes, unsigned bits_per_counter);
+
+struct eba_counters *eba_counters_new(size_t num_counters,
+				      unsigned bits_per_counter);
+
+void eba_counters_free(struct eba_counters *counters);
+
+unsigned eba_counters_get(struct eba_counters *counters, size_t i);
+
+/* values larger than max are stored as max */
+void eba_counters_set(struct eba_counters *counters, size_t i, unsigned val);
+
+/* saturating at max and at zero, return the new value */
+unsigned eba_counters_increment(struct eba_counters *counters, size_t i);
+
+unsigned eba_counters_decrement(struct eba_counters *counters, size_t i);
+
+/* the batch versions prefetch the counters further along the batch */
+void eba_counters_increment_batch(struct eba_counters *counters,
+				  const size_t *indexes, size_t n);
+
+void eba_counters_decrement_batch(struct eba_counters *counters,
+				  const size_t *indexes, size_t n);
+
+/* a bloom filter which supports removal, keys are hashed as for eba_bloom
+ * Counters which reach max stay at max, as their true count is unknown. */
+struct eba_counting_bloom {
+	struct eba_counters counters;
+	unsigned k;
+};
+
+int eba_counting_bloom_init(struct eba_counting_bloom *bloom,
+			    unsigned char *bits, size_t size_bytes,
+			    unsigned bits_per_counter, unsigned k);
+
+void eba_counting_bloom_add(struct eba_counting_bloom *bloom,
+			    unsigned long hash);
+
+/* returns 0 if the key was removed, non-zero if it was not present */
+int eba_counting_bloom_remove(struct eba_counting_bloom *bloom,
+			      unsigned long hash);
+
+unsigned char eba_counting_bloom_contains(struct eba_counting_bloom *bloom,
+					  unsigned long hash);
+
+/* an upper bound of the number of times the key was added */
+unsigned eba_counting_bloom_count(struct eba_counting_bloom *bloom,
+				  unsigned long hash);
+
+/**********************************************************************/
+/* allocating slots (ids, slab entries) from a bitmap */
+/**********************************************************************/
+#ifndef EBA_ALLOC_MAX_LEVELS
+#define EBA_ALLOC_MAX_LEVELS 8
+#endif
+
+/* "used" has one bit per slot, set while the slot is allocated; the
+ * bits past the last slot, up to a whole unsigned long, are always set.
+ * Above it, each level has one bit per unsigned long of the level below,
+ * set if that word is full, so a free slot is found by looking at one
+ * word per level rather than by scanning the whole bitmap. */
+struct eba_alloc {
+	struct eba used;
+	size_t slots;
+	size_t in_use;
+	unsigned levels;
+	unsigned char *level[EBA_ALLOC_MAX_LEVELS];
+	size_t level_words[EBA_ALLOC_MAX_LEVELS];
+};
+
+/* bytes needed by eba_alloc_init, or 0 if too many slots */
+size_t eba_alloc_size_bytes(size_t slots);
+
+/* uses the caller's memory, which must be at least eba_alloc_size_bytes
+ * and is cleared: all slots start free; returns 0 on success */
+int eba_alloc_init(struct eba_alloc *alloc, unsigned char *mem,
+		   size_t mem_len, size_t slots);
+
+struct eba_alloc *eba_alloc_new(size_t slots);
+
+void eba_alloc_free(struct eba_alloc *alloc);
+
+/* returns 0 on success, non-zero if there are no free slots */
+int eba_alloc_slot(struct eba_alloc *alloc, size_t *slot);
+
+/* n contiguous slots, first fit
+ * returns 0 on success, non-zero if there is no large enough gap */
+int eba_alloc_slots(struct eba_alloc *alloc, size_t n, size_t *first);
+
+void eba_alloc_release(struct eba_alloc *alloc, size_t slot);
+
+void eba_alloc_release_slots(struct eba_alloc *alloc, size_t first, size_t n);
+
+unsigned char eba_alloc_in_use(struct eba_alloc *alloc, size_t slot);
+
+/* A cache of free slots for one thread, so that the shared eba_alloc
+ * (and its lock) is only visited once per EBA_ALLOC_CACHE_SIZE / 2
+ * operations. The lock functions may be NULL if no locking is needed.
+ * Slots held in a cache appear in use to the shared eba_alloc. */
+#ifndef EBA_ALLOC_CACHE_SIZE
+#define EBA_ALLOC_CACHE_SIZE 32
+#endif
+
+typedef void (*eba_alloc_lock_func)(void *lock_context);
+
+struct eba_alloc_cache {
+	struct eba_alloc *alloc;
+	eba_alloc_lock_func lock;
+	eba_alloc_lock_func unlock;
+	void *lock_context;
+	size_t count;
+	size_t slots[EBA_ALLOC_CACHE_SIZE];
+};
+
+void eba_alloc_cache_init(struct eba_alloc_cache *cache,
+			  struct eba_alloc *alloc, eba_alloc_lock_func lock,
+			  eba_alloc_lock_func unlock, void *lock_context);
+
+/* returns 0 on success, non-zero if the shared eba_alloc is full */
+int eba_alloc_cache_slot(struct eba_alloc_cache *cache, size_t *slot);
+
+void eba_alloc_cache_release(struct eba_alloc_cache *cache, size_t slot);
+
+/* returns all cached slots to the shared eba_alloc */
+void eba_alloc_cache_flush(struct eba_alloc_cache *cache);
+
+/**********************************************************************/
+/* sparse arrays, with a summary of which lines have bits set */
+/**********************************************************************/
+#ifndef EBA_SPARSE_MAX_LEVELS
+#define EBA_SPARSE_MAX_LEVELS 8
+#endif
+
+#ifndef EBA_SPARSE_LINE_BYTES
+#define EBA_SPARSE_LINE_BYTES 64
+#endif
+
+/* level[0] has one bit per EBA_SPARSE_LINE_BYTES of eba.bits, set if the
+ * line has any bit set; each level above has one bit per unsigned long
+ * of the level below, set if that word is non-zero. Thus searching for
+ * set bits skips empty regions, looking at one word per level.
+ * The summary is kept by eba_sparse_set; after writing eba.bits by other
+ * means, call eba_sparse_rebuild. The eba is always eba_endian_little. */
+struct eba_sparse {
+	struct eba eba;
+	unsigned levels;
+	unsigned char *level[EBA_SPARSE_MAX_LEVELS];
+	size_t level_words[EBA_SPARSE_MAX_LEVELS];
+};
+
+/* bytes of summary needed for an array of size_bytes, or 0 if too big */
+size_t eba_sparse_summary_bytes(size_t size_bytes);
+
+/* uses the caller's bits, which are not cleared, and summary memory of at
+ * least eba_sparse_summary_bytes; returns 0 on success */
+int eba_sparse_init(struct eba_sparse *sparse, unsigned char *bits,
+		    size_t size_bytes, unsigned char *summary,
+		    size_t summary_len);
+
+struct eba_sparse *eba_sparse_new(unsigned long num_bits);
+
+void eba_sparse_free(struct eba_sparse *sparse);
+
+void eba_sparse_set(struct eba_sparse *sparse, unsigned long index,
+		    unsigned char val);
+
+/* finds the first set bit at or after index
+ * returns 0 on success, non-zero if there are no more set bits
+ * e.g.: for (err = eba_sparse_next(s, 0, &i); !err;
+ *            err = eba_sparse_next(s, i + 1, &i)) { ... } */
+int eba_sparse_next(struct eba_sparse *sparse, unsigned long index,
+		    unsigned long *found);
+
+/* zeros only the lines with bits set */
+void eba_sparse_clear_all(struct eba_sparse *sparse);
+
+/* recomputes the summary from eba.bits */
+void eba_sparse_rebuild(struct eba_sparse *sparse);
+
+/**********************************************************************/
+/* bit streams, for variable length codes */
+/**********************************************************************/
+/* Codes are written and read at increasing indexes, low bit first.
+ * Bits are buffered in an unsigned long, so the eba is written or read
+ * a word at a time. The writer buffers bits which are not yet in the
+ * eba, until eba_bitwriter_flush. */
+struct eba_bitwriter {
+	struct eba *eba;
+	unsigned long index;
+	unsigned long acc;
+	unsigned count;
+};
+
+struct eba_bitreader {
+	struct eba *eba;
+	unsigned long index;
+	unsigned long acc;
+	unsigned count;
+};
+
+void eba_bitwriter_init(struct eba_bitwriter *writer, struct eba *eba,
+			unsigned long index);
+
+/* the low nbits of val, nbits may be up to the bits in an unsigned long
+ * returns 0 on success, non-zero if the eba is too small */
+int eba_bitwriter_put(struct eba_bitwriter *writer, unsigned long val,
+		      unsigned nbits);
+
+/* q zero bits, then a one bit */
+int eba_bitwriter_put_unary(struct eba_bitwriter *writer, unsigned long q);
+
+/* Elias gamma, for x >= 1: with n the index of the highest set bit of x,
+ * n as unary, then the low n bits of x */
+int eba_bitwriter_put_gamma(struct eba_bitwriter *writer, unsigned long x);
+
+/* writes the buffered bits to the eba; writing may continue after */
+void eba_bitwriter_flush(struct eba_bitwriter *writer);
+
+/* the index of the next bit to be written */
+unsigned long eba_bitwriter_position(struct eba_bitwriter *writer);
+
+void eba_bitreader_init(struct eba_bitreader *reader, struct eba *eba,
+			unsigned long index);
+
+/* returns 0 on success, non-zero if there are not nbits left to read */
+int eba_bitreader_get(struct eba_bitreader *reader, unsigned nbits,
+		      unsigned long *val);
+
+int eba_bitreader_get_unary(struct eba_bitreader *reader, unsigned long *q);
+
+int eba_bitreader_get_gamma(struct eba_bitreader *reader, unsigned long *x);
+
+/* the index of the next bit to be read */
+unsigned long eba_bitreader_position(struct eba_bitreader *reader);
+
+/**********************************************************************/
+/* pools of small arrays */
+/**********************************************************************/
+/* Arrays of up to 1024 bits, in size classes of 64, 128, 256, 512 and
+ * 1024 bits, are carved from slabs of EBA_POOL_SLAB_ARRAYS arrays each.
+ * Freed arrays go on a free list per class, to be reused; slabs are
+ * only returned to eembed_free by eba_pool_destroy. */
+#define EBA_POOL_CLASSES 5
+#define EBA_POOL_MAX_BITS 1024
+
+#ifndef EBA_POOL_SLAB_ARRAYS
+#define EBA_POOL_SLAB_ARRAYS 64
+#endif
+
+struct eba_pool_slab;
+
+struct eba_pool {
+	struct eba_pool_slab *slabs;
+	struct eba *free_list[EBA_POOL_CLASSES];
+};
+
+void eba_pool_init(struct eba_pool *pool);
+
+/* frees all of the slabs, and thus every array from the pool */
+void eba_pool_destroy(struct eba_pool *pool);
+
+/* returns every array to the free lists at once, keeping the slabs */
+void eba_pool_reset(struct eba_pool *pool);
+
+/* the bits start cleared, size_bytes is that of the size class;
+ * returns NULL if num_bits is over EBA_POOL_MAX_BITS or out of memory */
+struct eba *eba_pool_new(struct eba_pool *pool, unsigned long num_bits,
+			 enum eba_endian endian);
+
+void eba_pool_free(struct eba_pool *pool, struct eba *eba);
+
+/* A cache of free arrays for one thread, in the style of eba_alloc_cache,
+ * so that the shared pool (and its lock) is only visited once per
+ * EBA_POOL_CACHE_SIZE / 2 operations of a size class. The lock functions
+ * may be NULL. Flush the caches before eba_pool_reset or destroy. */
+#ifndef EBA_POOL_CACHE_SIZE
+#define EBA_POOL_CACHE_SIZE 16
+#endif
+
+typedef void (*eba_pool_lock_func)(void *lock_context);
+
+struct eba_pool_cache {
+	struct eba_pool *pool;
+	eba_pool_lock_func lock;
+	eba_pool_lock_func unlock;
+	void *lock_context;
+	size_t count[EBA_POOL_CLASSES];
+	struct eba *arrays[EBA_POOL_CLASSES][EBA_POOL_CACHE_SIZE];
+};
+
+void eba_pool_cache_init(struct eba_pool_cache *cache, struct eba_pool *pool,
+			 eba_pool_lock_func lock, eba_pool_lock_func unlock,
+			 void *lock_context);
+
+struct eba *eba_pool_cache_new(struct eba_pool_cache *cache,
+			       unsigned long num_bits, enum eba_endian endian);
+
+void eba_pool_cache_free(struct eba_pool_cache *cache, struct eba *eba);
+
+/* returns all cached arrays to the shared pool */
+void eba_pool_cache_flush(struct eba_pool_cache *cache);
+
+/**********************************************************************/
+/* copy-on-write snapshots */
+/**********************************************************************/
+/* A large array split into pages of EBA_COW_PAGE_BYTES, each page a
+ * separate allocation with a reference count. A snapshot copies only
+ * the table of page pointers; the first write to a page which is still
+ * shared duplicates that page, so neither the snapshot nor the array
+ * sees the writes of the other.
+ *
+ * Bit index i is bit (i % page bits) of page (i / page bits); each page
+ * is viewed as an eba of the same endian, so the existing functions may
+ * be used on a page at a time.
+ *
+ * The reference counts are not atomic: eba_cow_snapshot and eba_cow_free
+ * must not run at the same time as writes to the same pages, but reads
+ * of a snapshot need no lock, as shared pages are never written. */
+#ifndef EBA_COW_PAGE_BYTES
+#define EBA_COW_PAGE_BYTES 4096
+#endif
+
+struct eba_cow_page;
+
+struct eba_cow {
+	unsigned long num_bits;
+	enum eba_endian endian;
+	size_t num_pages;
+	struct eba_cow_page **pages;
+};
+
+/* all bits start cleared; returns NULL if out of memory */
+struct eba_cow *eba_cow_new(unsigned long num_bits, enum eba_endian endian);
+
+/* releases this view, pages still shared by another view are kept */
+void eba_cow_free(struct eba_cow *cow);
+
+/* a frozen view, O(pages); returns NULL if out of memory */
+struct eba_cow *eba_cow_snapshot(struct eba_cow *cow);
+
+unsigned char eba_cow_get(const struct eba_cow *cow, unsigned long index);
+
+/* returns 0 on success, non-zero if a shared page could not be copied */
+int eba_cow_set(struct eba_cow *cow, unsigned long index, unsigned char val);
+
+/* fills view with page number page, for reading only */
+void eba_cow_page_view(const struct eba_cow *cow, size_t page,
+		       struct eba *view);
+
+/* as eba_cow_page_view, but first unshares the page, so that view may be
+ * written; returns 0 on success, non-zero if out of memory */
+int eba_cow_page_write(struct eba_cow *cow, size_t page, struct eba *view);
+
+/* the number of pages which are not shared with another view */
+size_t eba_cow_private_pages(const struct eba_cow *cow);
+
+/**********************************************************************/
+/* patches between two versions of an array */
+/**********************************************************************/
+/* A patch is a sequence of runs of changed words of EBA_DIFF_WORD_BYTES:
+ * the number of unchanged words skipped and the number of words in the
+ * run, each as a LEB128 varint, then the XOR of the old and new bytes
+ * of the run. The last word of an array may be short. The same patch
+ * turns old into new, or new back into old. */
+#define EBA_DIFF_WORD_BYTES 8
+
+/* The number of bits for a map of dirty words, one per word of an array
+ * of size_bytes; the map is a little endian eba, set with eba_diff_touch
+ * alongside each write, and cleared by the caller after each diff. */
+size_t eba_diff_dirty_bits(size_t size_bytes);
+
+/* marks the word of eba holding bit index as dirty */
+void eba_diff_touch(struct eba *dirty, struct eba *eba, unsigned long index);
+
+/* Writes the patch from old_eba to new_eba into patch, both arrays must
+ * be the same size in bytes. If dirty is not NULL, only the words marked
+ * dirty are compared. Returns the size of the full patch, which is only
+ * written completely if that is not more than patch_len; an empty patch
+ * is size 0. */
+size_t eba_diff(struct eba *old_eba, struct eba *new_eba, struct eba *dirty,
+		unsigned char *patch, size_t patch_len);
+
+/* returns 0 on success, non-zero if the patch is malformed or does not
+ * fit the array, in which case the array is left unchanged */
+int eba_patch(struct eba *eba, const unsigned char *patch, size_t patch_len);
+
+/**********************************************************************/
+/* dirty region tracking */
+/**********************************************************************/
+/* Tracks which regions of the bytes of an array have been written, for
+ * example to msync or pwrite only those. The array is written through
+ * the eba_dirty functions, which mark the regions that they touch;
+ * after writing eba->bits by other means, call eba_dirty_mark_bits.
+ *
+ * region_bytes must be a power of two, for instance a cache line or a
+ * page. The marks are a little endian eba of one bit per region; with
+ * a region_bytes of EBA_DIFF_WORD_BYTES they may be passed to eba_diff
+ * as the map of dirty words. */
+struct eba_dirty {
+	struct eba *eba;
+	struct eba marks;
+	size_t regions;
+	unsigned region_shift;
+};
+
+size_t eba_dirty_marks_bytes(size_t size_bytes, size_t region_bytes);
+
+/* marks_len must be at least eba_dirty_marks_bytes; the marks start
+ * clear; returns 0 on success */
+int eba_dirty_init(struct eba_dirty *dirty, struct eba *eba,
+		   size_t region_bytes, unsigned char *marks, size_t marks_len);
+
+/* the eba is not copied, nor freed by eba_dirty_free */
+struct eba_dirty *eba_dirty_new(struct eba *eba, size_t region_bytes);
+
+void eba_dirty_free(struct eba_dirty *dirty);
+
+void eba_dirty_mark_bits(struct eba_dirty *dirty, unsigned long index,
+			 unsigned long nbits);
+
+void eba_dirty_mark_all(struct eba_dirty *dirty);
+
+void eba_dirty_set(struct eba_dirty *dirty, unsigned long index,
+		   unsigned char val);
+
+void eba_dirty_set_bits(struct eba_dirty *dirty, unsigned long index,
+			unsigned nbits, unsigned long val);
+
+void eba_dirty_set_all(struct eba_dirty *dirty, unsigned char val);
+
+void eba_dirty_toggle(struct eba_dirty *dirty, unsigned long index);
+
+void eba_dirty_swap(struct eba_dirty *dirty, unsigned long index1,
+		    unsigned long index2);
+
+void eba_dirty_rotate_left(struct eba_dirty *dirty, unsigned long positions);
+
+void eba_dirty_rotate_right(struct eba_dirty *dirty, unsigned long positions);
+
+void eba_dirty_shift_left(struct eba_dirty *dirty, unsigned long positions);
+
+void eba_dirty_shift_right(struct eba_dirty *dirty, unsigned long positions);
+
+void eba_dirty_shift_left_fill(struct eba_dirty *dirty,
+			       unsigned long positions, unsigned char fillval);
+
+void eba_dirty_shift_right_fill(struct eba_dirty *dirty,
+				unsigned long positions, unsigned char fillval);
+
+/* as eba_copy_bits, with the dirty array as the dst */
+void eba_dirty_copy_bits(struct eba_dirty *dirty, unsigned long dst_index,
+			 struct eba *src, unsigned long src_index,
+			 unsigned long nbits);
+
+/* Finds the first run of dirty regions at or after the region holding
+ * the byte offset, as a range of bytes of eba->bits; returns 0 if found,
+ * non-zero if there are no more, e.g.:
+ * for (err = eba_dirty_next(d, 0, &start, &len); !err;
+ *      err = eba_dirty_next(d, start + len, &start, &len)) { ... } */
+int eba_dirty_next(struct eba_dirty *dirty, size_t offset, size_t *start,
+		   size_t *len);
+
+/* clears the marks of the regions overlapping the range of bytes */
+void eba_dirty_clear_range(struct eba_dirty *dirty, size_t start,
+			   size_t len);
+
+void eba_dirty_clear(struct eba_dirty *dirty);
+
+/**********************************************************************/
+/* batches of random access */
+/**********************************************************************/
+/* Each probe of a large array is likely a cache miss; given the indexes
+ * up front, the batch functions prefetch EBA_BATCH_PREFETCH_DISTANCE
+ * probes ahead, so that many of the misses overlap. */
+#ifndef EBA_BATCH_PREFETCH_DISTANCE
+#define EBA_BATCH_PREFETCH_DISTANCE 16
+#endif
+
+/* out[i] is set to eba_get(eba, idx[i]), out may be NULL;
+ * returns the number of the bits which were set */
+size_t eba_test_batch(struct eba *eba, const unsigned long *idx, size_t n,
+		      unsigned char *out);
+
+/**********************************************************************/
+/* instruction set selection */
+/**********************************************************************/
+/* On x86-64 with gcc or clang, the bulk counts (eba_hamming_distance,
+ * eba_count_and, eba_count_or, the similarities, the matrix searches),
+ * eba_bitmatrix_transpose, and the compress and expand functions use
+ * kernels for the best instruction set the cpu supports, chosen when
+ * the library is loaded. Elsewhere, and when EEMBED_HOSTED is 0, the
+ * portable C89 code is always used. The EBA_ISA environment variable
+ * ("portable", "sse2", "avx2" or "avx512") caps the choice. */
+enum eba_isa {
+	eba_isa_portable = 0,
+	eba_isa_sse2,
+	eba_isa_avx2,
+	/* AVX-512BW; the counts use VPOPCNTDQ where the cpu has it */
+	eba_isa_avx512
+};
+
+enum eba_isa eba_isa_current(void);
+
+/* uses isa, or the best below it which the cpu supports, for example
+ * to test each kernel; returns the level in use. This is not thread
+ * safe, call it before other threads use the library. */
+enum eba_isa eba_isa_force(enum eba_isa isa);
+
+/**********************************************************************/
+/* bit matrices */
+/**********************************************************************/
+/* A rows by cols matrix of bits held in a single little endian eba,
+ * each row padded to a whole number of unsigned longs, so that a row
+ * may be viewed as an eba of its own, and no word straddles two rows.
+ * The bit at (row, col) is bit (row * row_bytes * CHAR_BIT) + col of
+ * the eba; the padding bits are kept clear.
+ *
+ * Unlike struct eba_matrix, which is a set of rows for searching, this
+ * is for working on the rows and columns both; eba_bitmatrix_transpose
+ * swaps them a block at a time, with SSE2, AVX2 or AVX-512 kernels
+ * where the bulk counts also use them. */
+struct eba_bitmatrix {
+	struct eba eba;
+	size_t rows;
+	size_t cols;
+	size_t row_bytes;
+};
+
+size_t eba_bitmatrix_row_bytes(size_t cols);
+
+size_t eba_bitmatrix_size_bytes(size_t rows, size_t cols);
+
+/* bits_len must be at least eba_bitmatrix_size_bytes; the bits are
+ * cleared; returns 0 on success */
+int eba_bitmatrix_init(struct eba_bitmatrix *matrix, unsigned char *bits,
+		       size_t bits_len, size_t rows, size_t cols);
+
+/* a cleared matrix, or NULL */
+struct eba_bitmatrix *eba_bitmatrix_new(size_t rows, size_t cols);
+
+void eba_bitmatrix_free(struct eba_bitmatrix *matrix);
+
+unsigned char eba_bitmatrix_get(struct eba_bitmatrix *matrix, size_t row,
+				size_t col);
+
+void eba_bitmatrix_set(struct eba_bitmatrix *matrix, size_t row, size_t col,
+		       unsigned char val);
+
+/* fills the view to refer to a row of the matrix, returns the view */
+struct eba *eba_bitmatrix_row(struct eba_bitmatrix *matrix, size_t row,
+			      struct eba *view);
+
+/* copies the column to the first "rows" bits of out */
+void eba_bitmatrix_get_col(struct eba_bitmatrix *matrix, size_t col,
+			   struct eba *out);
+
+/* sets the column from the first "rows" bits of in */
+void eba_bitmatrix_set_col(struct eba_bitmatrix *matrix, size_t col,
+			   struct eba *in);
+
+unsigned long eba_bitmatrix_row_popcount(struct eba_bitmatrix *matrix,
+					 size_t row);
+
+/* dst must be src->cols by src->rows and must not overlap src;
+ * returns 0 on success, non-zero if the shapes do not match */
+int eba_bitmatrix_transpose(struct eba_bitmatrix *dst,
+			    struct eba_bitmatrix *src);
+
+/**********************************************************************/
+/* linear algebra over GF(2) */
+/**********************************************************************/
+/* On bit matrices, where adding is XOR and multiplying is AND, as for
+ * erasure codes or linear hashing. The results are written to a
+ * matrix or eba which must not overlap the arguments. */
+
+/* y = a * x, where x has at least a->cols bits and y a->rows bits;
+ * a little endian x of at least a->row_bytes is multiplied a word at a
+ * time, any other x a bit at a time */
+void eba_gf2_mul_vec(struct eba *y, struct eba_bitmatrix *a, struct eba *x);
+
+size_t eba_gf2_mul_scratch_bytes(struct eba_bitmatrix *b);
+
+/* c = a * b, with c being a->rows by b->cols. With a scratch of at
+ * least eba_gf2_mul_scratch_bytes(b), this uses the method of four
+ * Russians, a table of the XORs of each eight rows of b; with a NULL
+ * scratch, each set bit of a XORs in a row of b, which may be better
+ * for a sparse or short a. Returns 0 on success, non-zero if the shapes
+ * do not match or the scratch is too small. */
+int eba_gf2_mul(struct eba_bitmatrix *c, struct eba_bitmatrix *a,
+		struct eba_bitmatrix *b, unsigned char *scratch,
+		size_t scratch_len);
+
+/* brings the matrix to reduced row echelon form, in place;
+ * returns the rank */
+size_t eba_gf2_row_reduce(struct eba_bitmatrix *m);
+
+/**********************************************************************/
+/* bit-sliced integers */
+/**********************************************************************/
+/* An array of n k-bit unsigned integers, stored vertically: a k by n
+ * bit matrix, where row j is the plane holding bit j of each value, as
+ * for column-store scans. A comparison then takes a few word wide ANDs
+ * and ORs per plane for each word of values, rather than a compare and
+ * branch per value. k may be up to the bits of an unsigned long. */
+
+/* packs the low planes->rows bits of each of the n values, where n
+ * must be planes->cols; returns 0 on success */
+int eba_bitslice_pack(struct eba_bitmatrix *planes,
+		      const unsigned long *values, size_t n);
+
+/* fills values, which holds at least planes->cols */
+void eba_bitslice_unpack(unsigned long *values,
+			 struct eba_bitmatrix *planes);
+
+/* Each sets bit i of out to whether value i satisfies the comparison,
+ * and clears the rest of out's first planes->row_bytes, which out must
+ * have, out being little endian; returns 0 on success, non-zero if out
+ * is too small. A view of a row of another bit matrix of the same cols
+ * will do. */
+int eba_bitslice_lt(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c);
+
+int eba_bitslice_le(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c);
+
+int eba_bitslice_eq(struct eba *out, struct eba_bitmatrix *planes,
+		    unsigned long c);
+
+/* lo <= value <= hi */
+int eba_bitslice_between(struct eba *out, struct eba_bitmatrix *planes,
+			 unsigned long lo, unsigned long hi);
+
+/**********************************************************************/
+/* compress and expand by a mask */
+/**********************************************************************/
+/* For using a bitmap, such as the result of a predicate, as a filter
+ * over parallel arrays of n values: bit i of the mask selects value i.
+ * The mask is read a word at a time, with AVX-512 vpcompress and
+ * vpexpand where the instruction set selection allows. */
+
+/* copies the selected values of src to the start of dst, in order;
+ * dst may be src; returns the number copied */
+size_t eba_compress_ui(struct eba *mask, size_t n, const unsigned int *src,
+		       unsigned int *dst);
+
+size_t eba_compress_ul(struct eba *mask, size_t n, const unsigned long *src,
+		       unsigned long *dst);
+
+/* the reverse: the values at the start of src are copied, in order, to
+ * the selected places of dst, leaving the others unchanged; dst must not
+ * overlap src; returns the number copied */
+size_t eba_expand_ui(struct eba *mask, size_t n, const unsigned int *src,
+		     unsigned int *dst);
+
+size_t eba_expand_ul(struct eba *mask, size_t n, const unsigned long *src,
+		     unsigned long *dst);
+
+/**********************************************************************/
+/* index lists */
+/**********************************************************************/
+/* Converting between an array and the sorted list of the indexes of
+ * its set bits, in either endian, a word at a time; and combining the
+ * two without converting either. */
+
+/* stores the indexes of the set bits, in increasing order, but no more
+ * than cap of them; returns the number of bits set, which may be more
+ * than cap */
+size_t eba_to_indices(struct eba *eba, unsigned long *out, size_t cap);
+
+/* clears the array, then sets the bits at the n indexes; the bits for
+ * each word are gathered before it is written, so sorted or clustered
+ * indexes are written a word at a time, though any order will do */
+void eba_from_indices(struct eba *eba, const unsigned long *idx, size_t n);
+
+/* sets the bits at the n indexes, as eba_from_indices, but without
+ * first clearing the array */
+void eba_or_indices(struct eba *eba, const unsigned long *idx, size_t n);
+
+/* For intersecting a large array with a short list of candidates:
+ * copies to out those of the n indexes whose bits are set, in order,
+ * prefetching EBA_BATCH_PREFETCH_DISTANCE ahead as eba_test_batch does;
+ * out may be idx; returns the number kept */
+size_t eba_filter_indices(struct eba *eba, const unsigned long *idx,
+			  size_t n, unsigned long *out);
+
 /**********************************************************************/
 Eba_end_C_functions
 #undef Eba_end_C_functions
@@ -55,4 +55,12 @@
 		} \
 	} while (0)
 
+/* a small deterministic pseudo-random sequence, the same on every
+ * platform: advances the unsigned long state, and evaluates to 15 bits */
+#define EBA_TEST_RAND(state) \
+	((state) = (((state) * 1103515245UL) + 12345UL) & 0xFFFFFFFFUL, \
+	 ((state) >> 16) & 0x7FFFUL)
+
+#define EBA_TEST_RAND_BIT(state) ((unsigned char)(EBA_TEST_RAND(state) & 0x01))
+
 #endif /* EBA_TEST_PRIVATE_UTILS_H */
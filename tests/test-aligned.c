@@ -0,0 +1,144 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-aligned.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+unsigned eba_test_check_aligned(struct eba *eba, unsigned long num_bits)
+{
+	unsigned failures = 0;
+	size_t i = 0;
+
+	failures += check_int(((size_t)eba->bits) % EBA_ALIGN_BYTES, 0);
+	failures += check_int(eba->size_bytes % sizeof(unsigned long), 0);
+	failures += check_int((eba->size_bytes * 8) >= num_bits, 1);
+	failures += check_int((eba->size_bytes * 8) < (num_bits + 1
+						       + (sizeof(unsigned long)
+							  * 8)), 1);
+	for (i = 0; i < eba->size_bytes; ++i) {
+		failures += check_int(eba->bits[i], 0);
+	}
+	return failures;
+}
+
+unsigned eba_test_init_aligned(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char mem[128];
+	struct eba eba;
+	size_t offset = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_init_aligned");
+
+	failures += check_int(eba_aligned_size_bytes(0), sizeof(unsigned long));
+	failures += check_int(eba_aligned_size_bytes(1), sizeof(unsigned long));
+	failures += check_int(eba_aligned_size_bytes(65),
+			      (sizeof(unsigned long) == 8) ? 16 : 12);
+
+	for (offset = 0; offset < 8; ++offset) {
+		eembed_memset(mem, 0xFF, 128);
+		err = eba_init_aligned(&eba, mem + offset, 128 - offset, 100,
+				       eba_endian_little);
+		failures += check_int(err, 0);
+		failures += eba_test_check_aligned(&eba, 100);
+		eba_set(&eba, 99, 1);
+		failures += check_int(eba_get(&eba, 99), 1);
+	}
+
+	/* 33 bytes before the next 64 byte boundary is not enough */
+	offset = (64 - (((size_t)mem) % 64)) % 64;
+	err = eba_init_aligned(&eba, mem + offset + 1, 32, 8,
+			       eba_endian_little);
+	failures += check_int(err, 1);
+	err = eba_init_aligned(&eba, mem + offset, sizeof(unsigned long), 8,
+			       eba_big_endian);
+	failures += check_int(err, 0);
+	failures += check_ptr(eba.bits, mem + offset);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_new_in(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char mem[256];
+	struct eba_arena arena;
+	struct eba *a = NULL;
+	struct eba *b = NULL;
+	struct eba *c = NULL;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_new_in");
+
+	eembed_memset(mem, 0xFF, 256);
+	eba_arena_init(&arena, mem, 256);
+
+	a = eba_new_in(&arena, 10, eba_endian_little);
+	failures += check_int(a ? 1 : 0, 1);
+	b = eba_new_in(&arena, 64, eba_big_endian);
+	failures += check_int(b ? 1 : 0, 1);
+	if (!a || !b) {
+		VERBOSE_ANNOUNCE_DONE(verbose, failures);
+		return failures;
+	}
+	failures += eba_test_check_aligned(a, 10);
+	failures += eba_test_check_aligned(b, 64);
+	failures += check_int(b->endian, eba_big_endian);
+	failures += check_int((unsigned char *)b > a->bits, 1);
+
+	eba_set(a, 3, 1);
+	eba_set(b, 63, 1);
+	failures += check_int(eba_get(a, 3), 1);
+	failures += check_int(eba_get(b, 63), 1);
+	failures += check_int(eba_get(b, 3), 0);
+
+	/* no room for 1024 bits */
+	c = eba_new_in(&arena, 1024, eba_endian_little);
+	failures += check_ptr(c, NULL);
+
+	eba_arena_reset(&arena);
+	c = eba_new_in(&arena, 10, eba_endian_little);
+	failures += check_ptr(c, a);
+	failures += check_int(eba_get(c, 3), 0);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_new_aligned(int verbose)
+{
+	unsigned failures = 0;
+	struct eba *eba = NULL;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_new_aligned");
+
+	eba = eba_new_aligned(1000, eba_endian_little);
+	if (!eba) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += eba_test_check_aligned(eba, 1000);
+	eba_set(eba, 999, 1);
+	failures += check_int(eba_get(eba, 999), 1);
+	eba_free(eba);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_aligned(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_init_aligned(v);
+	failures += eba_test_new_in(v);
+	failures += eba_test_new_aligned(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_aligned)
@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-alloc.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+unsigned eba_test_alloc_each(int verbose, size_t slots)
+{
+	unsigned failures = 0;
+	struct eba_alloc *alloc = NULL;
+	size_t slot = 0;
+	size_t i = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_alloc_each", slots);
+
+	alloc = eba_alloc_new(slots);
+	if (!alloc) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+
+	for (i = 0; i < slots; ++i) {
+		slot = slots;
+		err = eba_alloc_slot(alloc, &slot);
+		failures += check_int(err, 0);
+		failures += check_unsigned_long(slot, i);
+	}
+	failures += check_unsigned_long(alloc->in_use, slots);
+	failures += check_int(eba_alloc_slot(alloc, &slot), 1);
+
+	slot = slots / 2;
+	eba_alloc_release(alloc, slot);
+	failures += check_int(eba_alloc_in_use(alloc, slot), 0);
+	slot = 0;
+	failures += check_int(eba_alloc_slot(alloc, &slot), 0);
+	failures += check_unsigned_long(slot, slots / 2);
+	failures += check_int(eba_alloc_in_use(alloc, slot), 1);
+
+	for (i = 0; i < slots; i += 2) {
+		eba_alloc_release(alloc, i);
+	}
+	for (i = 0; i < slots; i += 2) {
+		slot = slots;
+		failures += check_int(eba_alloc_slot(alloc, &slot), 0);
+		failures += check_unsigned_long(slot, i);
+	}
+	failures += check_int(eba_alloc_slot(alloc, &slot), 1);
+
+	for (i = 0; i < slots; ++i) {
+		eba_alloc_release(alloc, i);
+	}
+	failures += check_unsigned_long(alloc->in_use, 0);
+	for (i = 0; i < slots; ++i) {
+		failures += check_int(eba_get(&alloc->used, i), 0);
+	}
+
+	eba_alloc_free(alloc);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_alloc_runs(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_alloc alloc;
+	unsigned char mem[64];
+	size_t first = 0;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_alloc_runs");
+
+	failures += check_int(eba_alloc_init(&alloc, mem, 64, 0), 1);
+	failures += check_int(eba_alloc_init(&alloc, mem, 16, 300), 1);
+	failures += check_int(eba_alloc_init(&alloc, mem, 64, 300), 0);
+	failures += check_int(eba_alloc_size_bytes(300) <= 64, 1);
+
+	failures += check_int(eba_alloc_slots(&alloc, 10, &first), 0);
+	failures += check_unsigned_long(first, 0);
+	failures += check_int(eba_alloc_slots(&alloc, 100, &first), 0);
+	failures += check_unsigned_long(first, 10);
+	eba_alloc_release_slots(&alloc, 0, 10);
+	failures += check_unsigned_long(alloc.in_use, 100);
+
+	/* does not fit in the gap at the start */
+	failures += check_int(eba_alloc_slots(&alloc, 20, &first), 0);
+	failures += check_unsigned_long(first, 110);
+	failures += check_int(eba_alloc_slots(&alloc, 5, &first), 0);
+	failures += check_unsigned_long(first, 0);
+	for (i = 0; i < 300; ++i) {
+		failures += check_int(eba_alloc_in_use(&alloc, i),
+				      (i < 5 || (i >= 10 && i < 130)) ? 1 : 0);
+	}
+
+	failures += check_int(eba_alloc_slots(&alloc, 171, &first), 1);
+	failures += check_int(eba_alloc_slots(&alloc, 170, &first), 0);
+	failures += check_unsigned_long(first, 130);
+	failures += check_int(eba_alloc_slots(&alloc, 6, &first), 1);
+	failures += check_int(eba_alloc_slots(&alloc, 5, &first), 0);
+	failures += check_unsigned_long(first, 5);
+	failures += check_int(eba_alloc_slot(&alloc, &first), 1);
+
+	eba_alloc_release_slots(&alloc, 0, 300);
+	failures += check_unsigned_long(alloc.in_use, 0);
+	failures += check_int(eba_alloc_slots(&alloc, 300, &first), 0);
+	failures += check_unsigned_long(first, 0);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+struct eba_test_alloc_lock_counts {
+	unsigned locks;
+	unsigned unlocks;
+};
+
+void eba_test_alloc_lock(void *context)
+{
+	struct eba_test_alloc_lock_counts *counts = NULL;
+
+	counts = (struct eba_test_alloc_lock_counts *)context;
+	++counts->locks;
+}
+
+void eba_test_alloc_unlock(void *context)
+{
+	struct eba_test_alloc_lock_counts *counts = NULL;
+
+	counts = (struct eba_test_alloc_lock_counts *)context;
+	++counts->unlocks;
+}
+
+unsigned eba_test_alloc_cache(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_alloc alloc;
+	struct eba_alloc_cache cache;
+	struct eba_test_alloc_lock_counts counts;
+	unsigned char mem[32];
+	size_t slot = 0;
+	size_t i = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_alloc_cache");
+
+	counts.locks = 0;
+	counts.unlocks = 0;
+	err = eba_alloc_init(&alloc, mem, 32, 100);
+	failures += check_int(err, 0);
+	eba_alloc_cache_init(&cache, &alloc, eba_test_alloc_lock,
+			     eba_test_alloc_unlock, &counts);
+
+	for (i = 0; i < 100; ++i) {
+		slot = 100;
+		failures += check_int(eba_alloc_cache_slot(&cache, &slot), 0);
+		failures += check_int(slot < 100, 1);
+	}
+	failures += check_unsigned_long(alloc.in_use, 100);
+	failures += check_int(counts.locks, 7);
+	failures += check_int(eba_alloc_cache_slot(&cache, &slot), 1);
+
+	for (i = 0; i < 100; ++i) {
+		eba_alloc_cache_release(&cache, i);
+	}
+	failures += check_int(alloc.in_use < 100, 1);
+	failures += check_int(alloc.in_use == cache.count, 1);
+	eba_alloc_cache_flush(&cache);
+	failures += check_unsigned_long(alloc.in_use, 0);
+	failures += check_int(counts.locks, counts.unlocks);
+
+	/* no locking */
+	eba_alloc_cache_init(&cache, &alloc, NULL, NULL, NULL);
+	failures += check_int(eba_alloc_cache_slot(&cache, &slot), 0);
+	failures += check_unsigned_long(alloc.in_use, 16);
+	eba_alloc_cache_release(&cache, slot);
+	eba_alloc_cache_flush(&cache);
+	failures += check_unsigned_long(alloc.in_use, 0);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_alloc(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_alloc_each(v, 1);
+	failures += eba_test_alloc_each(v, 63);
+	failures += eba_test_alloc_each(v, 64);
+	failures += eba_test_alloc_each(v, 65);
+	failures += eba_test_alloc_each(v, 200);
+	failures += eba_test_alloc_each(v, 5000);
+	failures += eba_test_alloc_runs(v);
+	failures += eba_test_alloc_cache(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_alloc)
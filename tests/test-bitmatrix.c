@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bitmatrix.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+static unsigned long eba_test_bitmatrix_rand_state = 11;
+
+unsigned eba_test_bitmatrix_get_set(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bits[3 * 2 * sizeof(unsigned long)];
+	unsigned char col_bytes[1];
+	struct eba_bitmatrix m;
+	struct eba row_view;
+	struct eba col;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_bitmatrix_get_set");
+
+	/* rows are padded to whole words */
+	failures += check_size_t(eba_bitmatrix_row_bytes(1),
+				 sizeof(unsigned long));
+	failures += check_size_t(eba_bitmatrix_row_bytes(8 *
+							 sizeof(unsigned long)
+							 + 1),
+				 2 * sizeof(unsigned long));
+	failures += check_size_t(eba_bitmatrix_size_bytes(3, 70),
+				 3 * eba_bitmatrix_row_bytes(70));
+
+	failures += check_int(eba_bitmatrix_init(&m, bits, 1, 3, 70) != 0, 1);
+	failures += check_int(eba_bitmatrix_init(&m, bits, sizeof(bits), 0,
+						 70) != 0, 1);
+
+	eembed_memset(bits, 0xFF, sizeof(bits));
+	failures += check_int(eba_bitmatrix_init(&m, bits, sizeof(bits), 3,
+						 70), 0);
+	for (i = 0; i < sizeof(bits); ++i) {
+		failures += check_int(bits[i], 0);
+	}
+
+	eba_bitmatrix_set(&m, 0, 0, 1);
+	eba_bitmatrix_set(&m, 1, 69, 1);
+	eba_bitmatrix_set(&m, 2, 9, 1);
+	eba_bitmatrix_set(&m, 2, 10, 1);
+	eba_bitmatrix_set(&m, 2, 10, 0);
+	failures += check_int(eba_bitmatrix_get(&m, 0, 0), 1);
+	failures += check_int(eba_bitmatrix_get(&m, 1, 69), 1);
+	failures += check_int(eba_bitmatrix_get(&m, 2, 9), 1);
+	failures += check_int(eba_bitmatrix_get(&m, 2, 10), 0);
+	failures += check_int(eba_bitmatrix_get(&m, 0, 1), 0);
+
+	/* the bit of a row is the same bit of the row view */
+	eba_bitmatrix_row(&m, 1, &row_view);
+	failures += check_size_t(row_view.size_bytes, m.row_bytes);
+	failures += check_int(eba_get(&row_view, 69), 1);
+	eba_set(&row_view, 3, 1);
+	failures += check_int(eba_bitmatrix_get(&m, 1, 3), 1);
+
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(&m, 0), 1);
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(&m, 1), 2);
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(&m, 2), 1);
+
+	col.bits = col_bytes;
+	col.size_bytes = sizeof(col_bytes);
+	col.endian = eba_endian_little;
+	eba_bitmatrix_get_col(&m, 69, &col);
+	failures += check_int(col_bytes[0], 0x02);
+
+	col_bytes[0] = 0x05;
+	eba_bitmatrix_set_col(&m, 69, &col);
+	failures += check_int(eba_bitmatrix_get(&m, 0, 69), 1);
+	failures += check_int(eba_bitmatrix_get(&m, 1, 69), 0);
+	failures += check_int(eba_bitmatrix_get(&m, 2, 69), 1);
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(&m, 1), 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitmatrix_transpose_shape(int verbose, enum eba_isa isa,
+					    size_t rows, size_t cols)
+{
+	unsigned failures = 0;
+	struct eba_bitmatrix *m = NULL;
+	struct eba_bitmatrix *t = NULL;
+	struct eba_bitmatrix *back = NULL;
+	struct eba_bitmatrix *wrong = NULL;
+	unsigned long total = 0;
+	unsigned long t_total = 0;
+	size_t r = 0;
+	size_t c = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_bitmatrix_transpose", rows);
+
+	failures += check_int(eba_isa_force(isa) <= isa, 1);
+
+	m = eba_bitmatrix_new(rows, cols);
+	t = eba_bitmatrix_new(cols, rows);
+	back = eba_bitmatrix_new(rows, cols);
+	wrong = eba_bitmatrix_new(rows, cols + 1);
+	if (!m || !t || !back || !wrong) {
+		eba_bitmatrix_free(m);
+		eba_bitmatrix_free(t);
+		eba_bitmatrix_free(back);
+		eba_bitmatrix_free(wrong);
+		return EEMBED_HOSTED;
+	}
+
+	for (r = 0; r < rows; ++r) {
+		for (c = 0; c < cols; ++c) {
+			eba_bitmatrix_set(m, r, c,
+					  EBA_TEST_RAND_BIT
+					  (eba_test_bitmatrix_rand_state));
+		}
+		total += eba_bitmatrix_row_popcount(m, r);
+	}
+
+	failures += check_int(eba_bitmatrix_transpose(wrong, m) != 0, 1);
+
+	failures += check_int(eba_bitmatrix_transpose(t, m), 0);
+	for (r = 0; r < rows; ++r) {
+		for (c = 0; c < cols; ++c) {
+			failures +=
+			    check_int(eba_bitmatrix_get(t, c, r),
+				      eba_bitmatrix_get(m, r, c));
+		}
+	}
+	/* no bits were set in the padding */
+	for (c = 0; c < cols; ++c) {
+		t_total += eba_bitmatrix_row_popcount(t, c);
+	}
+	failures += check_unsigned_long(t_total, total);
+
+	failures += check_int(eba_bitmatrix_transpose(back, t), 0);
+	failures += check_byte_array(back->eba.bits, back->eba.size_bytes,
+				     m->eba.bits, m->eba.size_bytes);
+
+	eba_bitmatrix_free(m);
+	eba_bitmatrix_free(t);
+	eba_bitmatrix_free(back);
+	eba_bitmatrix_free(wrong);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitmatrix_transpose(int v, enum eba_isa isa)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 1, 1);
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 7, 9);
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 64, 64);
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 65, 31);
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 100, 300);
+	failures += eba_test_bitmatrix_transpose_shape(v, isa, 513, 257);
+
+	return failures;
+}
+
+unsigned eba_test_bitmatrix(int v)
+{
+	unsigned failures = 0;
+	enum eba_isa start = eba_isa_current();
+
+	failures += eba_test_bitmatrix_get_set(v);
+	failures += eba_test_bitmatrix_transpose(v, eba_isa_portable);
+	failures += eba_test_bitmatrix_transpose(v, eba_isa_sse2);
+	failures += eba_test_bitmatrix_transpose(v, eba_isa_avx2);
+	failures += eba_test_bitmatrix_transpose(v, eba_isa_avx512);
+
+	failures += check_int(eba_isa_force(start), start);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_bitmatrix)
@@ -0,0 +1,127 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bitslice.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+static unsigned long eba_test_bitslice_rand_state = 3;
+
+unsigned eba_test_bitslice_shape(int verbose, size_t k, size_t n)
+{
+	unsigned failures = 0;
+	struct eba_bitmatrix *planes = NULL;
+	struct eba_bitmatrix *results = NULL;
+	unsigned long *values = NULL;
+	unsigned long *unpacked = NULL;
+	unsigned long mask = 0;
+	unsigned long cs[5];
+	unsigned long c = 0;
+	unsigned long lo = 0;
+	unsigned long found = 0;
+	unsigned long expect = 0;
+	struct eba out;
+	int in = 0;
+	size_t i = 0;
+	size_t t = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_bitslice", n);
+
+	planes = eba_bitmatrix_new(k, n);
+	results = eba_bitmatrix_new(1, n);
+	values = (unsigned long *)eembed_malloc(n * sizeof(unsigned long));
+	unpacked = (unsigned long *)eembed_malloc(n * sizeof(unsigned long));
+	if (!planes || !results || !values || !unpacked) {
+		eba_bitmatrix_free(planes);
+		eba_bitmatrix_free(results);
+		eembed_free(values);
+		eembed_free(unpacked);
+		return EEMBED_HOSTED;
+	}
+	mask = (1UL << k) - 1;
+	for (i = 0; i < n; ++i) {
+		/* bits above k are ignored */
+		values[i] = EBA_TEST_RAND(eba_test_bitslice_rand_state)
+		    | ((mask + 1) * 5);
+	}
+
+	failures += check_int(eba_bitslice_pack(planes, values, n + 1) != 0,
+			      1);
+	failures += check_int(eba_bitslice_pack(planes, values, n), 0);
+	eba_bitslice_unpack(unpacked, planes);
+	for (i = 0; i < n; ++i) {
+		values[i] &= mask;
+		failures += check_unsigned_long(unpacked[i], values[i]);
+	}
+
+	eba_bitmatrix_row(results, 0, &out);
+	cs[0] = 0;
+	cs[1] = mask;
+	cs[2] = mask + 1;
+	cs[3] = values[n / 2];
+	cs[4] = mask / 3;
+	for (t = 0; t < 5; ++t) {
+		c = cs[t];
+		lo = c / 2;
+
+		failures += check_int(eba_bitslice_lt(&out, planes, c), 0);
+		found = eba_bitmatrix_row_popcount(results, 0);
+		for (expect = 0, i = 0; i < n; ++i) {
+			expect += (values[i] < c);
+			failures += check_int(eba_get(&out, i), values[i] < c);
+		}
+		failures += check_unsigned_long(found, expect);
+
+		failures += check_int(eba_bitslice_le(&out, planes, c), 0);
+		found = eba_bitmatrix_row_popcount(results, 0);
+		for (expect = 0, i = 0; i < n; ++i) {
+			expect += (values[i] <= c);
+			failures += check_int(eba_get(&out, i), values[i] <= c);
+		}
+		failures += check_unsigned_long(found, expect);
+
+		failures += check_int(eba_bitslice_eq(&out, planes, c), 0);
+		found = eba_bitmatrix_row_popcount(results, 0);
+		for (expect = 0, i = 0; i < n; ++i) {
+			expect += (values[i] == c);
+			failures += check_int(eba_get(&out, i), values[i] == c);
+		}
+		failures += check_unsigned_long(found, expect);
+
+		failures +=
+		    check_int(eba_bitslice_between(&out, planes, lo, c), 0);
+		found = eba_bitmatrix_row_popcount(results, 0);
+		for (expect = 0, i = 0; i < n; ++i) {
+			in = (lo <= values[i]) && (values[i] <= c);
+			expect += in;
+			failures += check_int(eba_get(&out, i), in);
+		}
+		failures += check_unsigned_long(found, expect);
+	}
+
+	out.size_bytes = 1;
+	failures += check_int(eba_bitslice_lt(&out, planes, 1) != 0, 1);
+
+	eba_bitmatrix_free(planes);
+	eba_bitmatrix_free(results);
+	eembed_free(values);
+	eembed_free(unpacked);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitslice(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_bitslice_shape(v, 1, 1);
+	failures += eba_test_bitslice_shape(v, 3, 63);
+	failures += eba_test_bitslice_shape(v, 5, 64);
+	failures += eba_test_bitslice_shape(v, 12, 200);
+	failures += eba_test_bitslice_shape(v, 15, 1000);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_bitslice)
@@ -0,0 +1,192 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bitstream.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_bitstream_bytes 64
+
+unsigned eba_test_bitstream_fields(int verbose, enum eba_endian endian,
+				   unsigned long start)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_bitstream_bytes];
+	struct eba eba;
+	struct eba_bitwriter writer;
+	struct eba_bitreader reader;
+	unsigned ul_bits = sizeof(unsigned long) * 8;
+	unsigned long vals[8] = { 5, 0x1ABC, 0, 1, 0x7F, 0, 3, 0x15 };
+	unsigned nbits[8] = { 3, 13, 0, 1, 7, 0, 2, 5 };
+	unsigned long val = 0;
+	unsigned long pos = 0;
+	size_t i = 0;
+	size_t round = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z_Z_Z(verbose, "eba_test_bitstream_fields", endian,
+				 start, 0);
+
+	/* the full width fields are the bitwise not of the sequence */
+	vals[5] = ~0x123456UL;
+	nbits[5] = ul_bits;
+
+	eembed_memset(bytes, 0xAA, Eba_test_bitstream_bytes);
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_bitstream_bytes;
+	eba.endian = endian;
+
+	eba_bitwriter_init(&writer, &eba, start);
+	for (round = 0; round < 4; ++round) {
+		for (i = 0; i < 8; ++i) {
+			err = eba_bitwriter_put(&writer, vals[i], nbits[i]);
+			failures += check_int(err, 0);
+		}
+	}
+	eba_bitwriter_flush(&writer);
+	failures += check_unsigned_long(eba_bitwriter_position(&writer),
+					start + (4 * (31 + ul_bits)));
+
+	/* the bits before the start are untouched */
+	for (i = 0; i < start; ++i) {
+		failures += check_int(eba_get(&eba, i), (i % 2) ? 1 : 0);
+	}
+	/* the stream is in index order */
+	pos = start;
+	for (i = 0; i < 8; ++i) {
+		val = nbits[i] ? eba_get_bits(&eba, pos, nbits[i]) : 0;
+		failures += check_unsigned_long(val, vals[i]);
+		pos += nbits[i];
+	}
+
+	eba_bitreader_init(&reader, &eba, start);
+	for (round = 0; round < 4; ++round) {
+		for (i = 0; i < 8; ++i) {
+			val = 0xDEAD;
+			err = eba_bitreader_get(&reader, nbits[i], &val);
+			failures += check_int(err, 0);
+			failures += check_unsigned_long(val, vals[i]);
+		}
+	}
+	failures += check_unsigned_long(eba_bitreader_position(&reader),
+					eba_bitwriter_position(&writer));
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitstream_codes(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_bitstream_bytes];
+	struct eba eba;
+	struct eba_bitwriter writer;
+	struct eba_bitreader reader;
+	unsigned long gammas[9] = { 1, 2, 3, 4, 5, 100, 1000, 65536, 0 };
+	unsigned long unaries[5] = { 0, 1, 5, 70, 130 };
+	unsigned long val = 0;
+	size_t i = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_bitstream_codes", endian);
+
+	gammas[8] = ~0UL;
+	eembed_memset(bytes, 0x00, Eba_test_bitstream_bytes);
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_bitstream_bytes;
+	eba.endian = endian;
+
+	eba_bitwriter_init(&writer, &eba, 1);
+	failures += check_int(eba_bitwriter_put_gamma(&writer, 0), 1);
+	for (i = 0; i < 9; ++i) {
+		err = eba_bitwriter_put_gamma(&writer, gammas[i]);
+		failures += check_int(err, 0);
+	}
+	for (i = 0; i < 5; ++i) {
+		err = eba_bitwriter_put_unary(&writer, unaries[i]);
+		failures += check_int(err, 0);
+	}
+	eba_bitwriter_flush(&writer);
+	/* gamma of 1 is a lone one bit, gamma of 2 is "010" */
+	failures += check_int(eba_get(&eba, 1), 1);
+	failures += check_int(eba_get(&eba, 2), 0);
+	failures += check_int(eba_get(&eba, 3), 1);
+	failures += check_int(eba_get(&eba, 4), 0);
+
+	eba_bitreader_init(&reader, &eba, 1);
+	for (i = 0; i < 9; ++i) {
+		val = 0;
+		err = eba_bitreader_get_gamma(&reader, &val);
+		failures += check_int(err, 0);
+		failures += check_unsigned_long(val, gammas[i]);
+	}
+	for (i = 0; i < 5; ++i) {
+		val = 0xDEAD;
+		err = eba_bitreader_get_unary(&reader, &val);
+		failures += check_int(err, 0);
+		failures += check_unsigned_long(val, unaries[i]);
+	}
+	failures += check_unsigned_long(eba_bitreader_position(&reader),
+					eba_bitwriter_position(&writer));
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitstream_ends(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[2] = { 0, 0 };
+	struct eba eba;
+	struct eba_bitwriter writer;
+	struct eba_bitreader reader;
+	unsigned long val = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_bitstream_ends");
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+	eba.endian = eba_endian_little;
+
+	eba_bitwriter_init(&writer, &eba, 0);
+	failures += check_int(eba_bitwriter_put(&writer, 0x3FF, 10), 0);
+	failures += check_int(eba_bitwriter_put(&writer, 0, 7), 1);
+	failures += check_int(eba_bitwriter_put_unary(&writer, 6), 1);
+	failures += check_int(eba_bitwriter_put_gamma(&writer, 8), 1);
+	failures += check_int(eba_bitwriter_put_unary(&writer, 5), 0);
+	failures += check_int(eba_bitwriter_put(&writer, 1, 1), 1);
+	eba_bitwriter_flush(&writer);
+	failures += check_int(bytes[0], 0xFF);
+	failures += check_int(bytes[1], 0x83);
+
+	eba_bitreader_init(&reader, &eba, 0);
+	failures += check_int(eba_bitreader_get(&reader, 9, &val), 0);
+	failures += check_unsigned_long(val, 0x1FF);
+	failures += check_int(eba_bitreader_get(&reader, 8, &val), 1);
+	failures += check_int(eba_bitreader_get(&reader, 7, &val), 0);
+	failures += check_unsigned_long(val, 0x41);
+	failures += check_int(eba_bitreader_get(&reader, 1, &val), 1);
+	failures += check_int(eba_bitreader_get_unary(&reader, &val), 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bitstream(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_bitstream_fields(v, eba_endian_little, 0);
+	failures += eba_test_bitstream_fields(v, eba_endian_little, 3);
+	failures += eba_test_bitstream_fields(v, eba_big_endian, 0);
+	failures += eba_test_bitstream_fields(v, eba_big_endian, 5);
+	failures += eba_test_bitstream_codes(v, eba_endian_little);
+	failures += eba_test_bitstream_codes(v, eba_big_endian);
+	failures += eba_test_bitstream_ends(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_bitstream)
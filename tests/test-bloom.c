@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-bloom.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_bloom_bits 8192
+#define Eba_test_bloom_keys 200
+#define Eba_test_bloom_others 1000
+
+unsigned long eba_test_bloom_key_hash(unsigned long key)
+{
+	return eba_bloom_hash(&key, sizeof(unsigned long));
+}
+
+unsigned eba_test_bloom_layout(int verbose, enum eba_bloom_layout layout)
+{
+	unsigned failures = 0;
+	struct eba_bloom *bloom = NULL;
+	struct eba_bloom *batched = NULL;
+	struct eba_bloom copy;
+	unsigned long hashes[Eba_test_bloom_keys];
+	unsigned char results[Eba_test_bloom_keys];
+	unsigned char *saved = NULL;
+	unsigned long i = 0;
+	size_t found = 0;
+	size_t false_positives = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_bloom_layout", layout);
+
+	bloom = eba_bloom_new(Eba_test_bloom_bits, 4, layout);
+	batched = eba_bloom_new(Eba_test_bloom_bits, 4, layout);
+	saved = (unsigned char *)eembed_malloc(Eba_test_bloom_bits / 8);
+	if (!bloom || !batched || !saved) {
+		eba_bloom_free(bloom);
+		eba_bloom_free(batched);
+		eembed_free(saved);
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_int(bloom->eba.size_bytes, Eba_test_bloom_bits / 8);
+	failures += check_int(((size_t)bloom->eba.bits) % 64, 0);
+	failures += check_int(((size_t)batched->eba.bits) % 64, 0);
+
+	for (i = 0; i < Eba_test_bloom_keys; ++i) {
+		hashes[i] = eba_test_bloom_key_hash(i * 3);
+		failures += check_int(eba_bloom_contains(bloom, hashes[i]), 0);
+		eba_bloom_add(bloom, hashes[i]);
+	}
+
+	/* no false negatives */
+	for (i = 0; i < Eba_test_bloom_keys; ++i) {
+		failures += check_int(eba_bloom_contains(bloom, hashes[i]), 1);
+	}
+
+	/* few false positives: about 2.5% expected */
+	for (i = 0; i < Eba_test_bloom_others; ++i) {
+		unsigned long hash = eba_test_bloom_key_hash(1 + (i * 3));
+		false_positives += eba_bloom_contains(bloom, hash);
+	}
+	failures += check_int(false_positives < (Eba_test_bloom_others / 10),
+			      1);
+
+	/* batches give the same bits as one at a time */
+	eba_bloom_add_batch(batched, hashes, Eba_test_bloom_keys);
+	failures += check_byte_array(batched->eba.bits,
+				     batched->eba.size_bytes,
+				     bloom->eba.bits, bloom->eba.size_bytes);
+	found = eba_bloom_contains_batch(batched, hashes, Eba_test_bloom_keys,
+					 results);
+	failures += check_int(found, Eba_test_bloom_keys);
+	for (i = 0; i < Eba_test_bloom_keys; ++i) {
+		failures += check_int(results[i], 1);
+	}
+
+	/* the filter can be saved and restored from just the bytes */
+	eembed_memcpy(saved, bloom->eba.bits, bloom->eba.size_bytes);
+	err = eba_bloom_init(&copy, saved, Eba_test_bloom_bits / 8, 4, layout);
+	failures += check_int(err, 0);
+	for (i = 0; i < Eba_test_bloom_keys; ++i) {
+		failures += check_int(eba_bloom_contains(&copy, hashes[i]), 1);
+	}
+	for (i = 0; i < Eba_test_bloom_others; ++i) {
+		unsigned long hash = eba_test_bloom_key_hash(1 + (i * 3));
+		failures += check_int(eba_bloom_contains(&copy, hash),
+				      eba_bloom_contains(bloom, hash));
+	}
+
+	eembed_free(saved);
+	eba_bloom_free(batched);
+	eba_bloom_free(bloom);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bloom_init_errors(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_bloom bloom;
+	unsigned char bytes[130];
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_bloom_init_errors");
+
+	failures += check_int(eba_bloom_init(&bloom, bytes, 130, 3,
+					     eba_bloom_standard), 0);
+	failures += check_int(eba_bloom_init(&bloom, bytes, 130, 3,
+					     eba_bloom_blocked), 1);
+	failures += check_int(eba_bloom_init(&bloom, bytes, 128, 3,
+					     eba_bloom_blocked), 0);
+	failures += check_int(eba_bloom_init(&bloom, bytes, 128, 0,
+					     eba_bloom_blocked), 1);
+	failures += check_int(eba_bloom_init(&bloom, NULL, 128, 3,
+					     eba_bloom_blocked), 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_bloom(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_bloom_layout(v, eba_bloom_standard);
+	failures += eba_test_bloom_layout(v, eba_bloom_blocked);
+	failures += eba_test_bloom_init_errors(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_bloom)
@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-compress.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_compress_max 300
+
+struct eba_test_compress_bufs {
+	unsigned int src_ui[Eba_test_compress_max];
+	unsigned int dst_ui[Eba_test_compress_max];
+	unsigned int exp_ui[Eba_test_compress_max];
+	unsigned long src_ul[Eba_test_compress_max];
+	unsigned long dst_ul[Eba_test_compress_max];
+	unsigned long exp_ul[Eba_test_compress_max];
+};
+
+static unsigned long eba_test_compress_rand_state = 13;
+
+unsigned eba_test_compress_n(int verbose, enum eba_isa isa, size_t n,
+			     enum eba_endian endian, unsigned density)
+{
+	unsigned failures = 0;
+	unsigned char mask_bytes[(Eba_test_compress_max / 8) + 1];
+	struct eba_test_compress_bufs *b = NULL;
+	unsigned int *src_ui = NULL;
+	unsigned int *dst_ui = NULL;
+	unsigned int *exp_ui = NULL;
+	unsigned long *src_ul = NULL;
+	unsigned long *dst_ul = NULL;
+	unsigned long *exp_ul = NULL;
+	struct eba mask;
+	size_t expect = 0;
+	size_t got = 0;
+	size_t i = 0;
+	unsigned long roll = 0;
+	size_t k = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_compress", n);
+
+	b = (struct eba_test_compress_bufs *)
+	    eembed_malloc(sizeof(struct eba_test_compress_bufs));
+	if (!b) {
+		return EEMBED_HOSTED;
+	}
+	src_ui = b->src_ui;
+	dst_ui = b->dst_ui;
+	exp_ui = b->exp_ui;
+	src_ul = b->src_ul;
+	dst_ul = b->dst_ul;
+	exp_ul = b->exp_ul;
+
+	failures += check_int(eba_isa_force(isa) <= isa, 1);
+
+	mask.bits = mask_bytes;
+	mask.size_bytes = (n / 8) + 1;
+	mask.endian = endian;
+	/* set bits past n, which must be ignored */
+	eembed_memset(mask_bytes, 0xFF, sizeof(mask_bytes));
+	for (i = 0; i < n; ++i) {
+		roll = EBA_TEST_RAND(eba_test_compress_rand_state);
+		eba_set(&mask, i, (roll % 100) < density);
+		src_ui[i] = (unsigned int)(1000 + i);
+		src_ul[i] = 7000000UL + i;
+		dst_ui[i] = 7;
+		dst_ul[i] = 7;
+	}
+
+	for (expect = 0, i = 0; i < n; ++i) {
+		if (eba_get(&mask, i)) {
+			exp_ui[expect] = src_ui[i];
+			exp_ul[expect] = src_ul[i];
+			++expect;
+		}
+	}
+
+	got = eba_compress_ui(&mask, n, src_ui, dst_ui);
+	failures += check_size_t(got, expect);
+	for (k = 0; k < expect; ++k) {
+		failures += check_unsigned_long(dst_ui[k], exp_ui[k]);
+	}
+	for (; k < n; ++k) {
+		failures += check_unsigned_long(dst_ui[k], 7);
+	}
+	got = eba_compress_ul(&mask, n, src_ul, dst_ul);
+	failures += check_size_t(got, expect);
+	for (k = 0; k < expect; ++k) {
+		failures += check_unsigned_long(dst_ul[k], exp_ul[k]);
+	}
+	for (; k < n; ++k) {
+		failures += check_unsigned_long(dst_ul[k], 7);
+	}
+
+	/* expanding the compressed values puts them back in place */
+	for (i = 0; i < n; ++i) {
+		src_ui[i] = 9;
+		src_ul[i] = 9;
+	}
+	failures += check_size_t(eba_expand_ui(&mask, n, dst_ui, src_ui),
+				 expect);
+	failures += check_size_t(eba_expand_ul(&mask, n, dst_ul, src_ul),
+				 expect);
+	for (i = 0; i < n; ++i) {
+		if (eba_get(&mask, i)) {
+			failures += check_unsigned_long(src_ui[i], 1000 + i);
+			failures += check_unsigned_long(src_ul[i],
+							7000000UL + i);
+		} else {
+			failures += check_unsigned_long(src_ui[i], 9);
+			failures += check_unsigned_long(src_ul[i], 9);
+		}
+	}
+
+	/* compressing in place */
+	for (i = 0; i < n; ++i) {
+		src_ul[i] = 7000000UL + i;
+	}
+	failures += check_size_t(eba_compress_ul(&mask, n, src_ul, src_ul),
+				 expect);
+	for (k = 0; k < expect; ++k) {
+		failures += check_unsigned_long(src_ul[k], exp_ul[k]);
+	}
+
+	eembed_free(b);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_compress_isa(int v, enum eba_isa isa)
+{
+	unsigned failures = 0;
+	size_t sizes[6] = { 1, 15, 64, 65, 200, Eba_test_compress_max };
+	unsigned densities[4] = { 0, 10, 60, 100 };
+	size_t i = 0;
+	size_t j = 0;
+
+	for (i = 0; i < 6; ++i) {
+		for (j = 0; j < 4; ++j) {
+			failures += eba_test_compress_n(v, isa, sizes[i],
+							eba_endian_little,
+							densities[j]);
+			failures += eba_test_compress_n(v, isa, sizes[i],
+							eba_big_endian,
+							densities[j]);
+		}
+	}
+	return failures;
+}
+
+unsigned eba_test_compress(int v)
+{
+	unsigned failures = 0;
+	enum eba_isa start = eba_isa_current();
+
+	failures += eba_test_compress_isa(v, eba_isa_portable);
+	failures += eba_test_compress_isa(v, eba_isa_avx512);
+
+	failures += check_int(eba_isa_force(start), start);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_compress)
@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-copy-bits.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_copy_bytes 24
+
+void eba_test_copy_fill(unsigned char *bytes, size_t len, unsigned seed)
+{
+	size_t i = 0;
+
+	for (i = 0; i < len; ++i) {
+		seed = (seed * 75U) + 74U;
+		bytes[i] = (unsigned char)(seed >> 3);
+	}
+}
+
+/* one bit at a time, through a buffer, to allow for overlap */
+void eba_test_copy_slowly(struct eba *dst, unsigned long dst_index,
+			  struct eba *src, unsigned long src_index,
+			  unsigned long nbits)
+{
+	unsigned char buf[Eba_test_copy_bytes];
+	struct eba tmp;
+	unsigned long i = 0;
+
+	tmp.bits = buf;
+	tmp.size_bytes = Eba_test_copy_bytes;
+	tmp.endian = eba_endian_little;
+	for (i = 0; i < nbits; ++i) {
+		eba_set(&tmp, i, eba_get(src, src_index + i));
+	}
+	for (i = 0; i < nbits; ++i) {
+		eba_set(dst, dst_index + i, eba_get(&tmp, i));
+	}
+}
+
+unsigned eba_test_copy_bits_endians(int verbose, enum eba_endian dst_endian,
+				    enum eba_endian src_endian)
+{
+	unsigned failures = 0;
+	unsigned char dst_bytes[Eba_test_copy_bytes];
+	unsigned char src_bytes[Eba_test_copy_bytes];
+	unsigned char expect_bytes[Eba_test_copy_bytes];
+	struct eba dst;
+	struct eba src;
+	struct eba expect;
+	unsigned long dst_offsets[5] = { 0, 1, 3, 8, 13 };
+	unsigned long src_offsets[5] = { 0, 5, 8, 11, 16 };
+	unsigned long lengths[7] = { 0, 1, 7, 40, 65, 100, 150 };
+	size_t d = 0;
+	size_t s = 0;
+	size_t l = 0;
+
+	VERBOSE_ANNOUNCE_S_Z_Z_Z(verbose, "eba_test_copy_bits_endians",
+				 dst_endian, src_endian, 0);
+
+	dst.bits = dst_bytes;
+	dst.size_bytes = Eba_test_copy_bytes;
+	dst.endian = dst_endian;
+	src.bits = src_bytes;
+	src.size_bytes = Eba_test_copy_bytes;
+	src.endian = src_endian;
+	expect.bits = expect_bytes;
+	expect.size_bytes = Eba_test_copy_bytes;
+	expect.endian = dst_endian;
+
+	eba_test_copy_fill(src_bytes, Eba_test_copy_bytes, 17);
+	for (d = 0; d < 5; ++d) {
+		for (s = 0; s < 5; ++s) {
+			for (l = 0; l < 7; ++l) {
+				eba_test_copy_fill(dst_bytes,
+						   Eba_test_copy_bytes, 3);
+				eba_test_copy_fill(expect_bytes,
+						   Eba_test_copy_bytes, 3);
+				eba_test_copy_slowly(&expect, dst_offsets[d],
+						     &src, src_offsets[s],
+						     lengths[l]);
+				eba_copy_bits(&dst, dst_offsets[d], &src,
+					      src_offsets[s], lengths[l]);
+				failures +=
+				    check_byte_array(dst_bytes,
+						     Eba_test_copy_bytes,
+						     expect_bytes,
+						     Eba_test_copy_bytes);
+			}
+		}
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_copy_bits_overlap(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_copy_bytes];
+	unsigned char expect_bytes[Eba_test_copy_bytes];
+	struct eba eba;
+	struct eba expect;
+	unsigned long offsets[6] = { 0, 1, 8, 9, 30, 43 };
+	unsigned long nbits = 0;
+	size_t from = 0;
+	size_t to = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_copy_bits_overlap", endian);
+
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_copy_bytes;
+	eba.endian = endian;
+	expect.bits = expect_bytes;
+	expect.size_bytes = Eba_test_copy_bytes;
+	expect.endian = endian;
+
+	for (from = 0; from < 6; ++from) {
+		for (to = 0; to < 6; ++to) {
+			nbits = (Eba_test_copy_bytes * 8) - 43;
+			eba_test_copy_fill(bytes, Eba_test_copy_bytes, 5);
+			eba_test_copy_fill(expect_bytes, Eba_test_copy_bytes,
+					   5);
+			eba_test_copy_slowly(&expect, offsets[to], &expect,
+					     offsets[from], nbits);
+			eba_copy_bits(&eba, offsets[to], &eba, offsets[from],
+				      nbits);
+			failures += check_byte_array(bytes,
+						     Eba_test_copy_bytes,
+						     expect_bytes,
+						     Eba_test_copy_bytes);
+		}
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_copy_bits(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_copy_bits_endians(v, eba_endian_little,
+					       eba_endian_little);
+	failures += eba_test_copy_bits_endians(v, eba_endian_little,
+					       eba_big_endian);
+	failures += eba_test_copy_bits_endians(v, eba_big_endian,
+					       eba_endian_little);
+	failures += eba_test_copy_bits_endians(v, eba_big_endian,
+					       eba_big_endian);
+	failures += eba_test_copy_bits_overlap(v, eba_endian_little);
+	failures += eba_test_copy_bits_overlap(v, eba_big_endian);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_copy_bits)
@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-counters.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+unsigned eba_test_counters_width(int verbose, unsigned bits_per_counter)
+{
+	unsigned failures = 0;
+	struct eba_counters *counters = NULL;
+	size_t indexes[6] = { 3, 7, 3, 0, 9, 3 };
+	size_t i = 0;
+	unsigned max = (1U << bits_per_counter) - 1;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_counters_width",
+			     bits_per_counter);
+
+	counters = eba_counters_new(10, bits_per_counter);
+	if (!counters) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_int(counters->size >= 10, 1);
+	failures += check_int(counters->max, max);
+
+	for (i = 0; i < 10; ++i) {
+		failures += check_int(eba_counters_get(counters, i), 0);
+	}
+
+	eba_counters_increment_batch(counters, indexes, 6);
+	failures += check_int(eba_counters_get(counters, 0), 1);
+	failures += check_int(eba_counters_get(counters, 1), 0);
+	failures += check_int(eba_counters_get(counters, 3), max < 3 ? max : 3);
+	failures += check_int(eba_counters_get(counters, 7), 1);
+	failures += check_int(eba_counters_get(counters, 9), 1);
+
+	eba_counters_decrement_batch(counters, indexes, 6);
+	for (i = 0; i < 10; ++i) {
+		failures += check_int(eba_counters_get(counters, i), 0);
+	}
+
+	/* saturating */
+	failures += check_int(eba_counters_decrement(counters, 4), 0);
+	for (i = 0; i < 300; ++i) {
+		eba_counters_increment(counters, 4);
+	}
+	failures += check_int(eba_counters_get(counters, 4), max);
+	failures += check_int(eba_counters_get(counters, 3), 0);
+	failures += check_int(eba_counters_get(counters, 5), 0);
+	eba_counters_set(counters, 5, 1000);
+	failures += check_int(eba_counters_get(counters, 5), max);
+	failures += check_int(eba_counters_decrement(counters, 5), max - 1);
+
+	eba_counters_free(counters);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_counting_bloom(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_counting_bloom bloom;
+	unsigned char bytes[512];
+	unsigned long i = 0;
+	unsigned long hash = 0;
+	unsigned long twice = 1000;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_counting_bloom");
+
+	eembed_memset(bytes, 0x00, 512);
+	failures += check_int(eba_counting_bloom_init(&bloom, bytes, 512, 3, 4),
+			      1);
+	err = eba_counting_bloom_init(&bloom, bytes, 512, 4, 4);
+	failures += check_int(err, 0);
+	failures += check_int(bloom.counters.size, 1024);
+
+	for (i = 0; i < 50; ++i) {
+		hash = eba_bloom_hash(&i, sizeof(unsigned long));
+		eba_counting_bloom_add(&bloom, hash);
+	}
+	hash = eba_bloom_hash(&twice, sizeof(unsigned long));
+	eba_counting_bloom_add(&bloom, hash);
+	eba_counting_bloom_add(&bloom, hash);
+	failures += check_int(eba_counting_bloom_count(&bloom, hash) >= 2, 1);
+
+	for (i = 0; i < 50; ++i) {
+		hash = eba_bloom_hash(&i, sizeof(unsigned long));
+		failures += check_int(eba_counting_bloom_contains(&bloom, hash),
+				      1);
+	}
+
+	/* remove the even keys, the odd keys must remain */
+	for (i = 0; i < 50; i += 2) {
+		hash = eba_bloom_hash(&i, sizeof(unsigned long));
+		failures += check_int(eba_counting_bloom_remove(&bloom, hash),
+				      0);
+	}
+	for (i = 1; i < 50; i += 2) {
+		hash = eba_bloom_hash(&i, sizeof(unsigned long));
+		failures += check_int(eba_counting_bloom_contains(&bloom, hash),
+				      1);
+	}
+
+	/* remove everything, and it is empty again */
+	for (i = 1; i < 50; i += 2) {
+		hash = eba_bloom_hash(&i, sizeof(unsigned long));
+		eba_counting_bloom_remove(&bloom, hash);
+	}
+	hash = eba_bloom_hash(&twice, sizeof(unsigned long));
+	eba_counting_bloom_remove(&bloom, hash);
+	failures += check_int(eba_counting_bloom_contains(&bloom, hash), 1);
+	eba_counting_bloom_remove(&bloom, hash);
+	failures += check_int(eba_counting_bloom_contains(&bloom, hash), 0);
+	failures += check_int(eba_counting_bloom_remove(&bloom, hash), 1);
+	for (i = 0; i < 512; ++i) {
+		failures += check_int(bytes[i], 0);
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_counters(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_counters_width(v, 2);
+	failures += eba_test_counters_width(v, 4);
+	failures += eba_test_counters_width(v, 8);
+	failures += eba_test_counting_bloom(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_counters)
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-cow.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_cow_page_bits (((unsigned long)EBA_COW_PAGE_BYTES) * 8)
+
+unsigned eba_test_cow_snapshot_endian(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned long num_bits = (2 * Eba_test_cow_page_bits) + 100;
+	unsigned long last = num_bits - 1;
+	struct eba_cow *cow = NULL;
+	struct eba_cow *snap = NULL;
+	struct eba_cow *snap2 = NULL;
+	struct eba view;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_cow_snapshot_endian", endian);
+
+	cow = eba_cow_new(num_bits, endian);
+	if (!cow) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_unsigned_long(cow->num_pages, 3);
+	failures += check_int(eba_cow_get(cow, last), 0);
+
+	failures += check_int(eba_cow_set(cow, 3, 1), 0);
+	failures += check_int(eba_cow_set(cow, last, 1), 0);
+	failures += check_unsigned_long(eba_cow_private_pages(cow), 3);
+
+	snap = eba_cow_snapshot(cow);
+	if (!snap) {
+		eba_cow_free(cow);
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_unsigned_long(eba_cow_private_pages(cow), 0);
+	failures += check_ptr(snap->pages[1], cow->pages[1]);
+
+	/* writes to the array only copy the page written */
+	failures += check_int(eba_cow_set(cow, 3, 0), 0);
+	failures += check_int(eba_cow_set(cow, Eba_test_cow_page_bits, 1), 0);
+	failures += check_unsigned_long(eba_cow_private_pages(cow), 2);
+	failures += check_unsigned_long(eba_cow_private_pages(snap), 2);
+	failures += check_ptr(snap->pages[2], cow->pages[2]);
+
+	failures += check_int(eba_cow_get(snap, 3), 1);
+	failures += check_int(eba_cow_get(snap, Eba_test_cow_page_bits), 0);
+	failures += check_int(eba_cow_get(snap, last), 1);
+	failures += check_int(eba_cow_get(cow, 3), 0);
+	failures += check_int(eba_cow_get(cow, Eba_test_cow_page_bits), 1);
+
+	/* a page view works with the plain eba functions */
+	eba_cow_page_view(snap, 2, &view);
+	failures += check_unsigned_long(view.size_bytes, 13);
+	failures += check_int(eba_get(&view, 99), 1);
+	failures += check_int(view.endian, endian);
+
+	/* writes to the snapshot do not show through to the array */
+	snap2 = eba_cow_snapshot(snap);
+	failures += check_int(eba_cow_page_write(snap, 2, &view), 0);
+	eba_set(&view, 98, 1);
+	failures += check_int(eba_cow_get(snap, last - 1), 1);
+	failures += check_int(eba_cow_get(cow, last - 1), 0);
+	if (snap2) {
+		failures += check_int(eba_cow_get(snap2, last - 1), 0);
+		failures += check_int(eba_cow_get(snap2, 3), 1);
+	}
+
+	/* the array outlives the snapshots, or the other way around */
+	eba_cow_free(cow);
+	failures += check_int(eba_cow_get(snap, 3), 1);
+	eba_cow_free(snap);
+	eba_cow_free(snap2);
+	eba_cow_free(NULL);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_cow_small(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_cow *cow = NULL;
+	struct eba view;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_cow_small");
+
+	cow = eba_cow_new(10, eba_big_endian);
+	if (!cow) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_unsigned_long(cow->num_pages, 1);
+	eba_cow_set(cow, 9, 1);
+	eba_cow_page_view(cow, 0, &view);
+	failures += check_unsigned_long(view.size_bytes, 2);
+	failures += check_int(view.bits[0], 0x02);
+	failures += check_int(view.bits[1], 0x00);
+	eba_cow_free(cow);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_cow(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_cow_snapshot_endian(v, eba_endian_little);
+	failures += eba_test_cow_snapshot_endian(v, eba_big_endian);
+	failures += eba_test_cow_small(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_cow)
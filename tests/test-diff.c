@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-diff.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_diff_bytes 37
+
+unsigned eba_test_diff_patch(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char old_bytes[Eba_test_diff_bytes];
+	unsigned char new_bytes[Eba_test_diff_bytes];
+	unsigned char copy_bytes[Eba_test_diff_bytes];
+	unsigned char patch[64];
+	struct eba old_eba;
+	struct eba new_eba;
+	struct eba copy;
+	size_t len = 0;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_diff_patch");
+
+	for (i = 0; i < Eba_test_diff_bytes; ++i) {
+		old_bytes[i] = (unsigned char)(i * 7);
+		new_bytes[i] = old_bytes[i];
+		copy_bytes[i] = old_bytes[i];
+	}
+	old_eba.bits = old_bytes;
+	old_eba.size_bytes = Eba_test_diff_bytes;
+	old_eba.endian = eba_endian_little;
+	new_eba = old_eba;
+	new_eba.bits = new_bytes;
+	copy = old_eba;
+	copy.bits = copy_bytes;
+
+	failures += check_int(eba_diff(&old_eba, &new_eba, NULL, patch, 0), 0);
+
+	/* words 0 and 1 are one run, the short last word (4) another */
+	eba_toggle(&new_eba, 3);
+	eba_toggle(&new_eba, (8 * 8) + 1);
+	eba_toggle(&new_eba, (8 * 36) + 7);
+
+	len = eba_diff(&old_eba, &new_eba, NULL, patch, 0);
+	failures += check_int(len, 2 + 16 + 2 + 5);
+	failures += check_int(eba_diff(&old_eba, &new_eba, NULL, patch,
+				       sizeof(patch)), len);
+	failures += check_int(patch[0], 0);
+	failures += check_int(patch[1], 2);
+	failures += check_int(patch[18], 2);
+	failures += check_int(patch[19], 1);
+
+	failures += check_int(eba_patch(&copy, patch, len), 0);
+	failures += check_byte_array(copy_bytes, Eba_test_diff_bytes,
+				     new_bytes, Eba_test_diff_bytes);
+
+	/* and back again */
+	failures += check_int(eba_patch(&copy, patch, len), 0);
+	failures += check_byte_array(copy_bytes, Eba_test_diff_bytes,
+				     old_bytes, Eba_test_diff_bytes);
+
+	/* a truncated patch leaves the array alone */
+	failures += check_int(eba_patch(&copy, patch, len - 1), 1);
+	failures += check_byte_array(copy_bytes, Eba_test_diff_bytes,
+				     old_bytes, Eba_test_diff_bytes);
+	patch[18] = 3;
+	failures += check_int(eba_patch(&copy, patch, len), 1);
+	failures += check_byte_array(copy_bytes, Eba_test_diff_bytes,
+				     old_bytes, Eba_test_diff_bytes);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_diff_dirty(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned long num_bits = 8 * 8 * 100;
+	struct eba *old_eba = NULL;
+	struct eba *new_eba = NULL;
+	struct eba *dirty = NULL;
+	unsigned char patch[64];
+	size_t len = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_diff_dirty", endian);
+
+	old_eba = eba_new_endian(num_bits, endian);
+	new_eba = eba_new_endian(num_bits, endian);
+	dirty = eba_new_endian(eba_diff_dirty_bits(num_bits / 8),
+			       eba_endian_little);
+	if (!old_eba || !new_eba || !dirty) {
+		eba_free(old_eba);
+		eba_free(new_eba);
+		eba_free(dirty);
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_int(eba_diff_dirty_bits(num_bits / 8), 100);
+
+	eba_set(new_eba, 70, 1);
+	eba_diff_touch(dirty, new_eba, 70);
+	eba_set(new_eba, 5000, 1);
+	eba_diff_touch(dirty, new_eba, 5000);
+	/* a write which was not tracked is not seen */
+	eba_set(new_eba, 3000, 1);
+	/* a tracked write back to the old value is not in the patch */
+	eba_diff_touch(dirty, new_eba, 6000);
+
+	len = eba_diff(old_eba, new_eba, dirty, patch, sizeof(patch));
+	failures += check_int(len, (2 + 8) + (2 + 8));
+	if (endian == eba_endian_little) {
+		failures += check_int(patch[0], 1);
+		failures += check_int(patch[10], (5000 / 64) - 2);
+	} else {
+		/* the words are counted from the end */
+		failures += check_int(patch[0], 99 - (5000 / 64));
+		failures += check_int(patch[10], (5000 / 64) - 2);
+	}
+
+	failures += check_int(eba_patch(old_eba, patch, len), 0);
+	failures += check_int(eba_get(old_eba, 70), 1);
+	failures += check_int(eba_get(old_eba, 5000), 1);
+	failures += check_int(eba_get(old_eba, 3000), 0);
+
+	/* the full compare finds the rest */
+	len = eba_diff(old_eba, new_eba, NULL, patch, sizeof(patch));
+	failures += check_int(len, 2 + 8);
+	if (endian == eba_endian_little) {
+		failures += check_int(patch[0], 3000 / 64);
+	} else {
+		failures += check_int(patch[0], 99 - (3000 / 64));
+	}
+
+	eba_free(old_eba);
+	eba_free(new_eba);
+	eba_free(dirty);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_diff(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_diff_patch(v);
+	failures += eba_test_diff_dirty(v, eba_endian_little);
+	failures += eba_test_diff_dirty(v, eba_big_endian);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_diff)
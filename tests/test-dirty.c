@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-dirty.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+/* 10 regions of 16 bytes, the last is short */
+#define Eba_test_dirty_bytes ((16 * 9) + 4)
+
+unsigned eba_test_dirty_endian(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_dirty_bytes];
+	unsigned char marks[2];
+	unsigned char src_bytes[4];
+	struct eba_dirty dirty;
+	struct eba eba;
+	struct eba src;
+	size_t start = 0;
+	size_t len = 0;
+	size_t last = 0;
+	size_t first = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_dirty_endian", endian);
+
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_dirty_bytes;
+	eba.endian = endian;
+	eba_set_all(&eba, 0);
+	/* bit 0 is in the first byte, or the last byte if big endian */
+	first = (endian == eba_big_endian) ? 9 : 0;
+	last = 9 - first;
+
+	failures += check_int(eba_dirty_marks_bytes(Eba_test_dirty_bytes, 16),
+			      2);
+	failures += check_int(eba_dirty_init(&dirty, &eba, 12, marks, 2), 1);
+	failures += check_int(eba_dirty_init(&dirty, &eba, 16, marks, 1), 1);
+	failures += check_int(eba_dirty_init(&dirty, &eba, 16, marks, 2), 0);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 1);
+
+	eba_dirty_set(&dirty, 0, 1);
+	failures += check_int(eba_get(&eba, 0), 1);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 0);
+	failures += check_int(start, first * 16);
+	failures += check_int(len, (first == 9) ? 4 : 16);
+
+	/* a range over two regions, ending at the last bit */
+	eba_dirty_clear(&dirty);
+	eba_dirty_set_bits(&dirty, (Eba_test_dirty_bytes * 8) - 132, 8, 0xFF);
+	eba_dirty_toggle(&dirty, (Eba_test_dirty_bytes * 8) - 1);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 0);
+	if (endian == eba_big_endian) {
+		failures += check_int(start, 0);
+		failures += check_int(len, 32);
+	} else {
+		failures += check_int(start, 8 * 16);
+		failures += check_int(len, 16 + 4);
+	}
+	failures += check_int(eba_dirty_next(&dirty, start + len, &start,
+					     &len), 1);
+
+	eba_dirty_clear_range(&dirty, (last == 9) ? (9 * 16) : 0, 1);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 0);
+	failures += check_int(start, (last == 9) ? (8 * 16) : 16);
+	failures += check_int(len, 16);
+
+	/* a run of regions, after a gap */
+	eba_dirty_clear(&dirty);
+	src.bits = src_bytes;
+	src.size_bytes = 4;
+	src.endian = eba_endian_little;
+	eba_set_all(&src, 0xFF);
+	eba_dirty_copy_bits(&dirty, 3 * 16 * 8, &src, 0, 32);
+	eba_dirty_swap(&dirty, 0, 1);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 0);
+	failures += check_int(start, (endian == eba_big_endian) ? 96 : 0);
+	failures += check_int(len, 16);
+	failures += check_int(eba_dirty_next(&dirty, start + len, &start,
+					     &len), 0);
+	failures += check_int(start, (endian == eba_big_endian) ? 144 : 48);
+	failures += check_int(len, (endian == eba_big_endian) ? 4 : 16);
+
+	eba_dirty_clear(&dirty);
+	eba_dirty_shift_left(&dirty, 0);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 1);
+	eba_dirty_shift_left(&dirty, 1);
+	failures += check_int(eba_dirty_next(&dirty, 0, &start, &len), 0);
+	failures += check_int(start, 0);
+	failures += check_int(len, Eba_test_dirty_bytes);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_dirty_diff(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char old_bytes[64];
+	unsigned char new_bytes[64];
+	unsigned char marks[1];
+	unsigned char patch[32];
+	struct eba_dirty dirty;
+	struct eba old_eba;
+	struct eba new_eba;
+	size_t len = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_dirty_diff");
+
+	old_eba.bits = old_bytes;
+	old_eba.size_bytes = 64;
+	old_eba.endian = eba_endian_little;
+	new_eba = old_eba;
+	new_eba.bits = new_bytes;
+	eba_set_all(&old_eba, 0);
+	eba_set_all(&new_eba, 0);
+
+	/* the marks of words are a map of dirty words for eba_diff */
+	failures += check_int(eba_dirty_init(&dirty, &new_eba,
+					     EBA_DIFF_WORD_BYTES, marks, 1), 0);
+	eba_dirty_set(&dirty, 100, 1);
+	eba_set(&new_eba, 200, 1);
+	len = eba_diff(&old_eba, &new_eba, &dirty.marks, patch, sizeof(patch));
+	failures += check_int(len, 2 + 8);
+	failures += check_int(patch[0], 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_dirty(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_dirty_endian(v, eba_endian_little);
+	failures += eba_test_dirty_endian(v, eba_big_endian);
+	failures += eba_test_dirty_diff(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_dirty)
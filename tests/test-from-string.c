@@ -0,0 +1,294 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-from-string.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+#include <limits.h>
+
+unsigned eba_test_from_string_binary(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[2];
+	struct eba eba;
+	const char *str = NULL;
+	size_t error_pos = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_from_string_binary", endian);
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+	eba.endian = endian;
+	eembed_memset(bytes, 0xA5, 2);
+
+	if (endian == eba_big_endian) {
+		str = "00000001 00101110";
+	} else {
+		str = "01110100 10000000";
+	}
+	err = eba_from_string(&eba, str, eembed_strlen(str), &error_pos);
+	failures += check_int(err, 0);
+
+	failures += check_int(eba_get(&eba, 0), 0);
+	failures += check_int(eba_get(&eba, 1), 1);
+	failures += check_int(eba_get(&eba, 2), 1);
+	failures += check_int(eba_get(&eba, 3), 1);
+	failures += check_int(eba_get(&eba, 4), 0);
+	failures += check_int(eba_get(&eba, 5), 1);
+	failures += check_int(eba_get(&eba, 6), 0);
+	failures += check_int(eba_get(&eba, 7), 0);
+	failures += check_int(eba_get(&eba, 8), 1);
+	failures += check_int(eba_get(&eba, 9), 0);
+	failures += check_int(eba_get(&eba, 15), 0);
+
+	/* spaces are optional */
+	err = eba_from_string(&eba, "1111111100000000", 16, NULL);
+	failures += check_int(err, 0);
+	failures += check_int(bytes[0], 0xFF);
+	failures += check_int(bytes[1], 0x00);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_from_string_errors(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[2];
+	struct eba eba;
+	const char *str = NULL;
+	size_t error_pos = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_from_string_errors");
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+	eba.endian = eba_big_endian;
+
+	str = "00000001 00102110";
+	err = eba_from_string(&eba, str, eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 13);
+
+	/* too short */
+	str = "00000001 0010111";
+	err = eba_from_string(&eba, str, eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 16);
+
+	/* too long */
+	str = "00000001 00101110 1";
+	err = eba_from_string(&eba, str, eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 18);
+
+	/* the truncation marker of eba_to_string is not valid */
+	str = "00000001 !";
+	err = eba_from_string(&eba, str, eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 9);
+
+	/* len is respected */
+	str = "00000001 00101110 1";
+	err = eba_from_string(&eba, str, 17, &error_pos);
+	failures += check_int(err, 0);
+
+	err = eba_from_string(NULL, str, 17, &error_pos);
+	failures += check_int(err, 1);
+	err = eba_from_string(&eba, NULL, 17, &error_pos);
+	failures += check_int(err, 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+/* a '\0' ends the string even when len is longer, and nothing past it
+ * may be read; the strings are copied to the heap, exactly sized, so
+ * that valgrind or a sanitizer would see a read past the end */
+unsigned eba_test_from_string_short_nul(int verbose)
+{
+	unsigned failures = 0;
+	const char *strs[3] = { "1", "0101", "00000001 0010111" };
+	unsigned char bytes[2];
+	struct eba eba;
+	char *copy = NULL;
+	size_t error_pos = 0;
+	size_t len = 0;
+	size_t i = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_from_string_short_nul");
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+	eba.endian = eba_big_endian;
+
+	for (i = 0; i < 3; ++i) {
+		len = eembed_strlen(strs[i]);
+		copy = (char *)eembed_malloc(len + 1);
+		if (!copy) {
+			return EEMBED_HOSTED;
+		}
+		eembed_memcpy(copy, strs[i], len + 1);
+		error_pos = 0;
+		err = eba_from_string(&eba, copy, 1000, &error_pos);
+		failures += check_int(err, 1);
+		failures += check_size_t(error_pos, len);
+		eembed_free(copy);
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_from_string_hex(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[3];
+	struct eba eba;
+	const char *str = NULL;
+	size_t error_pos = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_from_string_hex");
+
+	eba.bits = bytes;
+	eba.size_bytes = 3;
+	eba.endian = eba_endian_little;
+
+	str = "012eFf";
+	err = eba_from_string_format(&eba, eba_string_hex, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 0);
+	failures += check_int(bytes[0], 0x01);
+	failures += check_int(bytes[1], 0x2E);
+	failures += check_int(bytes[2], 0xFF);
+
+	str = "01 2e fg";
+	err = eba_from_string_format(&eba, eba_string_hex, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 7);
+
+	str = "012eff0";
+	err = eba_from_string_format(&eba, eba_string_hex, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 6);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_from_string_runs(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[3];
+	struct eba eba;
+	const char *str = NULL;
+	size_t error_pos = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_from_string_runs");
+
+	eba.bits = bytes;
+	eba.size_bytes = 3;
+	eba.endian = eba_big_endian;
+
+	str = "0*7 1*11 0*6";
+	err = eba_from_string_format(&eba, eba_string_runs, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 0);
+	failures += check_int(bytes[0], 0x01);
+	failures += check_int(bytes[1], 0xFF);
+	failures += check_int(bytes[2], 0xC0);
+
+	str = "0*7 1*11 0*7";
+	err = eba_from_string_format(&eba, eba_string_runs, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 11);
+
+	str = "0*7 1 0*6";
+	err = eba_from_string_format(&eba, eba_string_runs, str,
+				     eembed_strlen(str), &error_pos);
+	failures += check_int(err, 1);
+	failures += check_int(error_pos, 4);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+#define Eba_test_rt_bytes 16
+/* worst case is the runs format, "0*1 1*1 ..." */
+#define Eba_test_rt_str_len ((Eba_test_rt_bytes * CHAR_BIT * 4) + 1)
+
+unsigned eba_test_from_string_round_trip(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_rt_bytes];
+	unsigned char parsed[Eba_test_rt_bytes];
+	char buf[Eba_test_rt_str_len];
+	struct eba eba;
+	struct eba eba2;
+	size_t i = 0;
+	size_t error_pos = 0;
+	int err = 0;
+	enum eba_string_format format = eba_string_binary;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_from_string_round_trip",
+			     endian);
+
+	for (i = 0; i < Eba_test_rt_bytes; ++i) {
+		bytes[i] = (unsigned char)((i * 53) ^ (i >> 2));
+	}
+	bytes[5] = 0x00;
+	bytes[6] = 0x00;
+	bytes[9] = 0xFF;
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_rt_bytes;
+	eba.endian = endian;
+
+	eba2.bits = parsed;
+	eba2.size_bytes = Eba_test_rt_bytes;
+	eba2.endian = endian;
+
+	for (format = eba_string_binary; format <= eba_string_runs;
+	     format = (enum eba_string_format)(format + 1)) {
+		eembed_memset(parsed, 0x5A, Eba_test_rt_bytes);
+		eba_to_string_format(&eba, format, buf, Eba_test_rt_str_len);
+		err = eba_from_string_format(&eba2, format, buf,
+					     eembed_strlen(buf), &error_pos);
+		failures += check_int(err, 0);
+		failures += check_byte_array(parsed, Eba_test_rt_bytes,
+					     bytes, Eba_test_rt_bytes);
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_from_string(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_from_string_binary(v, eba_big_endian);
+	failures += eba_test_from_string_binary(v, eba_endian_little);
+	failures += eba_test_from_string_errors(v);
+	failures += eba_test_from_string_short_nul(v);
+	failures += eba_test_from_string_hex(v);
+	failures += eba_test_from_string_runs(v);
+	failures += eba_test_from_string_round_trip(v, eba_big_endian);
+	failures += eba_test_from_string_round_trip(v, eba_endian_little);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_from_string)
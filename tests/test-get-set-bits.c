@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-get-set-bits.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+#include <limits.h>
+
+unsigned eba_test_get_set_bits_endian(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[5];
+	struct eba eba;
+	unsigned long index = 0;
+	unsigned nbits = 0;
+	unsigned j = 0;
+	unsigned long val = 0;
+	unsigned long expect = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_get_set_bits_endian", endian);
+
+	eba.bits = bytes;
+	eba.size_bytes = 5;
+	eba.endian = endian;
+
+	eba_set_all(&eba, 0);
+	eba_set_bits(&eba, 6, 5, 0x13);
+	failures += check_int(eba_get(&eba, 5), 0);
+	failures += check_int(eba_get(&eba, 6), 1);
+	failures += check_int(eba_get(&eba, 7), 1);
+	failures += check_int(eba_get(&eba, 8), 0);
+	failures += check_int(eba_get(&eba, 9), 0);
+	failures += check_int(eba_get(&eba, 10), 1);
+	failures += check_int(eba_get(&eba, 11), 0);
+	failures += check_unsigned_long(eba_get_bits(&eba, 6, 5), 0x13);
+	failures += check_unsigned_long(eba_get_bits(&eba, 7, 4), 0x09);
+
+	/* every width at every offset matches eba_get */
+	for (index = 0; index < 8; ++index) {
+		for (nbits = 1; nbits <= 32; ++nbits) {
+			val = 0xA5C3F00FUL >> (32 - nbits);
+			eba_set_all(&eba, 1);
+			eba_set_bits(&eba, index, nbits, val);
+			failures += check_int(index ? eba_get(&eba, index - 1)
+					      : 1, 1);
+			failures += check_int(eba_get(&eba, index + nbits), 1);
+			expect = 0;
+			for (j = 0; j < nbits; ++j) {
+				expect |= ((unsigned long)
+					   eba_get(&eba, index + j)) << j;
+			}
+			failures += check_unsigned_long(expect, val);
+			expect = eba_get_bits(&eba, index, nbits);
+			failures += check_unsigned_long(expect, val);
+		}
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_get_set_bits(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_get_set_bits_endian(v, eba_big_endian);
+	failures += eba_test_get_set_bits_endian(v, eba_endian_little);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_get_set_bits)
@@ -0,0 +1,244 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-gf2.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+static unsigned long eba_test_gf2_rand_state = 5;
+
+static void eba_test_gf2_fill(struct eba_bitmatrix *m)
+{
+	size_t r = 0;
+	size_t c = 0;
+
+	for (r = 0; r < m->rows; ++r) {
+		for (c = 0; c < m->cols; ++c) {
+			eba_bitmatrix_set(m, r, c,
+					  EBA_TEST_RAND_BIT
+					  (eba_test_gf2_rand_state));
+		}
+	}
+}
+
+/* the product a bit at a time */
+static unsigned char eba_test_gf2_dot(struct eba_bitmatrix *a, size_t row,
+				      struct eba_bitmatrix *b, size_t col)
+{
+	unsigned char sum = 0;
+	size_t k = 0;
+
+	for (k = 0; k < a->cols; ++k) {
+		sum ^= eba_bitmatrix_get(a, row, k) & eba_bitmatrix_get(b, k,
+									col);
+	}
+	return sum;
+}
+
+unsigned eba_test_gf2_mul_vec(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char x_bytes[16];
+	unsigned char y_bytes[8];
+	unsigned char sum = 0;
+	struct eba_bitmatrix *a = NULL;
+	struct eba x;
+	struct eba y;
+	size_t r = 0;
+	size_t c = 0;
+	int pass = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_gf2_mul_vec");
+
+	a = eba_bitmatrix_new(50, 70);
+	if (!a) {
+		return EEMBED_HOSTED;
+	}
+	eba_test_gf2_fill(a);
+
+	y.bits = y_bytes;
+	y.size_bytes = sizeof(y_bytes);
+	y.endian = eba_endian_little;
+
+	/* by words, then a bit at a time */
+	for (pass = 0; pass < 2; ++pass) {
+		x.bits = x_bytes;
+		x.size_bytes = pass ? 9 : sizeof(x_bytes);
+		x.endian = pass ? eba_big_endian : eba_endian_little;
+		eembed_memset(x_bytes, 0xFF, sizeof(x_bytes));
+		for (c = 0; c < 70; ++c) {
+			eba_set(&x, c,
+				EBA_TEST_RAND_BIT(eba_test_gf2_rand_state));
+		}
+		eba_gf2_mul_vec(&y, a, &x);
+		for (r = 0; r < 50; ++r) {
+			sum = 0;
+			for (c = 0; c < 70; ++c) {
+				sum ^= eba_bitmatrix_get(a, r, c)
+				    & eba_get(&x, c);
+			}
+			failures += check_int(eba_get(&y, r), sum);
+		}
+	}
+
+	eba_bitmatrix_free(a);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_gf2_mul_shape(int verbose, size_t m, size_t k, size_t n)
+{
+	unsigned failures = 0;
+	struct eba_bitmatrix *a = NULL;
+	struct eba_bitmatrix *b = NULL;
+	struct eba_bitmatrix *c = NULL;
+	struct eba_bitmatrix *c2 = NULL;
+	unsigned char *scratch = NULL;
+	size_t scratch_len = 0;
+	size_t r = 0;
+	size_t col = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_gf2_mul", k);
+
+	a = eba_bitmatrix_new(m, k);
+	b = eba_bitmatrix_new(k, n);
+	c = eba_bitmatrix_new(m, n);
+	c2 = eba_bitmatrix_new(m, n);
+	scratch_len = b ? eba_gf2_mul_scratch_bytes(b) : 0;
+	scratch = (unsigned char *)eembed_malloc(scratch_len);
+	if (!a || !b || !c || !c2 || !scratch) {
+		eba_bitmatrix_free(a);
+		eba_bitmatrix_free(b);
+		eba_bitmatrix_free(c);
+		eba_bitmatrix_free(c2);
+		eembed_free(scratch);
+		return EEMBED_HOSTED;
+	}
+	eba_test_gf2_fill(a);
+	eba_test_gf2_fill(b);
+
+	failures += check_int(eba_gf2_mul(c, a, b, NULL, 0), 0);
+	failures += check_int(eba_gf2_mul(c2, a, b, scratch, scratch_len), 0);
+	for (r = 0; r < m; ++r) {
+		for (col = 0; col < n; ++col) {
+			failures += check_int(eba_bitmatrix_get(c, r, col),
+					      eba_test_gf2_dot(a, r, b, col));
+		}
+	}
+	failures += check_byte_array(c2->eba.bits, c2->eba.size_bytes,
+				     c->eba.bits, c->eba.size_bytes);
+
+	failures += check_int(eba_gf2_mul(c, a, b, scratch, 1) != 0, 1);
+	if (k != n) {
+		failures += check_int(eba_gf2_mul(c, b, a, NULL, 0) != 0, 1);
+	}
+
+	eba_bitmatrix_free(a);
+	eba_bitmatrix_free(b);
+	eba_bitmatrix_free(c);
+	eba_bitmatrix_free(c2);
+	eembed_free(scratch);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_gf2_row_reduce(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_bitmatrix *m = NULL;
+	struct eba_bitmatrix *low = NULL;
+	struct eba_bitmatrix *left = NULL;
+	struct eba_bitmatrix *right = NULL;
+	size_t rank = 0;
+	size_t lead = 0;
+	size_t r = 0;
+	size_t c = 0;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_gf2_row_reduce");
+
+	m = eba_bitmatrix_new(70, 90);
+	low = eba_bitmatrix_new(70, 90);
+	left = eba_bitmatrix_new(70, 20);
+	right = eba_bitmatrix_new(20, 90);
+	if (!m || !low || !left || !right) {
+		eba_bitmatrix_free(m);
+		eba_bitmatrix_free(low);
+		eba_bitmatrix_free(left);
+		eba_bitmatrix_free(right);
+		return EEMBED_HOSTED;
+	}
+
+	/* the identity, with two rows repeated */
+	for (i = 0; i < 68; ++i) {
+		eba_bitmatrix_set(m, i, i + 3, 1);
+	}
+	eba_bitmatrix_set(m, 68, 5, 1);
+	eba_bitmatrix_set(m, 69, 60, 1);
+	failures += check_size_t(eba_gf2_row_reduce(m), 68);
+	for (i = 0; i < 68; ++i) {
+		failures += check_int(eba_bitmatrix_get(m, i, i + 3), 1);
+		failures += check_unsigned_long(eba_bitmatrix_row_popcount(m,
+									   i),
+						1);
+	}
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(m, 68), 0);
+	failures += check_unsigned_long(eba_bitmatrix_row_popcount(m, 69), 0);
+
+	/* a product through 20 columns has a rank of at most 20 */
+	eba_test_gf2_fill(left);
+	eba_test_gf2_fill(right);
+	failures += check_int(eba_gf2_mul(low, left, right, NULL, 0), 0);
+	rank = eba_gf2_row_reduce(low);
+	failures += check_int(rank <= 20, 1);
+	failures += check_int(rank > 10, 1);
+
+	/* reduced row echelon form: each row leads further right, with
+	 * its leading one the only one in that column */
+	eba_test_gf2_fill(m);
+	rank = eba_gf2_row_reduce(m);
+	failures += check_int(rank > 60, 1);
+	lead = 0;
+	for (r = 0; r < rank; ++r) {
+		for (c = lead; c < 90 && !eba_bitmatrix_get(m, r, c); ++c) {
+			;
+		}
+		failures += check_int(c < 90, 1);
+		for (i = 0; i < 70; ++i) {
+			failures += check_int(eba_bitmatrix_get(m, i, c),
+					      i == r);
+		}
+		lead = c + 1;
+	}
+	for (r = rank; r < 70; ++r) {
+		failures +=
+		    check_unsigned_long(eba_bitmatrix_row_popcount(m, r), 0);
+	}
+
+	eba_bitmatrix_free(m);
+	eba_bitmatrix_free(low);
+	eba_bitmatrix_free(left);
+	eba_bitmatrix_free(right);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_gf2(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_gf2_mul_vec(v);
+	failures += eba_test_gf2_mul_shape(v, 1, 1, 1);
+	failures += eba_test_gf2_mul_shape(v, 9, 13, 70);
+	failures += eba_test_gf2_mul_shape(v, 33, 130, 65);
+	failures += eba_test_gf2_row_reduce(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_gf2)
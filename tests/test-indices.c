@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-indices.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_indices_bytes 19
+
+static unsigned long eba_test_indices_rand_state = 17;
+
+unsigned eba_test_indices_round_trip(int verbose, enum eba_endian endian,
+				     unsigned density)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_indices_bytes];
+	unsigned char copy_bytes[Eba_test_indices_bytes];
+	unsigned long idx[Eba_test_indices_bytes * 8];
+	struct eba eba;
+	struct eba copy;
+	size_t num_bits = Eba_test_indices_bytes * 8;
+	size_t expect = 0;
+	size_t count = 0;
+	size_t i = 0;
+	unsigned long roll = 0;
+	size_t k = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_indices_round_trip",
+			     density);
+
+	eba.bits = bytes;
+	eba.size_bytes = sizeof(bytes);
+	eba.endian = endian;
+	copy.bits = copy_bytes;
+	copy.size_bytes = sizeof(copy_bytes);
+	copy.endian = endian;
+
+	for (i = 0; i < num_bits; ++i) {
+		roll = EBA_TEST_RAND(eba_test_indices_rand_state);
+		eba_set(&eba, i, (roll % 100) < density);
+		expect += eba_get(&eba, i);
+	}
+
+	count = eba_to_indices(&eba, idx, num_bits);
+	failures += check_size_t(count, expect);
+	for (k = 0, i = 0; i < num_bits; ++i) {
+		if (eba_get(&eba, i)) {
+			failures += check_unsigned_long(idx[k], i);
+			++k;
+		}
+	}
+
+	/* a short buffer is filled, and the full count returned */
+	idx[0] = 12345;
+	idx[1] = 12345;
+	failures += check_size_t(eba_to_indices(&eba, idx, 1), expect);
+	if (expect) {
+		failures += check_unsigned_long(idx[1], 12345);
+	} else {
+		failures += check_unsigned_long(idx[0], 12345);
+	}
+	count = eba_to_indices(&eba, idx, num_bits);
+
+	eembed_memset(copy_bytes, 0xAA, sizeof(copy_bytes));
+	eba_from_indices(&copy, idx, count);
+	failures += check_byte_array(copy_bytes, sizeof(copy_bytes),
+				     bytes, sizeof(bytes));
+
+	/* any order will do */
+	for (i = 0; i + 1 < count; i += 2) {
+		k = idx[i];
+		idx[i] = idx[i + 1];
+		idx[i + 1] = k;
+	}
+	for (i = 0; i < count / 2; ++i) {
+		k = idx[i];
+		idx[i] = idx[(count - 1) - i];
+		idx[(count - 1) - i] = k;
+	}
+	eembed_memset(copy_bytes, 0x55, sizeof(copy_bytes));
+	eba_from_indices(&copy, idx, count);
+	failures += check_byte_array(copy_bytes, sizeof(copy_bytes),
+				     bytes, sizeof(bytes));
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_indices_mixed(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_indices_bytes];
+	unsigned long idx[8] = { 0, 3, 64, 65, 100, 7, 151, 3 };
+	unsigned long kept[8];
+	struct eba eba;
+	size_t count = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_indices_mixed");
+
+	eba.bits = bytes;
+	eba.size_bytes = sizeof(bytes);
+	eba.endian = endian;
+	eembed_memset(bytes, 0x00, sizeof(bytes));
+
+	eba_set(&eba, 9, 1);
+	eba_or_indices(&eba, idx, 3);
+	failures += check_int(eba_get(&eba, 9), 1);
+	failures += check_int(eba_get(&eba, 0), 1);
+	failures += check_int(eba_get(&eba, 3), 1);
+	failures += check_int(eba_get(&eba, 64), 1);
+	failures += check_size_t(eba_to_indices(&eba, kept, 0), 4);
+
+	count = eba_filter_indices(&eba, idx, 8, kept);
+	failures += check_size_t(count, 4);
+	failures += check_unsigned_long(kept[0], 0);
+	failures += check_unsigned_long(kept[1], 3);
+	failures += check_unsigned_long(kept[2], 64);
+	failures += check_unsigned_long(kept[3], 3);
+
+	/* in place */
+	eba_set(&eba, 151, 1);
+	count = eba_filter_indices(&eba, idx, 8, idx);
+	failures += check_size_t(count, 5);
+	failures += check_unsigned_long(idx[0], 0);
+	failures += check_unsigned_long(idx[1], 3);
+	failures += check_unsigned_long(idx[2], 64);
+	failures += check_unsigned_long(idx[3], 151);
+	failures += check_unsigned_long(idx[4], 3);
+
+	failures += check_size_t(eba_filter_indices(&eba, idx, 0, kept), 0);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_indices(int v)
+{
+	unsigned failures = 0;
+	unsigned densities[5] = { 0, 3, 50, 97, 100 };
+	size_t i = 0;
+
+	for (i = 0; i < 5; ++i) {
+		failures += eba_test_indices_round_trip(v, eba_endian_little,
+							densities[i]);
+		failures += eba_test_indices_round_trip(v, eba_big_endian,
+							densities[i]);
+	}
+	failures += eba_test_indices_mixed(v, eba_endian_little);
+	failures += eba_test_indices_mixed(v, eba_big_endian);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_indices)
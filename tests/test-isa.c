@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-isa.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+/* longer than a few of the widest vectors, with a ragged tail */
+#define Eba_test_isa_bytes 203
+
+static unsigned long eba_test_isa_rand_state = 7;
+
+unsigned eba_test_isa_counts(int verbose, enum eba_isa isa)
+{
+	unsigned failures = 0;
+	unsigned char a_bytes[Eba_test_isa_bytes];
+	unsigned char b_bytes[Eba_test_isa_bytes];
+	unsigned long xor_count = 0;
+	unsigned long and_count = 0;
+	unsigned long or_count = 0;
+	unsigned long c_and = 0;
+	unsigned long c_or = 0;
+	unsigned long i = 0;
+	size_t len = 0;
+	unsigned char x = 0;
+	unsigned char y = 0;
+	struct eba a;
+	struct eba b;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_isa_counts", isa);
+
+	failures += check_int(eba_isa_force(isa) <= isa, 1);
+
+	for (i = 0; i < Eba_test_isa_bytes; ++i) {
+		a_bytes[i] =
+		    (unsigned char)EBA_TEST_RAND(eba_test_isa_rand_state);
+		b_bytes[i] =
+		    (unsigned char)EBA_TEST_RAND(eba_test_isa_rand_state);
+	}
+	a.bits = a_bytes;
+	a.endian = eba_endian_little;
+	b.bits = b_bytes;
+	b.endian = eba_endian_little;
+
+	/* many lengths, so that each tail size is covered */
+	for (len = 1; len <= Eba_test_isa_bytes; len += 1 + (len / 16)) {
+		a.size_bytes = len;
+		b.size_bytes = len;
+		xor_count = 0;
+		and_count = 0;
+		or_count = 0;
+		for (i = 0; i < (len * 8); ++i) {
+			x = eba_get(&a, i);
+			y = eba_get(&b, i);
+			xor_count += x ^ y;
+			and_count += x & y;
+			or_count += x | y;
+		}
+		failures += check_unsigned_long(eba_hamming_distance(&a, &b),
+						xor_count);
+		failures += check_unsigned_long(eba_count_and(&a, &b),
+						and_count);
+		failures += check_unsigned_long(eba_count_or(&a, &b),
+						or_count);
+		eba_count_and_or(&a, &b, &c_and, &c_or);
+		failures += check_unsigned_long(c_and, and_count);
+		failures += check_unsigned_long(c_or, or_count);
+	}
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+#define Eba_test_isa_rows 8
+#define Eba_test_isa_k 3
+
+/* rows of a few early exit blocks, with a ragged tail */
+unsigned eba_test_isa_matrix(int verbose, enum eba_isa isa)
+{
+	unsigned failures = 0;
+	struct eba_matrix *matrix = NULL;
+	unsigned char query_bytes[Eba_test_isa_bytes * 3];
+	unsigned long distances[Eba_test_isa_rows];
+	struct eba_match expect[Eba_test_isa_rows];
+	struct eba_match matches[Eba_test_isa_rows];
+	struct eba_match tmp;
+	struct eba query;
+	struct eba view;
+	unsigned long bits = 8 * sizeof(query_bytes);
+	unsigned long i = 0;
+	size_t row = 0;
+	size_t j = 0;
+	size_t found = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_isa_matrix", isa);
+
+	failures += check_int(eba_isa_force(isa) <= isa, 1);
+
+	matrix = eba_matrix_new(Eba_test_isa_rows, bits, eba_endian_little);
+	if (!matrix) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	for (i = 0; i < sizeof(query_bytes); ++i) {
+		query_bytes[i] =
+		    (unsigned char)EBA_TEST_RAND(eba_test_isa_rand_state);
+	}
+	query.bits = query_bytes;
+	query.size_bytes = sizeof(query_bytes);
+	query.endian = eba_endian_little;
+
+	/* some rows near the query, the rest far, so that the search
+	 * bound is small and the far rows give up early */
+	for (row = 0; row < Eba_test_isa_rows; ++row) {
+		eba_matrix_row(matrix, row, &view);
+		for (i = 0; i < bits; ++i) {
+			if (row % 3) {
+				eba_set(&view, i,
+					EBA_TEST_RAND_BIT
+					(eba_test_isa_rand_state));
+			} else {
+				eba_set(&view, i, eba_get(&query, i)
+					^ ((i % (97 + row)) == 0));
+			}
+		}
+		distances[row] = 0;
+		for (i = 0; i < bits; ++i) {
+			distances[row] +=
+			    eba_get(&view, i) ^ eba_get(&query, i);
+		}
+		expect[row].row = row;
+		expect[row].distance = distances[row];
+	}
+
+	/* sorted by distance, then row */
+	for (row = 1; row < Eba_test_isa_rows; ++row) {
+		for (j = row; j > 0; --j) {
+			if (expect[j - 1].distance <= expect[j].distance) {
+				break;
+			}
+			tmp = expect[j - 1];
+			expect[j - 1] = expect[j];
+			expect[j] = tmp;
+		}
+	}
+
+	found = eba_matrix_nearest(matrix, &query, matches, Eba_test_isa_k);
+	failures += check_size_t(found, Eba_test_isa_k);
+	for (j = 0; j < found; ++j) {
+		failures += check_size_t(matches[j].row, expect[j].row);
+		failures += check_unsigned_long(matches[j].distance,
+						expect[j].distance);
+	}
+
+	found = eba_matrix_within(matrix, &query,
+				  expect[Eba_test_isa_k - 1].distance,
+				  matches, Eba_test_isa_rows);
+	failures += check_size_t(found, Eba_test_isa_k);
+	for (j = 0, row = 0; row < Eba_test_isa_rows; ++row) {
+		if (distances[row] <= expect[Eba_test_isa_k - 1].distance) {
+			failures += check_size_t(matches[j].row, row);
+			failures += check_unsigned_long(matches[j].distance,
+							distances[row]);
+			++j;
+		}
+	}
+
+	eba_matrix_free(matrix);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_isa(int v)
+{
+	unsigned failures = 0;
+	enum eba_isa start = eba_isa_current();
+
+	failures += eba_test_isa_counts(v, eba_isa_portable);
+	failures += check_int(eba_isa_current(), eba_isa_portable);
+	failures += eba_test_isa_counts(v, eba_isa_sse2);
+	failures += eba_test_isa_counts(v, eba_isa_avx2);
+	failures += eba_test_isa_counts(v, eba_isa_avx512);
+	failures += eba_test_isa_matrix(v, eba_isa_portable);
+	failures += eba_test_isa_matrix(v, eba_isa_sse2);
+	failures += eba_test_isa_matrix(v, eba_isa_avx2);
+	failures += eba_test_isa_matrix(v, eba_isa_avx512);
+
+	failures += check_int(eba_isa_force(start), start);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_isa)
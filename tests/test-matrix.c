@@ -0,0 +1,175 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-matrix.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+#include <limits.h>
+
+#define Eba_test_matrix_rows 40
+#define Eba_test_matrix_k 5
+
+unsigned long eba_test_matrix_slow_distance(struct eba_matrix *matrix,
+					    size_t row, struct eba *query,
+					    unsigned long bits)
+{
+	struct eba view;
+	unsigned long i = 0;
+	unsigned long distance = 0;
+
+	eba_matrix_row(matrix, row, &view);
+	for (i = 0; i < bits; ++i) {
+		if (eba_get(&view, i) != eba_get(query, i)) {
+			++distance;
+		}
+	}
+	return distance;
+}
+
+struct eba_matrix *eba_test_matrix_fill(enum eba_endian endian,
+					unsigned long bits)
+{
+	struct eba_matrix *matrix = NULL;
+	struct eba view;
+	unsigned long state = 7;
+	size_t row = 0;
+	unsigned long i = 0;
+
+	matrix = eba_matrix_new(Eba_test_matrix_rows, bits, endian);
+	if (!matrix) {
+		return NULL;
+	}
+	for (row = 0; row < matrix->rows; ++row) {
+		eba_matrix_row(matrix, row, &view);
+		for (i = 0; i < bits; ++i) {
+			if ((EBA_TEST_RAND(state) % 4) == 0) {
+				eba_set(&view, i, 1);
+			}
+		}
+	}
+	/* a row which is an exact match */
+	eba_matrix_row(matrix, 17, &view);
+	eba_set_all(&view, 0);
+	eba_set(&view, 3, 1);
+	eba_set(&view, 64, 1);
+	eba_set(&view, 99, 1);
+	return matrix;
+}
+
+unsigned eba_test_matrix_nearest(int verbose, enum eba_endian endian,
+				 enum eba_endian query_endian,
+				 unsigned long bits)
+{
+	unsigned failures = 0;
+	struct eba_matrix *matrix = NULL;
+	struct eba *query = NULL;
+	struct eba_match matches[Eba_test_matrix_k];
+	struct eba_match part[Eba_test_matrix_k];
+	struct eba_match within[Eba_test_matrix_rows];
+	unsigned long distances[Eba_test_matrix_rows];
+	size_t found = 0;
+	size_t part_found = 0;
+	size_t row = 0;
+	size_t i = 0;
+	size_t expect_within = 0;
+
+	VERBOSE_ANNOUNCE_S_Z_Z_Z(verbose, "eba_test_matrix_nearest", endian,
+				 query_endian, bits);
+
+	matrix = eba_test_matrix_fill(endian, bits);
+	query = eba_new_endian(bits, query_endian);
+	if (!matrix || !query) {
+		eba_matrix_free(matrix);
+		eba_free(query);
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	eba_set(query, 3, 1);
+	eba_set(query, 64, 1);
+	eba_set(query, 99, 1);
+
+	for (row = 0; row < matrix->rows; ++row) {
+		distances[row] =
+		    eba_test_matrix_slow_distance(matrix, row, query, bits);
+	}
+
+	found = eba_matrix_nearest(matrix, query, matches, Eba_test_matrix_k);
+	failures += check_int(found, Eba_test_matrix_k);
+	failures += check_int(matches[0].row, 17);
+	failures += check_int(matches[0].distance, 0);
+	for (i = 0; i < found; ++i) {
+		failures += check_unsigned_long(matches[i].distance,
+						distances[matches[i].row]);
+		if (i) {
+			failures += check_int(matches[i - 1].distance <=
+					      matches[i].distance, 1);
+		}
+	}
+	/* nothing which was left out is closer than the furthest match */
+	for (row = 0; row < matrix->rows; ++row) {
+		int listed = 0;
+		for (i = 0; i < found; ++i) {
+			listed |= (matches[i].row == row);
+		}
+		if (!listed) {
+			failures += check_int(distances[row] >=
+					      matches[found - 1].distance, 1);
+		}
+	}
+
+	/* searching in pieces, then merging gives the same answer */
+	part_found = eba_matrix_nearest_rows(matrix, query, 0, 13, part, 0,
+					     Eba_test_matrix_k);
+	found = eba_matrix_nearest_rows(matrix, query, 13, matrix->rows,
+					within, 0, Eba_test_matrix_k);
+	found = eba_matrix_merge_nearest(within, found, Eba_test_matrix_k,
+					 part, part_found);
+	failures += check_int(found, Eba_test_matrix_k);
+	for (i = 0; i < found; ++i) {
+		failures += check_int(within[i].row, matches[i].row);
+		failures += check_unsigned_long(within[i].distance,
+						matches[i].distance);
+	}
+
+	for (row = 0; row < matrix->rows; ++row) {
+		if (distances[row] <= (bits / 5)) {
+			++expect_within;
+		}
+	}
+	found = eba_matrix_within(matrix, query, (bits / 5), within,
+				  Eba_test_matrix_rows);
+	failures += check_int(found, expect_within);
+	for (i = 0; i < found; ++i) {
+		row = within[i].row;
+		failures += check_int(distances[row] <= (bits / 5), 1);
+		failures += check_unsigned_long(within[i].distance,
+						distances[within[i].row]);
+	}
+	found = eba_matrix_within(matrix, query, (bits / 5), within, 1);
+	failures += check_int(found, expect_within);
+
+	eba_free(query);
+	eba_matrix_free(matrix);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_matrix(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_matrix_nearest(v, eba_big_endian, eba_big_endian,
+					    100);
+	failures += eba_test_matrix_nearest(v, eba_endian_little,
+					    eba_endian_little, 100);
+	failures += eba_test_matrix_nearest(v, eba_big_endian,
+					    eba_endian_little, 100);
+	/* wide enough for the distance to be cut short */
+	failures += eba_test_matrix_nearest(v, eba_endian_little,
+					    eba_endian_little, 1024);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_matrix)
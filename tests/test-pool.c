@@ -0,0 +1,185 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-pool.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_pool_many 100
+
+unsigned eba_test_pool_classes(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_pool pool;
+	struct eba *a = NULL;
+	struct eba *b = NULL;
+	struct eba *c = NULL;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_pool_classes");
+
+	eba_pool_init(&pool);
+
+	a = eba_pool_new(&pool, 64, eba_endian_little);
+	b = eba_pool_new(&pool, 65, eba_big_endian);
+	c = eba_pool_new(&pool, 1000, eba_endian_little);
+	if (!a || !b || !c) {
+		eba_pool_destroy(&pool);
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_int(a->size_bytes, 8);
+	failures += check_int(b->size_bytes, 16);
+	failures += check_int(c->size_bytes, 128);
+	failures += check_int(b->endian, eba_big_endian);
+	failures += check_ptr(eba_pool_new(&pool, 1025, eba_endian_little),
+			      NULL);
+	for (i = 0; i < c->size_bytes; ++i) {
+		failures += check_int(c->bits[i], 0);
+	}
+
+	eba_set(c, 999, 1);
+	eba_pool_free(&pool, c);
+	failures += check_ptr(eba_pool_new(&pool, 1024, eba_big_endian), c);
+	failures += check_int(eba_get(c, 999), 0);
+	failures += check_int(c->endian, eba_big_endian);
+
+	/* nothing is released until reset or destroy */
+	eba_pool_free(&pool, NULL);
+	eba_pool_reset(&pool);
+	failures += check_ptr(eba_pool_new(&pool, 1, eba_endian_little), a);
+
+	eba_pool_destroy(&pool);
+	failures += check_ptr(pool.slabs, NULL);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_pool_many(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_pool pool;
+	struct eba *ebas[Eba_test_pool_many];
+	size_t i = 0;
+	size_t j = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_pool_many");
+
+	eba_pool_init(&pool);
+	for (i = 0; i < Eba_test_pool_many; ++i) {
+		ebas[i] = eba_pool_new(&pool, 100, eba_endian_little);
+		if (!ebas[i]) {
+			eba_pool_destroy(&pool);
+			VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+			return EEMBED_HOSTED;
+		}
+		eembed_memset(ebas[i]->bits, (int)i, ebas[i]->size_bytes);
+	}
+	for (i = 0; i < Eba_test_pool_many; ++i) {
+		for (j = 0; j < ebas[i]->size_bytes; ++j) {
+			if (ebas[i]->bits[j] != (unsigned char)i) {
+				failures += check_int(ebas[i]->bits[j], i);
+			}
+		}
+	}
+	for (i = 0; i < Eba_test_pool_many; ++i) {
+		eba_pool_free(&pool, ebas[i]);
+	}
+	eba_pool_destroy(&pool);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+struct eba_test_pool_lock_counts {
+	unsigned locks;
+	unsigned unlocks;
+};
+
+void eba_test_pool_lock(void *context)
+{
+	struct eba_test_pool_lock_counts *counts = NULL;
+
+	counts = (struct eba_test_pool_lock_counts *)context;
+	++counts->locks;
+}
+
+void eba_test_pool_unlock(void *context)
+{
+	struct eba_test_pool_lock_counts *counts = NULL;
+
+	counts = (struct eba_test_pool_lock_counts *)context;
+	++counts->unlocks;
+}
+
+unsigned eba_test_pool_cache(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_pool pool;
+	struct eba_pool_cache cache;
+	struct eba_test_pool_lock_counts counts;
+	struct eba *ebas[20];
+	struct eba_pool_slab *slab = NULL;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_pool_cache");
+
+	counts.locks = 0;
+	counts.unlocks = 0;
+	eba_pool_init(&pool);
+	eba_pool_cache_init(&cache, &pool, eba_test_pool_lock,
+			    eba_test_pool_unlock, &counts);
+
+	for (i = 0; i < 20; ++i) {
+		ebas[i] = eba_pool_cache_new(&cache, 200, eba_endian_little);
+		if (!ebas[i]) {
+			eba_pool_destroy(&pool);
+			VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+			return EEMBED_HOSTED;
+		}
+		failures += check_int(ebas[i]->size_bytes, 32);
+	}
+	/* refilled 8 at a time */
+	failures += check_int(counts.locks, 3);
+	failures += check_int(cache.count[2], 4);
+
+	for (i = 0; i < 20; ++i) {
+		eba_pool_cache_free(&cache, ebas[i]);
+	}
+	failures += check_int(cache.count[2] <= EBA_POOL_CACHE_SIZE, 1);
+	eba_pool_cache_flush(&cache);
+	failures += check_int(cache.count[2], 0);
+	failures += check_int(counts.locks, counts.unlocks);
+
+	/* all taken from the pool are back, so one slab is still enough */
+	slab = pool.slabs;
+	for (i = 0; i < EBA_POOL_SLAB_ARRAYS; ++i) {
+		ebas[0] = eba_pool_new(&pool, 256, eba_big_endian);
+		failures += check_int(ebas[0] ? 1 : 0, 1);
+	}
+	failures += check_ptr(pool.slabs, slab);
+	ebas[0] = eba_pool_new(&pool, 256, eba_big_endian);
+	failures += check_int(ebas[0] ? 1 : 0, 1);
+	failures += check_int(pool.slabs != slab, 1);
+
+	eba_pool_destroy(&pool);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_pool(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_pool_classes(v);
+	failures += eba_test_pool_many(v);
+	failures += eba_test_pool_cache(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_pool)
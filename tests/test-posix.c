@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-posix.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "eba-test-private-utils.h"
+#include "eba-posix.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+unsigned eba_test_posix_shm(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_shm creator;
+	struct eba_shm worker;
+	char name[40];
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_posix_shm");
+
+	sprintf(name, "/eba-test-shm-%lu", (unsigned long)getpid());
+	eba_shm_unlink(name);
+
+	if (eba_shm_create(&creator, name, 1000, eba_big_endian)) {
+		/* e.g.: no /dev/shm */
+		VERBOSE_ANNOUNCE_DONE(verbose, 0);
+		return 0;
+	}
+	failures += check_int(creator.eba.size_bytes, 125);
+	failures += check_int(creator.eba.endian, eba_big_endian);
+	failures += check_int(eba_get(&creator.eba, 999), 0);
+	failures += check_int(eba_shm_create(&creator, name, 8,
+					     eba_endian_little), 1);
+	failures += check_int(errno, EEXIST);
+
+	failures += check_int(eba_shm_attach(&worker, name), 0);
+	failures += check_int(worker.eba.size_bytes, 125);
+	failures += check_int(worker.eba.endian, eba_big_endian);
+	failures += check_int(worker.header->bits_offset,
+			      creator.header->bits_offset);
+
+	/* two mappings of the same bits */
+	failures += check_int(worker.eba.bits != creator.eba.bits, 1);
+	eba_set(&creator.eba, 999, 1);
+	failures += check_int(eba_get(&worker.eba, 999), 1);
+	eba_set(&worker.eba, 3, 1);
+	failures += check_int(eba_get(&creator.eba, 3), 1);
+
+	failures += check_int(eba_shm_detach(&creator), 0);
+	failures += check_ptr(creator.eba.bits, NULL);
+	failures += check_int(eba_shm_detach(&creator), 0);
+	failures += check_int(eba_shm_unlink(name), 0);
+
+	/* the mapping outlives the name */
+	failures += check_int(eba_get(&worker.eba, 3), 1);
+	failures += check_int(eba_shm_detach(&worker), 0);
+
+	failures += check_int(eba_shm_attach(&worker, name), 1);
+	failures += check_int(errno, ENOENT);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_posix_mapped(int verbose)
+{
+	unsigned failures = 0;
+	unsigned long num_bits = 3 * 1024UL * 1024UL * 8UL;
+	unsigned flags[3] = { 0, EBA_MAP_THP, EBA_MAP_HUGETLB | EBA_MAP_THP };
+	unsigned long pos = 0;
+	struct eba *eba = NULL;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_posix_mapped");
+
+	for (i = 0; i < 3; ++i) {
+		eba = eba_new_mapped(num_bits, eba_big_endian, flags[i]);
+		if (!eba) {
+			VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+			return EEMBED_HOSTED;
+		}
+		/* falls back to what is available */
+		failures += check_int(eba_mapped_flags(eba) & ~flags[i], 0);
+		failures += check_unsigned_long(eba->size_bytes,
+						num_bits / 8);
+		failures += check_int(eba->endian, eba_big_endian);
+		pos = (unsigned long)((size_t)eba->bits);
+		failures += check_unsigned_long(pos % EBA_ALIGN_BYTES, 0);
+		failures += check_int(eba_get(eba, num_bits - 1), 0);
+		eba_set(eba, num_bits - 1, 1);
+		failures += check_int(eba->bits[0], 0x80);
+		eba_free_mapped(eba);
+	}
+	eba_free_mapped(NULL);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_posix(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_posix_shm(v);
+	failures += eba_test_posix_mapped(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_posix)
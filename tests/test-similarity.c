@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-similarity.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+#include <limits.h>
+
+unsigned eba_test_similarity_small(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes_a[2];
+	unsigned char bytes_b[2];
+	struct eba a;
+	struct eba b;
+	unsigned long c_and = 0;
+	unsigned long c_or = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_similarity_small");
+
+	a.bits = bytes_a;
+	a.size_bytes = 2;
+	a.endian = eba_big_endian;
+	b.bits = bytes_b;
+	b.size_bytes = 2;
+	b.endian = eba_big_endian;
+
+	eba_set_all(&a, 0);
+	eba_set_all(&b, 0);
+	failures += check_int(eba_hamming_distance(&a, &b), 0);
+	failures += check_int(eba_jaccard(&a, &b) == 1.0, 1);
+
+	eba_set(&a, 1, 1);
+	eba_set(&a, 3, 1);
+	eba_set(&a, 9, 1);
+	eba_set(&a, 15, 1);
+
+	eba_set(&b, 3, 1);
+	eba_set(&b, 9, 1);
+	eba_set(&b, 10, 1);
+
+	failures += check_int(eba_hamming_distance(&a, &b), 3);
+	failures += check_int(eba_count_and(&a, &b), 2);
+	failures += check_int(eba_count_or(&a, &b), 5);
+	eba_count_and_or(&a, &b, &c_and, &c_or);
+	failures += check_int(c_and, 2);
+	failures += check_int(c_or, 5);
+	failures += check_int((int)(eba_jaccard(&a, &b) * 100), 40);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+#define Eba_test_sim_max_bytes 37
+
+unsigned eba_test_similarity_vs_get(int verbose, size_t size_a,
+				    enum eba_endian endian_a, size_t size_b,
+				    enum eba_endian endian_b)
+{
+	unsigned failures = 0;
+	unsigned char bytes_a[Eba_test_sim_max_bytes];
+	unsigned char bytes_b[Eba_test_sim_max_bytes];
+	struct eba a;
+	struct eba b;
+	unsigned long i = 0;
+	unsigned long bits_a = 0;
+	unsigned long bits_b = 0;
+	unsigned long max_bits = 0;
+	unsigned long x_xor = 0;
+	unsigned long x_and = 0;
+	unsigned long x_or = 0;
+	unsigned long c_and = 0;
+	unsigned long c_or = 0;
+
+	VERBOSE_ANNOUNCE_S_Z_Z_Z(verbose, "eba_test_similarity_vs_get",
+				 size_a, size_b, (2 * endian_a) + endian_b);
+
+	for (i = 0; i < Eba_test_sim_max_bytes; ++i) {
+		bytes_a[i] = (unsigned char)((i * 29) ^ 0x5C);
+		bytes_b[i] = (unsigned char)((i * 71) ^ (i >> 1));
+	}
+	a.bits = bytes_a;
+	a.size_bytes = size_a;
+	a.endian = endian_a;
+	b.bits = bytes_b;
+	b.size_bytes = size_b;
+	b.endian = endian_b;
+
+	bits_a = size_a * CHAR_BIT;
+	bits_b = size_b * CHAR_BIT;
+	max_bits = bits_a > bits_b ? bits_a : bits_b;
+	for (i = 0; i < max_bits; ++i) {
+		unsigned x = i < bits_a ? eba_get(&a, i) : 0;
+		unsigned y = i < bits_b ? eba_get(&b, i) : 0;
+		x_xor += (x ^ y);
+		x_and += (x & y);
+		x_or += (x | y);
+	}
+
+	failures += check_unsigned_long(eba_hamming_distance(&a, &b), x_xor);
+	failures += check_unsigned_long(eba_hamming_distance(&b, &a), x_xor);
+	failures += check_unsigned_long(eba_count_and(&a, &b), x_and);
+	failures += check_unsigned_long(eba_count_or(&a, &b), x_or);
+	eba_count_and_or(&a, &b, &c_and, &c_or);
+	failures += check_unsigned_long(c_and, x_and);
+	failures += check_unsigned_long(c_or, x_or);
+	eba_count_and_or(&b, &a, &c_and, &c_or);
+	failures += check_unsigned_long(c_and, x_and);
+	failures += check_unsigned_long(c_or, x_or);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_similarity(int v)
+{
+	unsigned failures = 0;
+	enum eba_endian ea = eba_endian_little;
+	enum eba_endian eb = eba_endian_little;
+	size_t sizes[4] = { 1, 8, 19, Eba_test_sim_max_bytes };
+	size_t i = 0;
+	size_t j = 0;
+
+	failures += eba_test_similarity_small(v);
+
+	for (i = 0; i < 4; ++i) {
+		for (j = 0; j < 4; ++j) {
+			for (ea = eba_endian_little; ea <= eba_big_endian;
+			     ea = (enum eba_endian)(ea + 1)) {
+				for (eb = eba_endian_little;
+				     eb <= eba_big_endian;
+				     eb = (enum eba_endian)(eb + 1)) {
+					failures +=
+					    eba_test_similarity_vs_get(v,
+								       sizes[i],
+								       ea,
+								       sizes[j],
+								       eb);
+				}
+			}
+		}
+	}
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_similarity)
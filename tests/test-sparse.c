@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-sparse.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+unsigned eba_test_sparse_walk(struct eba_sparse *sparse,
+			      const unsigned long *expect, size_t len)
+{
+	unsigned failures = 0;
+	unsigned long found = 0;
+	size_t n = 0;
+	int err = 0;
+
+	for (err = eba_sparse_next(sparse, 0, &found); !err;
+	     err = eba_sparse_next(sparse, found + 1, &found)) {
+		if (n < len) {
+			failures += check_unsigned_long(found, expect[n]);
+		}
+		++n;
+	}
+	failures += check_unsigned_long(n, len);
+
+	return failures;
+}
+
+unsigned eba_test_sparse_next(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_sparse *sparse = NULL;
+	unsigned long num_bits = 102400;
+	unsigned long set[8] = { 0, 7, 511, 512, 4099, 50000, 50001, 102399 };
+	unsigned long some[4] = { 7, 512, 50001, 102399 };
+	unsigned long found = 0;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_sparse_next");
+
+	sparse = eba_sparse_new(num_bits);
+	if (!sparse) {
+		VERBOSE_ANNOUNCE_DONE(verbose, EEMBED_HOSTED);
+		return EEMBED_HOSTED;
+	}
+	failures += check_int(sparse->eba.size_bytes, 12800);
+	failures += check_int(eba_sparse_next(sparse, 0, &found), 1);
+
+	for (i = 0; i < 8; ++i) {
+		eba_sparse_set(sparse, set[i], 1);
+	}
+	failures += eba_test_sparse_walk(sparse, set, 8);
+	failures += check_int(eba_sparse_next(sparse, 513, &found), 0);
+	failures += check_unsigned_long(found, 4099);
+	failures += check_int(eba_sparse_next(sparse, num_bits, &found), 1);
+
+	eba_sparse_set(sparse, 0, 0);
+	eba_sparse_set(sparse, 511, 0);
+	eba_sparse_set(sparse, 4099, 0);
+	eba_sparse_set(sparse, 50000, 0);
+	failures += eba_test_sparse_walk(sparse, some, 4);
+	/* the line of 4099 is no longer in the summary */
+	failures += check_int(eba_get_byte_bit(sparse->level[0][1], 0), 0);
+	failures += check_int(eba_get_byte_bit(sparse->level[0][0], 1), 1);
+
+	/* written directly, then the summary rebuilt */
+	eba_set(&sparse->eba, 70000, 1);
+	failures += eba_test_sparse_walk(sparse, some, 4);
+	eba_sparse_rebuild(sparse);
+	failures += check_int(eba_sparse_next(sparse, 50002, &found), 0);
+	failures += check_unsigned_long(found, 70000);
+
+	eba_sparse_clear_all(sparse);
+	failures += check_int(eba_sparse_next(sparse, 0, &found), 1);
+	for (i = 0; i < sparse->eba.size_bytes; ++i) {
+		if (sparse->eba.bits[i]) {
+			failures += check_int(sparse->eba.bits[i], 0);
+		}
+	}
+
+	eba_sparse_free(sparse);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_sparse_init(int verbose)
+{
+	unsigned failures = 0;
+	struct eba_sparse sparse;
+	unsigned char bits[100];
+	unsigned char summary[16];
+	unsigned long expect[3] = { 9, 517, 799 };
+	size_t summary_len = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_sparse_init");
+
+	eembed_memset(bits, 0x00, 100);
+	bits[1] = 0x02;
+	bits[64] = 0x20;
+	bits[99] = 0x80;
+
+	summary_len = eba_sparse_summary_bytes(100);
+	failures += check_int(summary_len > 0, 1);
+	failures += check_int(summary_len <= 16, 1);
+	err = eba_sparse_init(&sparse, bits, 100, summary, summary_len - 1);
+	failures += check_int(err, 1);
+	err = eba_sparse_init(&sparse, bits, 100, summary, 16);
+	failures += check_int(err, 0);
+	failures += check_int(sparse.levels, 1);
+
+	failures += eba_test_sparse_walk(&sparse, expect, 3);
+
+	eba_sparse_set(&sparse, 517, 0);
+	failures += check_int(eba_sparse_next(&sparse, 10, &expect[0]), 0);
+	failures += check_unsigned_long(expect[0], 799);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_sparse(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_sparse_next(v);
+	failures += eba_test_sparse_init(v);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_sparse)
@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later */
+/* test-test-batch.c */
+/* Copyright (C) 2026 Eric Herman <eric@freesa.org> */
+
+#include "eba-test-private-utils.h"
+
+#define Eba_test_batch_n 50
+
+unsigned eba_test_test_batch_endian(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[40];
+	unsigned long idx[Eba_test_batch_n];
+	unsigned char out[Eba_test_batch_n];
+	unsigned long set = 0;
+	struct eba eba;
+	size_t i = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_test_batch_endian", endian);
+
+	eba.bits = bytes;
+	eba.size_bytes = sizeof(bytes);
+	eba.endian = endian;
+	eba_set_all(&eba, 0);
+	for (i = 0; i < (sizeof(bytes) * 8); i += 3) {
+		eba_set(&eba, i, 1);
+	}
+
+	/* more than the prefetch distance, in no particular order */
+	for (i = 0; i < Eba_test_batch_n; ++i) {
+		idx[i] = (i * 37) % (sizeof(bytes) * 8);
+		set += (idx[i] % 3) ? 0 : 1;
+		out[i] = 2;
+	}
+	failures += check_int(eba_test_batch(&eba, idx, Eba_test_batch_n, out),
+			      set);
+	for (i = 0; i < Eba_test_batch_n; ++i) {
+		failures += check_int(out[i], eba_get(&eba, idx[i]));
+	}
+	failures += check_int(eba_test_batch(&eba, idx, 3, NULL), 1);
+	failures += check_int(eba_test_batch(&eba, NULL, 0, NULL), 0);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_test_batch(int v)
+{
+	unsigned failures = 0;
+
+	failures += eba_test_test_batch_endian(v, eba_endian_little);
+	failures += eba_test_test_batch_endian(v, eba_big_endian);
+
+	return failures;
+}
+
+ECHECK_TEST_MAIN_V(eba_test_test_batch)
@@ -3,6 +3,7 @@
 /* Copyright (C) 2017, 2019 Eric Herman <eric@freesa.org> */
 
 #include "eba-test-private-utils.h"
+#include <limits.h>
 
 unsigned eba_test_to_string_be(int verbose)
 {
@@ -167,6 +168,183 @@ unsigned eba_test_to_string_invalid(int verbose)
 	return failures;
 }
 
+unsigned eba_test_to_string_hex(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[2];
+	struct eba eba;
+	char buf[40];
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_to_string_hex");
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+
+	eba.endian = eba_big_endian;
+	eba_set_all(&eba, 0);
+	eba_set(&eba, 1, 1);
+	eba_set(&eba, 2, 1);
+	eba_set(&eba, 3, 1);
+	eba_set(&eba, 5, 1);
+	eba_set(&eba, 8, 1);
+	eba_to_string_format(&eba, eba_string_hex, buf, 40);
+	failures += check_str(buf, "012e");
+
+	eba.endian = eba_endian_little;
+	eba_set_all(&eba, 0);
+	eba_set(&eba, 1, 1);
+	eba_set(&eba, 2, 1);
+	eba_set(&eba, 3, 1);
+	eba_set(&eba, 5, 1);
+	eba_set(&eba, 8, 1);
+	eba_to_string_format(&eba, eba_string_hex, buf, 40);
+	failures += check_str(buf, "2e01");
+
+	bytes[0] = 0xF0;
+	bytes[1] = 0x9A;
+	eba_to_string_format(&eba, eba_string_hex, buf, 4);
+	failures += check_str(buf, "f0!");
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+unsigned eba_test_to_string_runs(int verbose)
+{
+	unsigned failures = 0;
+	unsigned char bytes[2];
+	struct eba eba;
+	char buf[40];
+
+	VERBOSE_ANNOUNCE_S(verbose, "eba_test_to_string_runs");
+
+	eba.bits = bytes;
+	eba.size_bytes = 2;
+
+	eba.endian = eba_big_endian;
+	eba_set_all(&eba, 0);
+	eba_set(&eba, 1, 1);
+	eba_set(&eba, 2, 1);
+	eba_set(&eba, 3, 1);
+	eba_set(&eba, 5, 1);
+	eba_set(&eba, 8, 1);
+	eba_to_string_format(&eba, eba_string_runs, buf, 40);
+	failures += check_str(buf, "0*7 1*1 0*2 1*1 0*1 1*3 0*1");
+
+	eba.endian = eba_endian_little;
+	eba_set_all(&eba, 0);
+	eba_set(&eba, 1, 1);
+	eba_set(&eba, 2, 1);
+	eba_set(&eba, 3, 1);
+	eba_set(&eba, 5, 1);
+	eba_set(&eba, 8, 1);
+	eba_to_string_format(&eba, eba_string_runs, buf, 40);
+	failures += check_str(buf, "0*1 1*3 0*1 1*1 0*2 1*1 0*7");
+
+	eba_set_all(&eba, 0);
+	eba_to_string_format(&eba, eba_string_runs, buf, 40);
+	failures += check_str(buf, "0*16");
+
+	eba_set_all(&eba, 1);
+	eba_set(&eba, 15, 0);
+	eba_to_string_format(&eba, eba_string_runs, buf, 40);
+	failures += check_str(buf, "1*15 0*1");
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
+struct eba_test_to_string_sink {
+	char *buf;
+	size_t size;
+	size_t pos;
+	unsigned calls;
+	unsigned stop_after;
+};
+
+int eba_test_to_string_sink_write(void *context, const char *str, size_t len)
+{
+	struct eba_test_to_string_sink *sink = NULL;
+	size_t i = 0;
+
+	sink = (struct eba_test_to_string_sink *)context;
+	++sink->calls;
+	for (i = 0; i < len && sink->pos < (sink->size - 1); ++i) {
+		sink->buf[sink->pos++] = str[i];
+	}
+	sink->buf[sink->pos] = '\0';
+
+	return (sink->stop_after && sink->calls >= sink->stop_after) ? 1 : 0;
+}
+
+#define Eba_test_large_bytes 32
+#define Eba_test_large_str_len ((Eba_test_large_bytes * 9) + 1)
+
+unsigned eba_test_to_string_large(int verbose, enum eba_endian endian)
+{
+	unsigned failures = 0;
+	unsigned char bytes[Eba_test_large_bytes];
+	char expect[Eba_test_large_str_len];
+	char buf[Eba_test_large_str_len];
+	char streamed[Eba_test_large_str_len];
+	struct eba_test_to_string_sink sink;
+	struct eba eba;
+	unsigned long i = 0;
+	unsigned long size_bits = 0;
+	size_t pos = 0;
+	int err = 0;
+
+	VERBOSE_ANNOUNCE_S_Z(verbose, "eba_test_to_string_large", endian);
+
+	for (i = 0; i < Eba_test_large_bytes; ++i) {
+		bytes[i] = (unsigned char)((i * 37) ^ (i >> 3));
+	}
+	eba.bits = bytes;
+	eba.size_bytes = Eba_test_large_bytes;
+	eba.endian = endian;
+	size_bits = eba.size_bytes * CHAR_BIT;
+
+	/* the slow, obviously correct way */
+	pos = 0;
+	for (i = 0; i < size_bits; ++i) {
+		unsigned long idx = 0;
+		if (i && ((i % CHAR_BIT) == 0)) {
+			expect[pos++] = ' ';
+		}
+		idx = (endian == eba_big_endian) ? (size_bits - 1 - i) : i;
+		expect[pos++] = eba_get(&eba, idx) ? '1' : '0';
+	}
+	expect[pos] = '\0';
+
+	eba_to_string(&eba, buf, Eba_test_large_str_len);
+	failures += check_str(buf, expect);
+
+	sink.buf = streamed;
+	sink.size = Eba_test_large_str_len;
+	sink.pos = 0;
+	sink.calls = 0;
+	sink.stop_after = 0;
+	err = eba_to_string_stream(&eba, eba_string_binary,
+				   eba_test_to_string_sink_write, &sink);
+	failures += check_int(err, 0);
+	failures += check_str(streamed, expect);
+	failures += check_int(sink.calls > 1, 1);
+
+	sink.pos = 0;
+	sink.calls = 0;
+	sink.stop_after = 1;
+	err = eba_to_string_stream(&eba, eba_string_binary,
+				   eba_test_to_string_sink_write, &sink);
+	failures += check_int(err, 1);
+	failures += check_int(sink.calls, 1);
+
+	VERBOSE_ANNOUNCE_DONE(verbose, failures);
+
+	return failures;
+}
+
 /* TODO Split in to five tests */
 unsigned eba_test_to_string(int verbose)
 {
@@ -179,6 +357,11 @@ unsigned eba_test_to_string(int verbose)
 	failures += eba_test_to_string_error_2(verbose);
 	failures += eba_test_to_string_invalid(verbose);
 
+	failures += eba_test_to_string_hex(verbose);
+	failures += eba_test_to_string_runs(verbose);
+	failures += eba_test_to_string_large(verbose, eba_big_endian);
+	failures += eba_test_to_string_large(verbose, eba_endian_little);
+
 	return failures;
 }
 